@@ -0,0 +1,156 @@
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <numeric>
+#include "catalogue_snapshot.h"
+#include "../external/memory_counter.h"
+#include "transport_catalogue.h"
+
+namespace TransportGuide::BusinessLogic {
+
+TransportCatalogueSnapshot::TransportCatalogueSnapshot(const TransportCatalogue& catalogue) {
+    //Непрерывные массивы, отсортированные по имени, заменяют словари имен. Удаленные объекты в снимок не попадают
+    stops_.reserve(catalogue.GetStopNameCatalog().size());
+    for (const Domain::Stop& stop : catalogue.GetStops()) {
+        if (!catalogue.IsRemoved(&stop)) { stops_.push_back(&stop); }
+    }
+    std::sort(stops_.begin(), stops_.end(), [](const Domain::Stop* lhs, const Domain::Stop* rhs) {
+        return lhs->name < rhs->name;
+    });
+    buses_.reserve(catalogue.GetBusNameCatalog().size());
+    for (const Domain::Bus& bus : catalogue.GetBuses()) {
+        if (!catalogue.IsRemoved(&bus)) { buses_.push_back(&bus); }
+    }
+    std::sort(buses_.begin(), buses_.end(), [](const Domain::Bus* lhs, const Domain::Bus* rhs) {
+        return lhs->name < rhs->name;
+    });
+
+    stop_index_by_ptr_.reserve(stops_.size());
+    for (Index i = 0; i < stops_.size(); ++i) {
+        stop_index_by_ptr_.emplace_back(stops_[i], i);
+    }
+    std::sort(stop_index_by_ptr_.begin(), stop_index_by_ptr_.end());
+    bus_index_by_ptr_.reserve(buses_.size());
+    for (Index i = 0; i < buses_.size(); ++i) {
+        bus_index_by_ptr_.emplace_back(buses_[i], i);
+    }
+    std::sort(bus_index_by_ptr_.begin(), bus_index_by_ptr_.end());
+
+    //CSR маршрут -> остановки
+    bus_stops_offsets_.reserve(buses_.size() + 1);
+    bus_stops_offsets_.push_back(0);
+    for (const Domain::Bus* bus : buses_) {
+        for (const Domain::Stop* stop : bus->route) {
+            bus_stops_.push_back(GetStopIndex(stop));
+        }
+        bus_stops_offsets_.push_back(static_cast<Index>(bus_stops_.size()));
+    }
+
+    //CSR остановка -> маршруты, как и в каталоге, конечная остановка кольца не учитывается повторно
+    std::vector<std::pair<Index, Index>> stop_bus_pairs;
+    stop_bus_pairs.reserve(bus_stops_.size());
+    for (Index bus_index = 0; bus_index < buses_.size(); ++bus_index) {
+        Index begin = bus_stops_offsets_[bus_index];
+        Index end = bus_stops_offsets_[bus_index + 1];
+        for (Index i = begin; i + 1 < end; ++i) {
+            stop_bus_pairs.emplace_back(bus_stops_[i], bus_index);
+        }
+    }
+    std::sort(stop_bus_pairs.begin(), stop_bus_pairs.end());
+    stop_bus_pairs.erase(std::unique(stop_bus_pairs.begin(), stop_bus_pairs.end()), stop_bus_pairs.end());
+    stop_buses_offsets_.assign(stops_.size() + 1, 0);
+    stop_buses_.reserve(stop_bus_pairs.size());
+    for (const auto& [stop_index, bus_index] : stop_bus_pairs) {
+        ++stop_buses_offsets_[stop_index + 1];
+        stop_buses_.push_back(bus_index);
+    }
+    std::partial_sum(stop_buses_offsets_.begin(), stop_buses_offsets_.end(), stop_buses_offsets_.begin());
+
+    spatial_index_ = StopSpatialIndex(stops_);
+    name_search_index_ = NameSearchIndex(stops_, buses_);
+}
+
+const Domain::Stop* TransportCatalogueSnapshot::FindStop(std::string_view name) const {
+    auto it = std::lower_bound(stops_.begin(), stops_.end(), name, [](const Domain::Stop* stop, std::string_view name) {
+        return std::string_view(stop->name) < name;
+    });
+    if (it != stops_.end() && (*it)->name == name) {
+        return *it;
+    }
+    return nullptr;
+}
+
+const Domain::Bus* TransportCatalogueSnapshot::FindBus(std::string_view name) const {
+    auto it = std::lower_bound(buses_.begin(), buses_.end(), name, [](const Domain::Bus* bus, std::string_view name) {
+        return std::string_view(bus->name) < name;
+    });
+    if (it != buses_.end() && (*it)->name == name) {
+        return *it;
+    }
+    return nullptr;
+}
+
+TransportCatalogueSnapshot::Index TransportCatalogueSnapshot::GetStopIndex(const Domain::Stop* stop) const {
+    auto it = std::lower_bound(stop_index_by_ptr_.begin(), stop_index_by_ptr_.end(), stop,
+            [](const auto& item, const Domain::Stop* stop) {
+                return std::less<const Domain::Stop*>()(item.first, stop);
+            });
+    if (it != stop_index_by_ptr_.end() && it->first == stop) {
+        return it->second;
+    }
+    return NPOS;
+}
+
+TransportCatalogueSnapshot::Index TransportCatalogueSnapshot::GetBusIndex(const Domain::Bus* bus) const {
+    auto it = std::lower_bound(bus_index_by_ptr_.begin(), bus_index_by_ptr_.end(), bus,
+            [](const auto& item, const Domain::Bus* bus) {
+                return std::less<const Domain::Bus*>()(item.first, bus);
+            });
+    if (it != bus_index_by_ptr_.end() && it->first == bus) {
+        return it->second;
+    }
+    return NPOS;
+}
+
+std::vector<const Domain::Bus*> TransportCatalogueSnapshot::GetBusesByStop(Index stop_index) const {
+    std::vector<const Domain::Bus*> buses;
+    if (stop_index >= stops_.size()) { return buses; }
+    auto begin = std::next(stop_buses_.begin(), stop_buses_offsets_[stop_index]);
+    auto end = std::next(stop_buses_.begin(), stop_buses_offsets_[stop_index + 1]);
+    buses.reserve(std::distance(begin, end));
+    std::transform(begin, end, std::back_inserter(buses), [this](Index bus_index) {
+        return buses_[bus_index];
+    });
+    return buses;
+}
+
+size_t TransportCatalogueSnapshot::GetBusStopsCount(Index bus_index) const {
+    if (bus_index >= buses_.size()) { return 0; }
+    return bus_stops_offsets_[bus_index + 1] - bus_stops_offsets_[bus_index];
+}
+
+const StopSpatialIndex& TransportCatalogueSnapshot::GetSpatialIndex() const {
+    return spatial_index_;
+}
+
+const NameSearchIndex& TransportCatalogueSnapshot::GetNameSearchIndex() const {
+    return name_search_index_;
+}
+
+const std::vector<const Domain::Stop*>& TransportCatalogueSnapshot::GetStops() const {
+    return stops_;
+}
+
+const std::vector<const Domain::Bus*>& TransportCatalogueSnapshot::GetBuses() const {
+    return buses_;
+}
+
+size_t TransportCatalogueSnapshot::GetMemoryUsage() const {
+    return memory::MeasureVector(stops_) + memory::MeasureVector(buses_) + memory::MeasureVector(stop_index_by_ptr_)
+            + memory::MeasureVector(bus_index_by_ptr_) + memory::MeasureVector(stop_buses_offsets_)
+            + memory::MeasureVector(stop_buses_) + memory::MeasureVector(bus_stops_offsets_)
+            + memory::MeasureVector(bus_stops_)
+            + spatial_index_.GetMemoryUsage() + name_search_index_.GetMemoryUsage();
+}
+
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "../domain/domain.h"
+#include "stop_spatial_index.h"
+#include "name_search_index.h"
+
+namespace TransportGuide::BusinessLogic {
+
+class TransportCatalogue;
+
+/**Неизменяемый снимок каталога, оптимизированный для чтения.
+ * Сами остановки и маршруты остаются в деках каталога, снимок хранит указатели на них в массивах,
+ * отсортированных по имени. Связи остановка->маршруты и маршрут->остановки хранятся в формате CSR
+ * (смещения + плоский массив индексов). Расстояний снимок не хранит, их отдают словари каталога.
+ * После построения снимок не изменяется, поэтому читать его можно из любого потока без блокировок*/
+class TransportCatalogueSnapshot final {
+public:
+    using Index = uint32_t;
+    static constexpr Index NPOS = static_cast<Index>(-1);
+
+    explicit TransportCatalogueSnapshot(const TransportCatalogue& catalogue);
+
+    /**Найти остановку по имени бинарным поиском, если остановки нет, возвращается nullptr*/
+    const Domain::Stop* FindStop(std::string_view name) const;
+    /**Найти маршрут по имени бинарным поиском, если маршрута нет, возвращается nullptr*/
+    const Domain::Bus* FindBus(std::string_view name) const;
+    /**Индекс остановки в снимке, если остановка не из этого каталога, возвращается NPOS*/
+    Index GetStopIndex(const Domain::Stop* stop) const;
+    /**Индекс маршрута в снимке, если маршрут не из этого каталога, возвращается NPOS*/
+    Index GetBusIndex(const Domain::Bus* bus) const;
+    /**Маршруты, проходящие через остановку, отсортированные по имени*/
+    std::vector<const Domain::Bus*> GetBusesByStop(Index stop_index) const;
+    /**Количество остановок маршрута с учетом обратного направления*/
+    size_t GetBusStopsCount(Index bus_index) const;
+
+    /**Пространственный индекс заполненных остановок*/
+    const StopSpatialIndex& GetSpatialIndex() const;
+    /**Индекс поиска по началу и похожести имени остановок и маршрутов*/
+    const NameSearchIndex& GetNameSearchIndex() const;
+    
+    /**Указатели на остановки каталога, отсортированные по имени*/
+    const std::vector<const Domain::Stop*>& GetStops() const;
+    /**Указатели на маршруты каталога, отсортированные по имени*/
+    const std::vector<const Domain::Bus*>& GetBuses() const;
+    /**Байты в куче, занятые массивами снимка и его индексами*/
+    size_t GetMemoryUsage() const;
+
+private:
+    std::vector<const Domain::Stop*> stops_;
+    std::vector<const Domain::Bus*> buses_;
+    std::vector<std::pair<const Domain::Stop*, Index>> stop_index_by_ptr_;
+    std::vector<std::pair<const Domain::Bus*, Index>> bus_index_by_ptr_;
+    //CSR остановка -> маршруты, индексы маршрутов по возрастанию, то есть по имени
+    std::vector<Index> stop_buses_offsets_;
+    std::vector<Index> stop_buses_;
+    //CSR маршрут -> остановки в порядке следования
+    std::vector<Index> bus_stops_offsets_;
+    std::vector<Index> bus_stops_;
+    StopSpatialIndex spatial_index_;
+    NameSearchIndex name_search_index_;
+};
+
+}
@@ -0,0 +1,145 @@
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include "name_perfect_hash.h"
+#include "../external/memory_counter.h"
+
+namespace TransportGuide::BusinessLogic {
+using namespace std::literals;
+
+//Среднее количество имен в корзине
+static const size_t NAMES_PER_BUCKET = 4;
+//Предел перебора смещений одной корзины, после него пробуется следующее зерно
+static const uint32_t MAX_DISPLACEMENT = 1u << 22;
+static const uint64_t MAX_SEED_ATTEMPTS = 16;
+
+//Финальное перемешивание splitmix64
+static uint64_t Mix(uint64_t value) {
+    value ^= value >> 30;
+    value *= 0xbf58476d1ce4e5b9ULL;
+    value ^= value >> 27;
+    value *= 0x94d049bb133111ebULL;
+    value ^= value >> 31;
+    return value;
+}
+
+NamePerfectHash::NamePerfectHash(const std::vector<std::string_view>& names) {
+    for (uint64_t seed = 0; seed < MAX_SEED_ATTEMPTS; ++seed) {
+        if (TryBuild(names, seed)) { return; }
+    }
+    throw std::logic_error("NamePerfectHash cannot be built, names must be unique."s);
+}
+
+NamePerfectHash::NamePerfectHash(uint64_t seed, std::vector<uint32_t> displacements, std::vector<Slot> slots)
+        : seed_(seed), displacements_(std::move(displacements)), slots_(std::move(slots)) {
+    if (!slots_.empty() && displacements_.empty()) {
+        throw std::logic_error("NamePerfectHash data is corrupted."s);
+    }
+}
+
+uint32_t NamePerfectHash::Find(std::string_view name) const {
+    if (slots_.empty()) { return NPOS; }
+    uint64_t hash = Hash(name, seed_);
+    const Slot& slot = slots_[GetSlotIndex(hash, displacements_[GetBucket(hash)], slots_.size())];
+    return slot.fingerprint == static_cast<uint32_t>(hash) ? slot.id : NPOS;
+}
+
+size_t NamePerfectHash::size() const {
+    return slots_.size();
+}
+
+uint64_t NamePerfectHash::GetSeed() const {
+    return seed_;
+}
+
+const std::vector<uint32_t>& NamePerfectHash::GetDisplacements() const {
+    return displacements_;
+}
+
+const std::vector<NamePerfectHash::Slot>& NamePerfectHash::GetSlots() const {
+    return slots_;
+}
+
+size_t NamePerfectHash::GetMemoryUsage() const {
+    return memory::MeasureVector(displacements_) + memory::MeasureVector(slots_);
+}
+
+bool NamePerfectHash::TryBuild(const std::vector<std::string_view>& names, uint64_t seed) {
+    const size_t name_count = names.size();
+    seed_ = seed;
+    displacements_.clear();
+    slots_.assign(name_count, Slot{});
+    if (name_count == 0) { return true; }
+    displacements_.assign((name_count + NAMES_PER_BUCKET - 1) / NAMES_PER_BUCKET, 0);
+
+    std::vector<uint64_t> hashes(name_count);
+    for (size_t id = 0; id < name_count; ++id) {
+        hashes[id] = Hash(names[id], seed);
+    }
+    //Совпадение полных хешей не разделить никаким смещением
+    std::vector<uint64_t> sorted_hashes = hashes;
+    std::sort(sorted_hashes.begin(), sorted_hashes.end());
+    if (std::adjacent_find(sorted_hashes.begin(), sorted_hashes.end()) != sorted_hashes.end()) { return false; }
+
+    std::vector<std::vector<uint32_t>> buckets(displacements_.size());
+    for (size_t id = 0; id < name_count; ++id) {
+        buckets[GetBucket(hashes[id])].push_back(static_cast<uint32_t>(id));
+    }
+    //Большие корзины размещаются первыми, пока свободных ячеек много
+    std::vector<uint32_t> bucket_order(buckets.size());
+    std::iota(bucket_order.begin(), bucket_order.end(), 0);
+    std::stable_sort(bucket_order.begin(), bucket_order.end(), [&buckets](uint32_t lhs, uint32_t rhs) {
+        return buckets[lhs].size() > buckets[rhs].size();
+    });
+
+    std::vector<bool> is_occupied(name_count, false);
+    std::vector<uint32_t> bucket_slots;
+    for (uint32_t bucket : bucket_order) {
+        const std::vector<uint32_t>& ids = buckets[bucket];
+        if (ids.empty()) { break; }
+        bool is_placed = false;
+        for (uint32_t displacement = 0; displacement < MAX_DISPLACEMENT && !is_placed; ++displacement) {
+            bucket_slots.clear();
+            is_placed = true;
+            for (uint32_t id : ids) {
+                uint32_t slot_index = GetSlotIndex(hashes[id], displacement, name_count);
+                if (is_occupied[slot_index]
+                        || std::find(bucket_slots.begin(), bucket_slots.end(), slot_index) != bucket_slots.end()) {
+                    is_placed = false;
+                    break;
+                }
+                bucket_slots.push_back(slot_index);
+            }
+            if (is_placed) {
+                displacements_[bucket] = displacement;
+                for (size_t i = 0; i < ids.size(); ++i) {
+                    is_occupied[bucket_slots[i]] = true;
+                    slots_[bucket_slots[i]] = {static_cast<uint32_t>(hashes[ids[i]]), ids[i]};
+                }
+            }
+        }
+        if (!is_placed) { return false; }
+    }
+    return true;
+}
+
+uint32_t NamePerfectHash::GetBucket(uint64_t hash) const {
+    return static_cast<uint32_t>((hash >> 32) % displacements_.size());
+}
+
+//FNV-1a с зерном и перемешиванием, результат одинаков на всех платформах
+uint64_t NamePerfectHash::Hash(std::string_view name, uint64_t seed) {
+    uint64_t hash = 14695981039346656037ULL ^ Mix(seed);
+    for (char c : name) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ULL;
+    }
+    return Mix(hash);
+}
+
+uint32_t NamePerfectHash::GetSlotIndex(uint64_t hash, uint32_t displacement, size_t slot_count) {
+    return static_cast<uint32_t>(Mix(hash ^ (displacement * 0x9e3779b97f4a7c15ULL)) % slot_count);
+}
+
+}
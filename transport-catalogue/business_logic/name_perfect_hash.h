@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <string_view>
+#include <vector>
+
+namespace TransportGuide::BusinessLogic {
+
+/**Минимальная совершенная хеш-функция над неизменяемым набором имен по схеме CHD.
+ * Имена раскладываются по корзинам, для каждой корзины подобрано смещение, при котором все ее имена попадают
+ * в свободные ячейки. Ячеек ровно столько, сколько имен, в ячейке лежит отпечаток хеша и позиция имени.
+ * Поиск - одно вычисление хеша, чтение смещения и ячейки. Незнакомое имя почти всегда отсекается по отпечатку,
+ * совпадение отпечатка вызывающий подтверждает сравнением имени по найденной позиции.
+ * Хеш не зависит от платформы, поэтому таблица сериализуется вместе с базой*/
+class NamePerfectHash final {
+public:
+    static constexpr uint32_t NPOS = std::numeric_limits<uint32_t>::max();
+
+    struct Slot {
+        uint32_t fingerprint = 0;
+        uint32_t id = NPOS;
+    };
+
+    NamePerfectHash() = default;
+    /**Построить по списку различных имен, позиция имени в списке становится его id*/
+    explicit NamePerfectHash(const std::vector<std::string_view>& names);
+    /**Восстановить сериализованную таблицу*/
+    NamePerfectHash(uint64_t seed, std::vector<uint32_t> displacements, std::vector<Slot> slots);
+
+    /**Получить id имени-кандидата, если имени точно нет, возвращается NPOS*/
+    uint32_t Find(std::string_view name) const;
+
+    size_t size() const;
+    uint64_t GetSeed() const;
+    const std::vector<uint32_t>& GetDisplacements() const;
+    const std::vector<Slot>& GetSlots() const;
+    /**Байты в куче, занятые смещениями и ячейками*/
+    size_t GetMemoryUsage() const;
+
+private:
+    uint64_t seed_ = 0;
+    std::vector<uint32_t> displacements_;
+    std::vector<Slot> slots_;
+
+    bool TryBuild(const std::vector<std::string_view>& names, uint64_t seed);
+    uint32_t GetBucket(uint64_t hash) const;
+    static uint64_t Hash(std::string_view name, uint64_t seed);
+    static uint32_t GetSlotIndex(uint64_t hash, uint32_t displacement, size_t slot_count);
+};
+
+}
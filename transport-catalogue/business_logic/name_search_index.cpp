@@ -0,0 +1,180 @@
+#include <algorithm>
+#include <iterator>
+#include <numeric>
+#include <tuple>
+#include "name_search_index.h"
+#include "../external/memory_counter.h"
+
+namespace TransportGuide::BusinessLogic {
+
+//Минимальная похожесть для нечеткого поиска
+static const double MIN_FUZZY_SIMILARITY = 0.3;
+
+NameSearchIndex::NameSearchIndex(const std::vector<const Domain::Stop*>& stops,
+        const std::vector<const Domain::Bus*>& buses) {
+    std::vector<std::pair<std::string, Domain::SearchMatch>> keys;
+    keys.reserve(stops.size() + buses.size());
+    for (const Domain::Stop* stop : stops) {
+        keys.emplace_back(ToLower(stop->name), Domain::SearchMatch{.name = stop->name, .entity = stop});
+    }
+    for (const Domain::Bus* bus : buses) {
+        keys.emplace_back(ToLower(bus->name), Domain::SearchMatch{.name = bus->name, .entity = bus});
+    }
+    std::sort(keys.begin(), keys.end(), [](const auto& lhs, const auto& rhs) {
+        return std::tie(lhs.first, lhs.second.name) < std::tie(rhs.first, rhs.second.name);
+    });
+    
+    //Упаковываю имена в один буфер
+    size_t buffer_size = 0;
+    for (const auto& [key, match] : keys) {
+        buffer_size += key.size();
+    }
+    keys_buffer_.reserve(buffer_size);
+    entries_.reserve(keys.size());
+    for (const auto& [key, match] : keys) {
+        entries_.push_back({static_cast<uint32_t>(keys_buffer_.size()), static_cast<uint32_t>(key.size()), match});
+        keys_buffer_ += key;
+    }
+    
+    //CSR триграмма -> имена, имена в каждом списке по возрастанию индекса
+    std::vector<std::pair<uint32_t, uint32_t>> trigram_entry_pairs;
+    entry_trigrams_count_.reserve(entries_.size());
+    for (uint32_t entry_index = 0; entry_index < entries_.size(); ++entry_index) {
+        std::vector<uint32_t> trigrams = GetTrigrams(GetKey(entries_[entry_index]));
+        entry_trigrams_count_.push_back(static_cast<uint32_t>(trigrams.size()));
+        for (uint32_t trigram : trigrams) {
+            trigram_entry_pairs.emplace_back(trigram, entry_index);
+        }
+    }
+    std::sort(trigram_entry_pairs.begin(), trigram_entry_pairs.end());
+    trigram_entries_.reserve(trigram_entry_pairs.size());
+    for (const auto& [trigram, entry_index] : trigram_entry_pairs) {
+        if (trigram_codes_.empty() || trigram_codes_.back() != trigram) {
+            trigram_codes_.push_back(trigram);
+            trigram_offsets_.push_back(static_cast<uint32_t>(trigram_entries_.size()));
+        }
+        trigram_entries_.push_back(entry_index);
+    }
+    trigram_offsets_.push_back(static_cast<uint32_t>(trigram_entries_.size()));
+}
+
+std::vector<Domain::SearchMatch> NameSearchIndex::Search(std::string_view query, size_t limit, bool fuzzy) const {
+    std::vector<Domain::SearchMatch> result;
+    if (limit == 0) { return result; }
+    const std::string key = ToLower(query);
+    
+    //Совпадения по префиксу лежат подряд, начиная с нижней границы
+    auto it = std::lower_bound(entries_.begin(), entries_.end(), key, [this](const Entry& entry, const std::string& key) {
+        return GetKey(entry) < key;
+    });
+    std::vector<uint32_t> prefix_entries;
+    for (; it != entries_.end() && result.size() < limit; ++it) {
+        std::string_view entry_key = GetKey(*it);
+        if (entry_key.substr(0, key.size()) != key) { break; }
+        result.push_back(it->match);
+        prefix_entries.push_back(static_cast<uint32_t>(std::distance(entries_.begin(), it)));
+    }
+    if (!fuzzy || result.size() >= limit) { return result; }
+    
+    //Считаю общие триграммы слиянием списков вхождений
+    std::vector<uint32_t> query_trigrams = GetTrigrams(key);
+    std::vector<uint32_t> candidates;
+    for (uint32_t trigram : query_trigrams) {
+        auto code_it = std::lower_bound(trigram_codes_.begin(), trigram_codes_.end(), trigram);
+        if (code_it == trigram_codes_.end() || *code_it != trigram) { continue; }
+        size_t code_index = std::distance(trigram_codes_.begin(), code_it);
+        candidates.insert(candidates.end(), std::next(trigram_entries_.begin(), trigram_offsets_[code_index]),
+                std::next(trigram_entries_.begin(), trigram_offsets_[code_index + 1]));
+    }
+    std::sort(candidates.begin(), candidates.end());
+    
+    std::vector<Domain::SearchMatch> fuzzy_result;
+    for (auto candidate_it = candidates.begin(); candidate_it != candidates.end();) {
+        uint32_t entry_index = *candidate_it;
+        auto candidate_end = std::upper_bound(candidate_it, candidates.end(), entry_index);
+        double common = static_cast<double>(std::distance(candidate_it, candidate_end));
+        candidate_it = candidate_end;
+        if (std::binary_search(prefix_entries.begin(), prefix_entries.end(), entry_index)) { continue; }
+        double similarity = common / (query_trigrams.size() + entry_trigrams_count_[entry_index] - common);
+        if (similarity >= MIN_FUZZY_SIMILARITY) {
+            Domain::SearchMatch match = entries_[entry_index].match;
+            match.similarity = similarity;
+            fuzzy_result.push_back(match);
+        }
+    }
+    size_t fuzzy_count = std::min(limit - result.size(), fuzzy_result.size());
+    std::partial_sort(fuzzy_result.begin(), std::next(fuzzy_result.begin(), fuzzy_count), fuzzy_result.end(),
+            [](const Domain::SearchMatch& lhs, const Domain::SearchMatch& rhs) {
+                if (lhs.similarity != rhs.similarity) {
+                    return lhs.similarity > rhs.similarity;
+                }
+                return lhs.name < rhs.name;
+            });
+    std::copy_n(fuzzy_result.begin(), fuzzy_count, std::back_inserter(result));
+    return result;
+}
+
+std::string NameSearchIndex::ToLower(std::string_view name) {
+    std::string result;
+    result.reserve(name.size());
+    for (size_t i = 0; i < name.size(); ++i) {
+        unsigned char ch = name[i];
+        if (ch >= 'A' && ch <= 'Z') {
+            result += static_cast<char>(ch + ('a' - 'A'));
+        }
+        else if (ch == 0xD0 && i + 1 < name.size()) {
+            unsigned char next = name[++i];
+            if (next >= 0x90 && next <= 0x9F) {
+                //А-П -> а-п
+                result += static_cast<char>(0xD0);
+                result += static_cast<char>(next + 0x20);
+            }
+            else if (next >= 0xA0 && next <= 0xAF) {
+                //Р-Я -> р-я
+                result += static_cast<char>(0xD1);
+                result += static_cast<char>(next - 0x20);
+            }
+            else if (next == 0x81) {
+                //Ё -> ё
+                result += static_cast<char>(0xD1);
+                result += static_cast<char>(0x91);
+            }
+            else {
+                result += static_cast<char>(ch);
+                result += static_cast<char>(next);
+            }
+        }
+        else {
+            result += static_cast<char>(ch);
+        }
+    }
+    return result;
+}
+
+size_t NameSearchIndex::GetMemoryUsage() const {
+    return memory::MeasureString(keys_buffer_) + memory::MeasureVector(entries_) + memory::MeasureVector(trigram_codes_)
+            + memory::MeasureVector(trigram_offsets_) + memory::MeasureVector(trigram_entries_)
+            + memory::MeasureVector(entry_trigrams_count_);
+}
+
+std::string_view NameSearchIndex::GetKey(const Entry& entry) const {
+    return std::string_view(keys_buffer_).substr(entry.key_offset, entry.key_size);
+}
+
+std::vector<uint32_t> NameSearchIndex::GetTrigrams(std::string_view key) {
+    std::string padded;
+    padded.reserve(key.size() + 3);
+    padded.append(2, '\0').append(key).append(1, '\0');
+    std::vector<uint32_t> trigrams;
+    trigrams.reserve(padded.size());
+    for (size_t i = 0; i + 3 <= padded.size(); ++i) {
+        trigrams.push_back(static_cast<uint32_t>(static_cast<unsigned char>(padded[i])) << 16
+                           | static_cast<uint32_t>(static_cast<unsigned char>(padded[i + 1])) << 8
+                           | static_cast<uint32_t>(static_cast<unsigned char>(padded[i + 2])));
+    }
+    std::sort(trigrams.begin(), trigrams.end());
+    trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+    return trigrams;
+}
+
+}
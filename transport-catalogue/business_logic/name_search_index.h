@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "../domain/domain.h"
+
+namespace TransportGuide::BusinessLogic {
+
+/**Индекс поиска остановок и маршрутов по началу имени и по похожести имени.
+ * Имена в нижнем регистре упакованы в один буфер и отсортированы, поиск по префиксу — бинарный.
+ * Нечеткий поиск идет по спискам вхождений триграмм в формате CSR, похожесть — коэффициент Жаккара по триграммам*/
+class NameSearchIndex final {
+public:
+    NameSearchIndex() = default;
+    explicit NameSearchIndex(const std::vector<const Domain::Stop*>& stops, const std::vector<const Domain::Bus*>& buses);
+    
+    /**Найти не более limit имен. Сначала совпадения по префиксу в алфавитном порядке,
+     * если включен нечеткий поиск и мест осталось, то похожие имена по убыванию похожести*/
+    std::vector<Domain::SearchMatch> Search(std::string_view query, size_t limit, bool fuzzy = false) const;
+    /**Байты в куче, занятые буфером ключей и таблицами триграмм*/
+    size_t GetMemoryUsage() const;
+    
+    /**Привести имя к нижнему регистру, поддерживаются латиница и кириллица в UTF-8*/
+    static std::string ToLower(std::string_view name);
+
+private:
+    struct Entry {
+        uint32_t key_offset;
+        uint32_t key_size;
+        Domain::SearchMatch match;
+    };
+    
+    std::string keys_buffer_;
+    std::vector<Entry> entries_;
+    std::vector<uint32_t> trigram_codes_;
+    std::vector<uint32_t> trigram_offsets_;
+    std::vector<uint32_t> trigram_entries_;
+    std::vector<uint32_t> entry_trigrams_count_;
+    
+    std::string_view GetKey(const Entry& entry) const;
+    /**Уникальные триграммы имени по возрастанию, имя дополняется нулевыми байтами по краям*/
+    static std::vector<uint32_t> GetTrigrams(std::string_view key);
+};
+
+}
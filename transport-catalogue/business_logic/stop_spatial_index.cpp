@@ -0,0 +1,182 @@
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include "stop_spatial_index.h"
+#include "../external/memory_counter.h"
+
+namespace TransportGuide::BusinessLogic {
+
+//Должны совпадать с константами geo::ComputeDistance
+static const double DEGREES_TO_RADIANS = 3.1415926535 / 180.;
+static const double AVERAGE_RADIUS_EARTH = 6371000.;
+//Запас на погрешность acos в geo::ComputeDistance на малых расстояниях
+static const double LOWER_BOUND_TOLERANCE = 1.;
+//Среднее количество остановок в ячейке
+static const size_t STOPS_PER_CELL = 2;
+
+StopSpatialIndex::StopSpatialIndex(const std::vector<const Domain::Stop*>& stops) {
+    std::vector<IndexedStop> indexed_stops;
+    indexed_stops.reserve(stops.size());
+    for (const Domain::Stop* stop : stops) {
+        if (stop->is_fill) {
+            indexed_stops.push_back({{stop->latitude, stop->longitude}, stop});
+        }
+    }
+    if (indexed_stops.empty()) { return; }
+    
+    auto [min_lat_it, max_lat_it] = std::minmax_element(indexed_stops.begin(), indexed_stops.end(),
+            [](const IndexedStop& lhs, const IndexedStop& rhs) {
+                return lhs.coordinates.lat < rhs.coordinates.lat;
+            });
+    auto [min_lng_it, max_lng_it] = std::minmax_element(indexed_stops.begin(), indexed_stops.end(),
+            [](const IndexedStop& lhs, const IndexedStop& rhs) {
+                return lhs.coordinates.lng < rhs.coordinates.lng;
+            });
+    min_lat_ = min_lat_it->coordinates.lat;
+    min_lng_ = min_lng_it->coordinates.lng;
+    double lat_span = std::max(max_lat_it->coordinates.lat - min_lat_, 1e-9);
+    double lng_span = std::max(max_lng_it->coordinates.lng - min_lng_, 1e-9);
+    
+    //Пропорции сетки по размерам в метрах, чтобы ячейки были близки к квадрату
+    size_t cells_count = std::max<size_t>(1, indexed_stops.size() / STOPS_PER_CELL);
+    double mid_lat_cos = std::max(std::cos((min_lat_ + lat_span / 2) * DEGREES_TO_RADIANS), 1e-3);
+    double aspect = lng_span * mid_lat_cos / lat_span;
+    cols_ = static_cast<uint32_t>(std::clamp(std::round(std::sqrt(cells_count * aspect)), 1., double(cells_count)));
+    rows_ = static_cast<uint32_t>(std::clamp(std::ceil(double(cells_count) / cols_), 1., double(cells_count)));
+    //Каталог пересекает 180-й меридиан, сетка без переноса долготы неприменима, ищу перебором в одной ячейке
+    if (lng_span > 180.) {
+        rows_ = cols_ = 1;
+    }
+    cell_lat_ = lat_span / rows_;
+    cell_lng_ = lng_span / cols_;
+    
+    //Раскладываю остановки по ячейкам подсчетом
+    auto get_cell = [this](Domain::geo::Coordinates coordinates) {
+        int64_t row = std::clamp<int64_t>(std::floor((coordinates.lat - min_lat_) / cell_lat_), 0, rows_ - 1);
+        int64_t col = std::clamp<int64_t>(std::floor((coordinates.lng - min_lng_) / cell_lng_), 0, cols_ - 1);
+        return static_cast<size_t>(row * cols_ + col);
+    };
+    cell_offsets_.assign(static_cast<size_t>(rows_) * cols_ + 1, 0);
+    for (const IndexedStop& indexed_stop : indexed_stops) {
+        ++cell_offsets_[get_cell(indexed_stop.coordinates) + 1];
+    }
+    std::partial_sum(cell_offsets_.begin(), cell_offsets_.end(), cell_offsets_.begin());
+    cell_stops_.resize(indexed_stops.size());
+    std::vector<uint32_t> cell_fill(cell_offsets_.begin(), std::prev(cell_offsets_.end()));
+    for (const IndexedStop& indexed_stop : indexed_stops) {
+        cell_stops_[cell_fill[get_cell(indexed_stop.coordinates)]++] = indexed_stop;
+    }
+}
+
+std::vector<Domain::StopDistance> StopSpatialIndex::GetNearestStops(Domain::geo::Coordinates point,
+        size_t count) const {
+    std::vector<Domain::StopDistance> result;
+    if (count == 0) { return result; }
+    //Куча по убыванию близости, в вершине самая дальняя из найденных остановок
+    VisitRings(point, [&result, count](const Domain::Stop* stop, double distance) {
+        Domain::StopDistance stop_distance{stop, distance};
+        if (result.size() < count) {
+            result.push_back(stop_distance);
+            std::push_heap(result.begin(), result.end(), IsCloser);
+        }
+        else if (IsCloser(stop_distance, result.front())) {
+            std::pop_heap(result.begin(), result.end(), IsCloser);
+            result.back() = stop_distance;
+            std::push_heap(result.begin(), result.end(), IsCloser);
+        }
+    }, [&result, count]() {
+        return result.size() < count ? std::numeric_limits<double>::infinity() : result.front().distance;
+    });
+    std::sort_heap(result.begin(), result.end(), IsCloser);
+    return result;
+}
+
+std::vector<Domain::StopDistance> StopSpatialIndex::GetStopsInRadius(Domain::geo::Coordinates point,
+        double radius) const {
+    std::vector<Domain::StopDistance> result;
+    if (radius < 0) { return result; }
+    VisitRings(point, [&result, radius](const Domain::Stop* stop, double distance) {
+        if (distance <= radius) {
+            result.push_back({stop, distance});
+        }
+    }, [radius]() {
+        return radius;
+    });
+    std::sort(result.begin(), result.end(), IsCloser);
+    return result;
+}
+
+size_t StopSpatialIndex::GetMemoryUsage() const {
+    return memory::MeasureVector(cell_offsets_) + memory::MeasureVector(cell_stops_);
+}
+
+template<typename Visitor, typename Limit>
+void StopSpatialIndex::VisitRings(Domain::geo::Coordinates point, Visitor visitor, Limit limit) const {
+    if (cell_stops_.empty()) { return; }
+    const int64_t rows = rows_;
+    const int64_t cols = cols_;
+    const int64_t center_row = std::clamp<int64_t>(std::floor((point.lat - min_lat_) / cell_lat_), 0, rows - 1);
+    const int64_t center_col = std::clamp<int64_t>(std::floor((point.lng - min_lng_) / cell_lng_), 0, cols - 1);
+    
+    auto visit_cell = [&](int64_t row, int64_t col) {
+        size_t cell = static_cast<size_t>(row * cols + col);
+        for (uint32_t i = cell_offsets_[cell]; i < cell_offsets_[cell + 1]; ++i) {
+            const IndexedStop& indexed_stop = cell_stops_[i];
+            visitor(indexed_stop.stop, Domain::geo::ComputeDistance(point, indexed_stop.coordinates));
+        }
+    };
+    
+    for (int64_t ring = 0;; ++ring) {
+        int64_t row_begin = std::max<int64_t>(center_row - ring, 0);
+        int64_t row_end = std::min<int64_t>(center_row + ring + 1, rows);
+        int64_t col_begin = std::max<int64_t>(center_col - ring, 0);
+        int64_t col_end = std::min<int64_t>(center_col + ring + 1, cols);
+        //Обхожу только ячейки на границе кольца
+        for (int64_t row = row_begin; row < row_end; ++row) {
+            bool is_border_row = row == center_row - ring || row == center_row + ring;
+            for (int64_t col = col_begin; col < col_end; ++col) {
+                if (is_border_row || col == center_col - ring || col == center_col + ring) {
+                    visit_cell(row, col);
+                }
+            }
+        }
+        if (row_begin == 0 && row_end == rows && col_begin == 0 && col_end == cols) { break; }
+        if (GetOutsideLowerBound(point, row_begin, row_end, col_begin, col_end) > limit()) { break; }
+    }
+}
+
+double StopSpatialIndex::GetOutsideLowerBound(Domain::geo::Coordinates point, int64_t row_begin, int64_t row_end,
+        int64_t col_begin, int64_t col_end) const {
+    double bound = std::numeric_limits<double>::infinity();
+    //По широте расстояние не меньше дуги меридиана
+    if (row_begin > 0) {
+        double delta = point.lat - (min_lat_ + row_begin * cell_lat_);
+        bound = std::min(bound, std::max(delta, 0.) * DEGREES_TO_RADIANS * AVERAGE_RADIUS_EARTH);
+    }
+    if (row_end < rows_) {
+        double delta = (min_lat_ + row_end * cell_lat_) - point.lat;
+        bound = std::min(bound, std::max(delta, 0.) * DEGREES_TO_RADIANS * AVERAGE_RADIUS_EARTH);
+    }
+    //По долготе расстояние не меньше расстояния до плоскости меридиана на краю блока
+    auto lng_bound = [&point](double delta) {
+        delta = std::clamp(delta, 0., 90.);
+        double sin_arc = std::cos(point.lat * DEGREES_TO_RADIANS) * std::sin(delta * DEGREES_TO_RADIANS);
+        return std::asin(std::clamp(std::abs(sin_arc), 0., 1.)) * AVERAGE_RADIUS_EARTH;
+    };
+    if (col_begin > 0) {
+        bound = std::min(bound, lng_bound(point.lng - (min_lng_ + col_begin * cell_lng_)));
+    }
+    if (col_end < cols_) {
+        bound = std::min(bound, lng_bound((min_lng_ + col_end * cell_lng_) - point.lng));
+    }
+    return bound - LOWER_BOUND_TOLERANCE;
+}
+
+bool StopSpatialIndex::IsCloser(const Domain::StopDistance& lhs, const Domain::StopDistance& rhs) {
+    if (lhs.distance != rhs.distance) {
+        return lhs.distance < rhs.distance;
+    }
+    return lhs.stop->name < rhs.stop->name;
+}
+
+}
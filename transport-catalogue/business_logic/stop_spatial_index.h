@@ -0,0 +1,93 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+#include "../domain/domain.h"
+#include "../domain/geo.h"
+
+namespace TransportGuide::BusinessLogic {
+
+/**Пространственный индекс остановок: равномерная сетка по широте и долготе.
+ * Ячейки хранятся в формате CSR (смещения + плоский массив остановок с координатами),
+ * поиск обходит кольца ячеек вокруг точки и останавливается, когда нижняя оценка расстояния
+ * до необойденных ячеек превышает найденный результат. Индексируются только заполненные остановки*/
+class StopSpatialIndex final {
+public:
+    StopSpatialIndex() = default;
+    explicit StopSpatialIndex(const std::vector<const Domain::Stop*>& stops);
+
+    /**Ближайшие к точке остановки, не более count, по возрастанию расстояния*/
+    std::vector<Domain::StopDistance> GetNearestStops(Domain::geo::Coordinates point, size_t count) const;
+    /**Остановки не дальше radius метров от точки, по возрастанию расстояния*/
+    std::vector<Domain::StopDistance> GetStopsInRadius(Domain::geo::Coordinates point, double radius) const;
+    /**Байты в куче, занятые ячейками сетки*/
+    size_t GetMemoryUsage() const;
+
+    /**Линейный поиск ближайших остановок, используется для незамороженного каталога*/
+    template<typename StopIt>
+    static std::vector<Domain::StopDistance> ScanNearestStops(StopIt begin, StopIt end, Domain::geo::Coordinates point,
+            size_t count);
+    /**Линейный поиск остановок в радиусе, используется для незамороженного каталога*/
+    template<typename StopIt>
+    static std::vector<Domain::StopDistance> ScanStopsInRadius(StopIt begin, StopIt end, Domain::geo::Coordinates point,
+            double radius);
+
+private:
+    struct IndexedStop {
+        Domain::geo::Coordinates coordinates;
+        const Domain::Stop* stop;
+    };
+
+    double min_lat_ = 0;
+    double min_lng_ = 0;
+    double cell_lat_ = 1;
+    double cell_lng_ = 1;
+    uint32_t rows_ = 0;
+    uint32_t cols_ = 0;
+    std::vector<uint32_t> cell_offsets_;
+    std::vector<IndexedStop> cell_stops_;
+
+    /**Обход колец ячеек, visitor получает остановку и расстояние до нее, limit возвращает текущий предел поиска в метрах*/
+    template<typename Visitor, typename Limit>
+    void VisitRings(Domain::geo::Coordinates point, Visitor visitor, Limit limit) const;
+    /**Нижняя оценка расстояния от точки до остановок вне блока ячеек*/
+    double GetOutsideLowerBound(Domain::geo::Coordinates point, int64_t row_begin, int64_t row_end, int64_t col_begin,
+            int64_t col_end) const;
+
+    static bool IsCloser(const Domain::StopDistance& lhs, const Domain::StopDistance& rhs);
+};
+
+template<typename StopIt>
+std::vector<Domain::StopDistance> StopSpatialIndex::ScanNearestStops(StopIt begin, StopIt end,
+        Domain::geo::Coordinates point, size_t count) {
+    std::vector<Domain::StopDistance> result;
+    for (auto it = begin; it != end; ++it) {
+        const Domain::Stop& stop = *it;
+        if (!stop.is_fill) { continue; }
+        result.push_back({&stop, Domain::geo::ComputeDistance(point, {stop.latitude, stop.longitude})});
+    }
+    count = std::min(count, result.size());
+    std::partial_sort(result.begin(), std::next(result.begin(), count), result.end(), IsCloser);
+    result.resize(count);
+    return result;
+}
+
+template<typename StopIt>
+std::vector<Domain::StopDistance> StopSpatialIndex::ScanStopsInRadius(StopIt begin, StopIt end,
+        Domain::geo::Coordinates point, double radius) {
+    std::vector<Domain::StopDistance> result;
+    for (auto it = begin; it != end; ++it) {
+        const Domain::Stop& stop = *it;
+        if (!stop.is_fill) { continue; }
+        double distance = Domain::geo::ComputeDistance(point, {stop.latitude, stop.longitude});
+        if (distance <= radius) {
+            result.push_back({&stop, distance});
+        }
+    }
+    std::sort(result.begin(), result.end(), IsCloser);
+    return result;
+}
+
+}
@@ -4,6 +4,8 @@
 #include <iterator>
 #include <numeric>
 #include <algorithm>
+#include <thread>
+#include <exception>
 #include "transport_catalogue.h"
 #include "../domain/geo.h"
 
@@ -12,43 +14,237 @@ using namespace std::literals;
 
 //region Public section TransportCatalogue
 
+TransportCatalogue::TransportCatalogue(std::pmr::memory_resource* resource) : resource_(resource),
+        bus_catalog_(resource), stop_catalog_(resource), stop_name_catalog_(resource),
+        calculated_distance_catalog_(resource), real_distance_catalog_(resource), bus_name_catalog_(resource),
+        stop_buses_catalog_(resource), route_pool_(std::make_unique<Domain::RoutePool>(resource)) {}
+
+TransportCatalogue::TransportCatalogue() : TransportCatalogue(std::pmr::get_default_resource()) {}
+
 Domain::Bus* TransportCatalogue::InsertBus(const Domain::Bus& bus) {
+    return InsertBus(Domain::Bus(bus));
+}
+
+Domain::Bus* TransportCatalogue::InsertBus(Domain::Bus&& bus) {
+    CheckNotFrozen();
+    ++version_;
+    //Маршруты каталога хранятся только в хранилище каталога
+    bus.route = Domain::RoutePool::Intern(*route_pool_, bus.route);
+    bus.own_route_pool_.reset();
     Domain::Bus* bus_ptr;
-    if (bus_name_catalog_.count(bus.name)) {
-        bus_ptr = bus_name_catalog_.at(bus.name);
+    if (auto it = bus_name_catalog_.find(bus.name); it != bus_name_catalog_.end()) {
+        bus_ptr = it->second;
         EraseBusInStopBusesCatalog(bus_ptr);
         bus_ptr->Update(bus);
         AddBusInStopBusesCatalog(bus_ptr);
     }
     else {
-        bus_catalog_.push_back(bus);
+        ResetNameLookup();
+        bus_catalog_.push_back(std::move(bus));
         bus_ptr = &bus_catalog_.back();
-        bus_name_catalog_.insert({bus_ptr->name, bus_ptr});
+        bus_name_catalog_.emplace(bus_ptr->name, bus_ptr);
         AddBusInStopBusesCatalog(bus_ptr);
     }
     return bus_ptr;
 }
 
 Domain::Stop* TransportCatalogue::InsertStop(const Domain::Stop& stop) {
+    CheckNotFrozen();
+    ++version_;
     Domain::Stop* stop_ptr;
-    if (!stop_name_catalog_.count(stop.name)) {
+    if (auto it = stop_name_catalog_.find(stop.name); it == stop_name_catalog_.end()) {
+        ResetNameLookup();
         stop_catalog_.push_back(stop);
         stop_ptr = &stop_catalog_.back();
-        stop_name_catalog_.insert({stop_ptr->name, stop_ptr});
+        stop_name_catalog_.emplace(stop_ptr->name, stop_ptr);
     }
     else if (stop.is_fill) {
-        stop_ptr = stop_name_catalog_.at(stop.name);
+        stop_ptr = it->second;
         stop_ptr->Update(stop);
     }
     else {
-        stop_ptr = stop_name_catalog_.at(stop.name);
+        stop_ptr = it->second;
+    }
+    return stop_ptr;
+}
+
+Domain::Stop* TransportCatalogue::InsertStop(std::string_view name, double latitude, double longitude) {
+    CheckNotFrozen();
+    ++version_;
+    if (auto it = stop_name_catalog_.find(name); it != stop_name_catalog_.end()) {
+        Domain::Stop* stop_ptr = it->second;
+        stop_ptr->SetCoordinates(latitude, longitude);
+        return stop_ptr;
+    }
+    ResetNameLookup();
+    Domain::Stop* stop_ptr = &stop_catalog_.emplace_back(std::string(name), latitude, longitude);
+    stop_name_catalog_.emplace(stop_ptr->name, stop_ptr);
+    return stop_ptr;
+}
+
+Domain::Stop* TransportCatalogue::InsertStop(std::string_view name) {
+    CheckNotFrozen();
+    ++version_;
+    if (auto it = stop_name_catalog_.find(name); it != stop_name_catalog_.end()) {
+        return it->second;
     }
+    ResetNameLookup();
+    Domain::Stop* stop_ptr = &stop_catalog_.emplace_back(std::string(name));
+    stop_name_catalog_.emplace(stop_ptr->name, stop_ptr);
     return stop_ptr;
 }
 
+bool TransportCatalogue::RemoveBus(std::string_view name) {
+    CheckNotFrozen();
+    auto it = bus_name_catalog_.find(name);
+    if (it == bus_name_catalog_.end()) { return false; }
+    ResetNameLookup();
+    EraseBusInStopBusesCatalog(it->second);
+    bus_name_catalog_.erase(it);
+    ++removed_buses_count_;
+    ++version_;
+    return true;
+}
+
+bool TransportCatalogue::RemoveStop(std::string_view name) {
+    CheckNotFrozen();
+    auto it = stop_name_catalog_.find(name);
+    if (it == stop_name_catalog_.end()) { return false; }
+    const Domain::Stop* stop_ptr = it->second;
+    if (auto buses_it = stop_buses_catalog_.find(stop_ptr); buses_it != stop_buses_catalog_.end()) {
+        if (!buses_it->second.empty()) {
+            throw std::logic_error("Stop \""s + std::string(name) + "\" is used by buses and cannot be removed."s);
+        }
+        stop_buses_catalog_.erase(buses_it);
+    }
+    ResetNameLookup();
+    stop_name_catalog_.erase(it);
+    ++removed_stops_count_;
+    ++version_;
+    return true;
+}
+
+bool TransportCatalogue::IsRemoved(const Domain::Bus* bus) const {
+    auto it = bus_name_catalog_.find(bus->name);
+    return it == bus_name_catalog_.end() || it->second != bus;
+}
+
+bool TransportCatalogue::IsRemoved(const Domain::Stop* stop) const {
+    auto it = stop_name_catalog_.find(stop->name);
+    return it == stop_name_catalog_.end() || it->second != stop;
+}
+
+size_t TransportCatalogue::GetRemovedCount() const {
+    return removed_buses_count_ + removed_stops_count_;
+}
+
+void TransportCatalogue::Compact() {
+    CheckNotFrozen();
+    if (GetRemovedCount() == 0) { return; }
+    ++version_;
+    
+    //Отбираю живые объекты до переноса: после переноса имена в словарях указывают на пустые строки
+    std::vector<Domain::Stop*> live_stops;
+    live_stops.reserve(stop_name_catalog_.size());
+    for (Domain::Stop& stop : stop_catalog_) {
+        if (!IsRemoved(&stop)) { live_stops.push_back(&stop); }
+    }
+    std::vector<Domain::Bus*> live_buses;
+    live_buses.reserve(bus_name_catalog_.size());
+    for (Domain::Bus& bus : bus_catalog_) {
+        if (!IsRemoved(&bus)) { live_buses.push_back(&bus); }
+    }
+    //Маршрутизатор хранит указатели на остановки и маршруты
+    user_route_manager_.reset();
+    ResetNameLookup();
+    stop_name_catalog_.clear();
+    bus_name_catalog_.clear();
+    stop_buses_catalog_.clear();
+    
+    std::pmr::deque<Domain::Stop> stop_catalog(resource_);
+    std::unordered_map<const Domain::Stop*, const Domain::Stop*> stop_remap;
+    stop_remap.reserve(live_stops.size());
+    for (Domain::Stop* stop_ptr : live_stops) {
+        Domain::Stop* new_stop_ptr = &stop_catalog.emplace_back(std::move(*stop_ptr));
+        stop_name_catalog_.emplace(new_stop_ptr->name, new_stop_ptr);
+        stop_remap.emplace(stop_ptr, new_stop_ptr);
+    }
+    
+    //Расстояния с удаленными остановками выбрасываются, остальные переносятся на новые адреса
+    auto remap_distances = [&stop_remap](auto& distance_catalog) {
+        std::remove_reference_t<decltype(distance_catalog)> new_distance_catalog(distance_catalog.get_allocator());
+        new_distance_catalog.reserve(distance_catalog.size());
+        for (const auto& [track_section, distance] : distance_catalog) {
+            auto left_it = stop_remap.find(track_section.first);
+            auto right_it = stop_remap.find(track_section.second);
+            if (left_it != stop_remap.end() && right_it != stop_remap.end()) {
+                new_distance_catalog.emplace(Domain::TrackSection{left_it->second, right_it->second}, distance);
+            }
+        }
+        distance_catalog = std::move(new_distance_catalog);
+    };
+    remap_distances(real_distance_catalog_);
+    remap_distances(calculated_distance_catalog_);
+    
+    //Маршруты складываются в новое хранилище, отрезки удаленных маршрутов в него не попадают
+    std::pmr::deque<Domain::Bus> bus_catalog(resource_);
+    std::unique_ptr<Domain::RoutePool> route_pool = std::make_unique<Domain::RoutePool>(resource_);
+    std::vector<const Domain::Stop*> stops;
+    for (Domain::Bus* bus_ptr : live_buses) {
+        stops.clear();
+        for (const Domain::Stop* stop : bus_ptr->route) {
+            stops.push_back(stop_remap.at(stop));
+        }
+        Domain::Bus* new_bus_ptr = &bus_catalog.emplace_back(std::move(*bus_ptr));
+        new_bus_ptr->route = Domain::RoutePool::Intern(*route_pool, stops, new_bus_ptr->number_final_stop_);
+        bus_name_catalog_.emplace(new_bus_ptr->name, new_bus_ptr);
+        AddBusInStopBusesCatalog(new_bus_ptr);
+    }
+    
+    stop_catalog_ = std::move(stop_catalog);
+    bus_catalog_ = std::move(bus_catalog);
+    route_pool_ = std::move(route_pool);
+    removed_buses_count_ = 0;
+    removed_stops_count_ = 0;
+}
+
+void TransportCatalogue::BuildNameLookup() {
+    if (GetRemovedCount()) {
+        throw std::logic_error("TransportCatalogue must be compacted before building name lookup."s);
+    }
+    std::vector<std::string_view> names;
+    names.reserve(stop_catalog_.size());
+    for (const Domain::Stop& stop : stop_catalog_) {
+        names.push_back(stop.name);
+    }
+    stop_name_lookup_.emplace(names);
+    names.clear();
+    for (const Domain::Bus& bus : bus_catalog_) {
+        names.push_back(bus.name);
+    }
+    bus_name_lookup_.emplace(names);
+}
+
+bool TransportCatalogue::HasNameLookup() const {
+    return stop_name_lookup_.has_value() && bus_name_lookup_.has_value();
+}
+
 std::optional<const Domain::Bus*> TransportCatalogue::FindBus(std::string_view name) const {
-    if (bus_name_catalog_.count(name)) {
-        return bus_name_catalog_.at(name);
+    if (bus_name_lookup_) {
+        uint32_t id = bus_name_lookup_->Find(name);
+        if (id != NamePerfectHash::NPOS && bus_catalog_[id].name == name) {
+            return &bus_catalog_[id];
+        }
+        return std::nullopt;
+    }
+    if (snapshot_) {
+        if (const Domain::Bus* bus_ptr = snapshot_->FindBus(name)) {
+            return bus_ptr;
+        }
+        return std::nullopt;
+    }
+    if (auto it = bus_name_catalog_.find(name); it != bus_name_catalog_.end()) {
+        return it->second;
     }
     else {
         return std::nullopt;
@@ -56,8 +252,21 @@ std::optional<const Domain::Bus*> TransportCatalogue::FindBus(std::string_view n
 }
 
 std::optional<const Domain::Stop*> TransportCatalogue::FindStop(std::string_view name) const {
-    if (stop_name_catalog_.count(name)) {
-        return stop_name_catalog_.at(name);
+    if (stop_name_lookup_) {
+        uint32_t id = stop_name_lookup_->Find(name);
+        if (id != NamePerfectHash::NPOS && stop_catalog_[id].name == name) {
+            return &stop_catalog_[id];
+        }
+        return std::nullopt;
+    }
+    if (snapshot_) {
+        if (const Domain::Stop* stop_ptr = snapshot_->FindStop(name)) {
+            return stop_ptr;
+        }
+        return std::nullopt;
+    }
+    if (auto it = stop_name_catalog_.find(name); it != stop_name_catalog_.end()) {
+        return it->second;
     }
     else {
         return std::nullopt;
@@ -66,6 +275,18 @@ std::optional<const Domain::Stop*> TransportCatalogue::FindStop(std::string_view
 
 std::optional<Domain::BusInfo> TransportCatalogue::GetBusInfo(
         const Domain::Bus* bus) const {
+    const TransportCatalogueSnapshot::Index bus_index = snapshot_ && bus ? snapshot_->GetBusIndex(bus)
+                                                                         : TransportCatalogueSnapshot::NPOS;
+    if (bus_index != TransportCatalogueSnapshot::NPOS) {
+        return Domain::BusInfo{.name = bus->name,
+                               .stops_count = snapshot_->GetBusStopsCount(bus_index),
+                               .unique_stops_count = bus->unique_stops_count,
+                               .length = bus->real_length,
+                               .curvature = bus->real_length / bus->calc_length};
+    }
+    else if (snapshot_) {
+        return std::nullopt;
+    }
     if (bus && bus_name_catalog_.count(bus->name) && bus_name_catalog_.at(bus->name) == bus) {
         Domain::BusInfo bus_info;
         bus_info.name = bus->name;
@@ -95,6 +316,11 @@ std::optional<Domain::BusInfo> TransportCatalogue::GetBusInfo(std::string_view b
 std::optional<Domain::StopInfo> TransportCatalogue::GetStopInfo(
         const Domain::Stop* stop) const {
     if (!stop) { return std::nullopt; }
+    if (snapshot_) {
+        TransportCatalogueSnapshot::Index stop_index = snapshot_->GetStopIndex(stop);
+        if (stop_index == TransportCatalogueSnapshot::NPOS) { return std::nullopt; }
+        return Domain::StopInfo{.name = stop->name, .buses = snapshot_->GetBusesByStop(stop_index)};
+    }
     if (stop_name_catalog_.count(stop->name) && stop_name_catalog_.at(stop->name) == stop) {
         Domain::StopInfo stop_info;
         stop_info.name = stop->name;
@@ -116,7 +342,51 @@ std::optional<Domain::StopInfo> TransportCatalogue::GetStopInfo(std::string_view
     }
 }
 
+std::vector<Domain::StopDistance> TransportCatalogue::GetNearestStops(Domain::geo::Coordinates point,
+        size_t count) const {
+    if (snapshot_) {
+        return snapshot_->GetSpatialIndex().GetNearestStops(point, count);
+    }
+    if (GetRemovedCount() == 0) {
+        return StopSpatialIndex::ScanNearestStops(stop_catalog_.begin(), stop_catalog_.end(), point, count);
+    }
+    std::vector<std::reference_wrapper<const Domain::Stop>> stops = GetLiveStops();
+    return StopSpatialIndex::ScanNearestStops(stops.begin(), stops.end(), point, count);
+}
+
+std::vector<Domain::StopDistance> TransportCatalogue::GetStopsInRadius(Domain::geo::Coordinates point,
+        double radius) const {
+    if (snapshot_) {
+        return snapshot_->GetSpatialIndex().GetStopsInRadius(point, radius);
+    }
+    if (GetRemovedCount() == 0) {
+        return StopSpatialIndex::ScanStopsInRadius(stop_catalog_.begin(), stop_catalog_.end(), point, radius);
+    }
+    std::vector<std::reference_wrapper<const Domain::Stop>> stops = GetLiveStops();
+    return StopSpatialIndex::ScanStopsInRadius(stops.begin(), stops.end(), point, radius);
+}
+
+std::vector<Domain::SearchMatch> TransportCatalogue::SearchNames(std::string_view query, size_t limit,
+        bool fuzzy) const {
+    if (snapshot_) {
+        return snapshot_->GetNameSearchIndex().Search(query, limit, fuzzy);
+    }
+    std::vector<const Domain::Stop*> stops;
+    stops.reserve(stop_catalog_.size());
+    for (const Domain::Stop& stop : stop_catalog_) {
+        if (removed_stops_count_ == 0 || !IsRemoved(&stop)) { stops.push_back(&stop); }
+    }
+    std::vector<const Domain::Bus*> buses;
+    buses.reserve(bus_catalog_.size());
+    for (const Domain::Bus& bus : bus_catalog_) {
+        if (removed_buses_count_ == 0 || !IsRemoved(&bus)) { buses.push_back(&bus); }
+    }
+    return NameSearchIndex(stops, buses).Search(query, limit, fuzzy);
+}
+
 void TransportCatalogue::AddRealDistanceToCatalog(Domain::TrackSection track_section, double distance) {
+    CheckNotFrozen();
+    ++version_;
     real_distance_catalog_[track_section] = distance;
 }
 
@@ -125,6 +395,7 @@ void TransportCatalogue::AddRealDistanceToCatalog(const Domain::Stop* left, cons
     AddRealDistanceToCatalog({left, right}, distance);
 }
 
+//Замороженный каталог читает те же словари: поиск по хэшу быстрее перевода указателей в индексы снимка
 double TransportCatalogue::GetDistance(Domain::TrackSection track_section) const {
     std::optional<double> dist = GetRealDistance(track_section);
     if (dist.has_value()) {
@@ -138,51 +409,52 @@ double TransportCatalogue::GetDistance(const Domain::Stop* left, const Domain::S
 }
 
 double TransportCatalogue::GetBusCalculateLength(const std::vector<const Domain::Stop*>& route) const {
-    //Применил стандартный алгоритм вместо промежуточного контейнера
-    auto compute_route_dist = [this](const Domain::Stop* left,
-            const Domain::Stop* right) {
-        return GetCalculatedDistance({left, right});
-    };
-    return std::transform_reduce(route.begin(), std::prev(route.end()), std::next(route.begin()), 0., std::plus<>(),
-            compute_route_dist);
+    std::vector<double> distances = ComputeRouteCalculatedDistances(route);
+    return std::accumulate(distances.begin(), distances.end(), 0.);
+}
+
+double TransportCatalogue::GetBusCalculateLength(const Domain::Route& route) const {
+    std::vector<double> distances = ComputeRouteCalculatedDistances(route);
+    return std::accumulate(distances.begin(), distances.end(), 0.);
 }
 
 double TransportCatalogue::GetBusRealLength(const std::vector<const Domain::Stop*>& route) const {
-    //Применил стандартный алгоритм вместо промежуточного контейнера
-    auto compute_route_dist = [this](const Domain::Stop* left,
-            const Domain::Stop* right) {
-        std::optional<double> distance_opt = GetRealDistance({left, right});
-        if (distance_opt.has_value()) {
-            return distance_opt.value();
-        }
-        else {
-            return GetCalculatedDistance({left, right});
-        }
-    };
-    return std::transform_reduce(route.begin(), std::prev(route.end()), std::next(route.begin()), 0., std::plus<>(),
-            compute_route_dist);
+    return ComputeRouteRealLength(route);
 }
 
-const std::unordered_map<std::string_view, Domain::Bus*>& TransportCatalogue::GetBusNameCatalog() const {
+double TransportCatalogue::GetBusRealLength(const Domain::Route& route) const {
+    return ComputeRouteRealLength(route);
+}
+
+const std::pmr::unordered_map<std::string_view, Domain::Bus*>& TransportCatalogue::GetBusNameCatalog() const {
     return bus_name_catalog_;
 }
 
-const std::unordered_map<std::string_view, Domain::Stop*>& TransportCatalogue::GetStopNameCatalog() const {
+const std::pmr::unordered_map<std::string_view, Domain::Stop*>& TransportCatalogue::GetStopNameCatalog() const {
     return stop_name_catalog_;
 }
 
-const std::deque<Domain::Stop>& TransportCatalogue::GetStops() const {
+const std::pmr::deque<Domain::Stop>& TransportCatalogue::GetStops() const {
     return stop_catalog_;
 }
 
-const std::deque<Domain::Bus>& TransportCatalogue::GetBuses() const {
+const std::pmr::deque<Domain::Bus>& TransportCatalogue::GetBuses() const {
     return bus_catalog_;
 }
 
 void TransportCatalogue::ConstructUserRouteManager(Domain::RoutingSettings routing_settings) {
+    CheckNotFrozen();
     user_route_manager_.emplace(*this, routing_settings);
 }
 
+bool TransportCatalogue::HasUserRouteManager() const {
+    return user_route_manager_.has_value();
+}
+
+std::pmr::memory_resource* TransportCatalogue::GetMemoryResource() const {
+    return resource_;
+}
+
 const TransportRouter& TransportCatalogue::GetUserRouteManager() const {
     if (!user_route_manager_.has_value()) {
         throw std::logic_error("TransportRouter is not construct."s);
@@ -190,15 +462,56 @@ const TransportRouter& TransportCatalogue::GetUserRouteManager() const {
     return *user_route_manager_;
 }
 
+void TransportCatalogue::Freeze() {
+    if (snapshot_) { return; }
+    snapshot_ = std::make_shared<const TransportCatalogueSnapshot>(*this);
+}
+
+bool TransportCatalogue::IsFrozen() const {
+    return snapshot_ != nullptr;
+}
+
+std::shared_ptr<const TransportCatalogueSnapshot> TransportCatalogue::GetSnapshot() const {
+    return snapshot_;
+}
+
+uint64_t TransportCatalogue::GetVersion() const {
+    return version_;
+}
+
 //endregion
 
 //region Private section TransportCatalogue
 
+void TransportCatalogue::CheckNotFrozen() const {
+    if (snapshot_) {
+        throw std::logic_error("TransportCatalogue is frozen."s);
+    }
+}
+
+std::vector<std::reference_wrapper<const Domain::Stop>> TransportCatalogue::GetLiveStops() const {
+    std::vector<std::reference_wrapper<const Domain::Stop>> stops;
+    stops.reserve(stop_name_catalog_.size());
+    for (const Domain::Stop& stop : stop_catalog_) {
+        if (!IsRemoved(&stop)) { stops.emplace_back(stop); }
+    }
+    return stops;
+}
+
+void TransportCatalogue::ResetNameLookup() {
+    stop_name_lookup_.reset();
+    bus_name_lookup_.reset();
+}
+
 //Получаю дистанцию из каталога, если нужно считаю
 double TransportCatalogue::GetCalculatedDistance(Domain::TrackSection track_section) const {
     if (track_section.first == track_section.second) { return 0.; }
-    else if (calculated_distance_catalog_.count(track_section)) {
-        return calculated_distance_catalog_[track_section];
+    else if (auto it = calculated_distance_catalog_.find(track_section); it != calculated_distance_catalog_.end()) {
+        return it->second;
+    }
+    //Замороженный каталог не меняет кэш, иначе чтение из нескольких потоков небезопасно
+    else if (snapshot_ && track_section.first->is_fill && track_section.second->is_fill) {
+        return Domain::geo::ComputeSphereDistance(track_section.first->unit_vector, track_section.second->unit_vector);
     }
     else if (track_section.first->is_fill && track_section.second->is_fill) {
         AddCalculatedDistanceToCatalog(track_section);
@@ -214,13 +527,44 @@ double TransportCatalogue::GetCalculatedDistance(const Domain::Stop* left,
 
 //Считаю и добавляю дистанцию в каталог
 void TransportCatalogue::AddCalculatedDistanceToCatalog(Domain::TrackSection track_section) const {
-    double distance = Domain::geo::ComputeDistance({track_section.first->latitude, track_section.first->longitude},
-                                           {track_section.second->latitude, track_section.second->longitude});
+    double distance = Domain::geo::ComputeSphereDistance(track_section.first->unit_vector, track_section.second->unit_vector);
     calculated_distance_catalog_[track_section] = distance;
     std::swap(track_section.first, track_section.second);
     calculated_distance_catalog_[track_section] = distance;
 }
 
+//Считаю расстояния всех отрезков маршрута пакетом по точкам на единичной сфере
+template<typename StopRange>
+std::vector<double> TransportCatalogue::ComputeRouteCalculatedDistances(const StopRange& route) const {
+    if (route.size() < 2) { return {}; }
+    std::vector<Domain::geo::UnitVector> points;
+    points.reserve(route.size());
+    for (const Domain::Stop* stop : route) {
+        points.push_back(stop->unit_vector);
+    }
+    std::vector<double> distances(route.size() - 1);
+    Domain::geo::ComputeSphereDistances(points.data(), points.data() + 1, distances.data(), distances.size());
+    for (size_t i = 0; i < distances.size(); ++i) {
+        if (!route[i]->is_fill || !route[i + 1]->is_fill || route[i] == route[i + 1]) {
+            distances[i] = 0.;
+        }
+    }
+    return distances;
+}
+
+template<typename StopRange>
+double TransportCatalogue::ComputeRouteRealLength(const StopRange& route) const {
+    //Посчитанные расстояния всего маршрута одним проходом, реальные подставляются поверх
+    std::vector<double> distances = ComputeRouteCalculatedDistances(route);
+    for (size_t i = 0; i < distances.size(); ++i) {
+        std::optional<double> distance_opt = GetRealDistance({route[i], route[i + 1]});
+        if (distance_opt.has_value()) {
+            distances[i] = distance_opt.value();
+        }
+    }
+    return std::accumulate(distances.begin(), distances.end(), 0.);
+}
+
 std::optional<double> TransportCatalogue::GetRealDistance(Domain::TrackSection track_section) const {
     if (real_distance_catalog_.count(track_section)) {
         return real_distance_catalog_.at(track_section);
@@ -247,8 +591,10 @@ void TransportCatalogue::EraseBusInStopBusesCatalog(const Domain::Bus* bus) {
     if (bus->route.empty()) { return; }
     std::for_each(bus->route.begin(), std::prev(bus->route.end()),
             [this, bus](const Domain::Stop* stop) {
-                if (stop_buses_catalog_.count(stop)) {
-                    stop_buses_catalog_.at(stop).erase(bus);
+                if (auto it = stop_buses_catalog_.find(stop); it != stop_buses_catalog_.end()) {
+                    it->second.erase(bus);
+                    //Пустые записи не храню, иначе удаленные маршруты оставляют следы в каталоге остановок
+                    if (it->second.empty()) { stop_buses_catalog_.erase(it); }
                 }
             });
 }
@@ -262,33 +608,233 @@ std::vector<const Domain::Bus*> TransportCatalogue::GetBusesByStop(
 }
 //endregion
 
+//region TransportCatalogueBuilder
+
+TransportCatalogueBuilder::TransportCatalogueBuilder(TransportCatalogue& catalogue) : catalogue_(catalogue) {}
+
+TransportCatalogueBuilder& TransportCatalogueBuilder::Reserve(size_t stop_count, size_t bus_count,
+        size_t distance_count) {
+    CheckNotFinished();
+    catalogue_.stop_name_catalog_.reserve(catalogue_.stop_name_catalog_.size() + stop_count);
+    catalogue_.stop_buses_catalog_.reserve(catalogue_.stop_buses_catalog_.size() + stop_count);
+    catalogue_.bus_name_catalog_.reserve(catalogue_.bus_name_catalog_.size() + bus_count);
+    catalogue_.real_distance_catalog_.reserve(catalogue_.real_distance_catalog_.size() + distance_count);
+    bus_records_.reserve(bus_count);
+    bus_record_index_.reserve(bus_count);
+    distance_records_.reserve(distance_count);
+    return *this;
+}
+
+Domain::Stop* TransportCatalogueBuilder::AddStop(std::string_view name, double latitude, double longitude) {
+    CheckNotFinished();
+    return catalogue_.InsertStop(name, latitude, longitude);
+}
+
+Domain::Stop* TransportCatalogueBuilder::AddStop(std::string_view name) {
+    CheckNotFinished();
+    return catalogue_.InsertStop(name);
+}
+
+TransportCatalogueBuilder& TransportCatalogueBuilder::AddRealDistance(const Domain::Stop* from,
+        const Domain::Stop* to, double distance) {
+    CheckNotFinished();
+    distance_records_.push_back({{from, to}, distance});
+    return *this;
+}
+
+TransportCatalogueBuilder& TransportCatalogueBuilder::AddBus(std::string name, std::vector<const Domain::Stop*> stops,
+        bool is_roundtrip) {
+    CheckNotFinished();
+    //Повторное описание маршрута в пакете заменяет предыдущее, как и при InsertBus
+    if (auto it = bus_record_index_.find(name); it != bus_record_index_.end()) {
+        BusRecord& record = bus_records_[it->second];
+        record.stops = std::move(stops);
+        record.is_roundtrip = is_roundtrip;
+        return *this;
+    }
+    bus_records_.push_back({std::move(name), std::move(stops), is_roundtrip});
+    bus_record_index_.emplace(bus_records_.back().name, bus_records_.size() - 1);
+    return *this;
+}
+
+void TransportCatalogueBuilder::Finish() {
+    CheckNotFinished();
+    catalogue_.CheckNotFrozen();
+    ++catalogue_.version_;
+    is_finished_ = true;
+    bus_record_index_.clear();
+    
+    //Реальные расстояния нужны до расчета длин маршрутов
+    for (const auto& [track_section, distance] : distance_records_) {
+        catalogue_.real_distance_catalog_.insert_or_assign(track_section, distance);
+    }
+    distance_records_.clear();
+    
+    //Маршруты складываются в общее хранилище последовательно, обратное направление не хранится
+    std::vector<Domain::Route> routes;
+    routes.reserve(bus_records_.size());
+    for (const BusRecord& record : bus_records_) {
+        routes.push_back(record.is_roundtrip ? Domain::RoutePool::Intern(*catalogue_.route_pool_, record.stops)
+                                             : Domain::RoutePool::InternMirrored(*catalogue_.route_pool_, record.stops));
+    }
+    
+    //Маршруты независимы: считаю длины и уникальные остановки параллельно.
+    //Каталог и хранилище маршрутов в это время только читаются, расчет длин не пишет в кэш расстояний
+    std::vector<std::optional<Domain::Bus>> buses(bus_records_.size());
+    ForEachParallel(bus_records_.size(), [this, &buses, &routes](size_t i) {
+        BusRecord& record = bus_records_[i];
+        const Domain::Route& route = routes[i];
+        size_t number_final_stop = record.is_roundtrip ? 0 : record.stops.size();
+        double calc_dist = catalogue_.GetBusCalculateLength(route);
+        double real_dist = catalogue_.GetBusRealLength(route);
+        buses[i].emplace(std::move(record.name), route, number_final_stop, calc_dist, real_dist);
+    });
+    
+    //Добавляю в каталог в порядке поступления, результат не зависит от количества потоков
+    std::vector<const Domain::Bus*> new_buses;
+    new_buses.reserve(bus_records_.size());
+    for (std::optional<Domain::Bus>& bus_opt : buses) {
+        Domain::Bus& bus = *bus_opt;
+        if (catalogue_.bus_name_catalog_.count(bus.name)) {
+            //Маршрут уже был в каталоге до пакета, индексы обновляются по одному
+            catalogue_.InsertBus(std::move(bus));
+            continue;
+        }
+        catalogue_.ResetNameLookup();
+        Domain::Bus* bus_ptr = &catalogue_.bus_catalog_.emplace_back(std::move(bus));
+        catalogue_.bus_name_catalog_.emplace(bus_ptr->name, bus_ptr);
+        new_buses.push_back(bus_ptr);
+    }
+    bus_records_.clear();
+    
+    BuildStopBusesCatalog(new_buses);
+}
+
+TransportCatalogueBuilder& TransportCatalogueBuilder::SetThreadCount(size_t thread_count) {
+    thread_count_ = std::max<size_t>(thread_count, 1);
+    return *this;
+}
+
+template<typename Function>
+void TransportCatalogueBuilder::ForEachParallel(size_t count, Function function) const {
+    //Мелкие пакеты дешевле посчитать в текущем потоке, чем создавать потоки
+    static const size_t MIN_ITEMS_PER_THREAD = 64;
+    size_t thread_count = std::min(thread_count_, std::max<size_t>(count / MIN_ITEMS_PER_THREAD, 1));
+    if (thread_count <= 1) {
+        for (size_t i = 0; i < count; ++i) {
+            function(i);
+        }
+        return;
+    }
+    
+    std::vector<std::exception_ptr> exceptions(thread_count);
+    std::vector<std::thread> threads;
+    threads.reserve(thread_count - 1);
+    auto run_chunk = [&](size_t thread_index) {
+        size_t begin = count * thread_index / thread_count;
+        size_t end = count * (thread_index + 1) / thread_count;
+        try {
+            for (size_t i = begin; i < end; ++i) {
+                function(i);
+            }
+        } catch (...) {
+            exceptions[thread_index] = std::current_exception();
+        }
+    };
+    for (size_t thread_index = 1; thread_index < thread_count; ++thread_index) {
+        threads.emplace_back(run_chunk, thread_index);
+    }
+    run_chunk(0);
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    for (const std::exception_ptr& exception : exceptions) {
+        if (exception) {
+            std::rethrow_exception(exception);
+        }
+    }
+}
+
+void TransportCatalogueBuilder::CheckNotFinished() const {
+    if (is_finished_) {
+        throw std::logic_error("TransportCatalogueBuilder is already finished."s);
+    }
+}
+
+//Строю каталог маршрутов по остановкам сортировкой пар (остановка, маршрут) вместо вставки по одной
+void TransportCatalogueBuilder::BuildStopBusesCatalog(const std::vector<const Domain::Bus*>& buses) {
+    std::vector<std::pair<const Domain::Stop*, const Domain::Bus*>> stop_bus_pairs;
+    size_t pairs_count = 0;
+    for (const Domain::Bus* bus : buses) {
+        pairs_count += bus->route.empty() ? 0 : bus->route.size() - 1;
+    }
+    stop_bus_pairs.reserve(pairs_count);
+    for (const Domain::Bus* bus : buses) {
+        if (bus->route.empty()) { continue; }
+        std::for_each(bus->route.begin(), std::prev(bus->route.end()), [&stop_bus_pairs, bus](const Domain::Stop* stop) {
+            stop_bus_pairs.emplace_back(stop, bus);
+        });
+    }
+    std::sort(stop_bus_pairs.begin(), stop_bus_pairs.end());
+    stop_bus_pairs.erase(std::unique(stop_bus_pairs.begin(), stop_bus_pairs.end()), stop_bus_pairs.end());
+    
+    for (auto it = stop_bus_pairs.begin(); it != stop_bus_pairs.end();) {
+        auto it_end = std::find_if(it, stop_bus_pairs.end(), [stop = it->first](const auto& stop_bus) {
+            return stop_bus.first != stop;
+        });
+        auto& stop_buses = catalogue_.stop_buses_catalog_[it->first];
+        stop_buses.reserve(stop_buses.size() + std::distance(it, it_end));
+        for (; it != it_end; ++it) {
+            stop_buses.insert(it->second);
+        }
+    }
+}
+
+//endregion
+
 SerializerTransportCatalogue::SerializerTransportCatalogue(TransportCatalogue& catalogue) : catalogue_(catalogue) {}
 
-std::deque<Domain::Bus>& SerializerTransportCatalogue::GetBusCatalog() {
+void SerializerTransportCatalogue::MarkChanged() {
+    ++catalogue_.version_;
+}
+
+std::pmr::deque<Domain::Bus>& SerializerTransportCatalogue::GetBusCatalog() {
     return catalogue_.bus_catalog_;
 }
 
-std::deque<Domain::Stop>& SerializerTransportCatalogue::GetStopCatalog() {
+std::pmr::deque<Domain::Stop>& SerializerTransportCatalogue::GetStopCatalog() {
     return catalogue_.stop_catalog_;
 }
 
-std::unordered_map<std::string_view, Domain::Stop*>& SerializerTransportCatalogue::GetStopNameCatalog() {
+std::pmr::unordered_map<std::string_view, Domain::Stop*>& SerializerTransportCatalogue::GetStopNameCatalog() {
     return catalogue_.stop_name_catalog_;
 }
 
-std::unordered_map<Domain::TrackSection, double, Domain::TrackSectionHasher>& SerializerTransportCatalogue::GetCalculatedDistanceCatalog() {
+std::pmr::unordered_map<Domain::TrackSection, double, Domain::TrackSectionHasher>& SerializerTransportCatalogue::GetCalculatedDistanceCatalog() {
     return catalogue_.calculated_distance_catalog_;
 }
 
-std::unordered_map<Domain::TrackSection, double, Domain::TrackSectionHasher>& SerializerTransportCatalogue::GetRealDistanceCatalog() {
+std::pmr::unordered_map<Domain::TrackSection, double, Domain::TrackSectionHasher>& SerializerTransportCatalogue::GetRealDistanceCatalog() {
     return catalogue_.real_distance_catalog_;
 }
 
-std::unordered_map<std::string_view, Domain::Bus*>& SerializerTransportCatalogue::GetBusNameCatalog() {
+std::pmr::unordered_map<std::string_view, Domain::Bus*>& SerializerTransportCatalogue::GetBusNameCatalog() {
     return catalogue_.bus_name_catalog_;
 }
 
-std::unordered_map<const Domain::Stop*, std::unordered_set<const Domain::Bus*>>& SerializerTransportCatalogue::GetStopBusesCatalog() {
+Domain::RoutePool& SerializerTransportCatalogue::GetRoutePool() {
+    return *catalogue_.route_pool_;
+}
+
+std::optional<NamePerfectHash>& SerializerTransportCatalogue::GetStopNameLookup() {
+    return catalogue_.stop_name_lookup_;
+}
+
+std::optional<NamePerfectHash>& SerializerTransportCatalogue::GetBusNameLookup() {
+    return catalogue_.bus_name_lookup_;
+}
+
+std::pmr::unordered_map<const Domain::Stop*, std::pmr::unordered_set<const Domain::Bus*>>& SerializerTransportCatalogue::GetStopBusesCatalog() {
     return catalogue_.stop_buses_catalog_;
 }
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <utility>
 #include <vector>
@@ -8,8 +9,15 @@
 #include <unordered_set>
 #include <functional>
 #include <optional>
+#include <memory>
+#include <memory_resource>
+#include <thread>
+#include <algorithm>
 #include "../domain/domain.h"
+#include "../domain/geo.h"
 #include "transport_router.h"
+#include "catalogue_snapshot.h"
+#include "name_perfect_hash.h"
 
 namespace TransportGuide::BusinessLogic {
 
@@ -17,12 +25,47 @@ class TransportRouter;
 
 class TransportCatalogue {
     friend struct SerializerTransportCatalogue;
+    friend class TransportCatalogueBuilder;
 public:
-    TransportCatalogue() = default;
+    /**Все контейнеры каталога, хранилище маршрутов и маршрутизатор выделяют память из resource.
+     * Ресурс должен жить дольше каталога. Каталог обращается к ресурсу из одного потока,
+     * параллельный расчет маршрутов при загрузке память из него не выделяет*/
+    explicit TransportCatalogue(std::pmr::memory_resource* resource);
+    /**Каталог на ресурсе памяти по умолчанию*/
+    TransportCatalogue();
     /**Вставить маршрут, если маршрут с таким именем есть, то обновить данные*/
     Domain::Bus* InsertBus(const Domain::Bus& bus);
+    /**Вставить маршрут без копирования имени и списка остановок, если маршрут с таким именем есть, то обновить данные*/
+    Domain::Bus* InsertBus(Domain::Bus&& bus);
     /**Вставить остановку, если остановка с таким именем есть, то обновить данные*/
     Domain::Stop* InsertStop(const Domain::Stop& stop);
+    /**Вставить остановку с координатами, если остановка с таким именем есть, то обновить координаты.
+     * Имя копируется в каталог только для новой остановки*/
+    Domain::Stop* InsertStop(std::string_view name, double latitude, double longitude);
+    /**Получить остановку по имени, если остановки нет, добавить незаполненную остановку.
+     * Имя копируется в каталог только для новой остановки*/
+    Domain::Stop* InsertStop(std::string_view name);
+    /**Удалить маршрут из каталога. Маршрут остается в хранилище до Compact(), но недоступен по имени
+     * и не учитывается в остановках. Если маршрута нет, возвращается false*/
+    bool RemoveBus(std::string_view name);
+    /**Удалить остановку из каталога. Остановка остается в хранилище до Compact().
+     * Если через остановку проходит маршрут, выбрасывается std::logic_error. Если остановки нет, возвращается false*/
+    bool RemoveStop(std::string_view name);
+    /**Маршрут удален и ждет уплотнения хранилища*/
+    bool IsRemoved(const Domain::Bus* bus) const;
+    /**Остановка удалена и ждет уплотнения хранилища*/
+    bool IsRemoved(const Domain::Stop* stop) const;
+    /**Количество удаленных маршрутов и остановок, которые еще занимают место в хранилище*/
+    size_t GetRemovedCount() const;
+    /**Уплотнить хранилище: убрать удаленные маршруты и остановки, очистить от них таблицы расстояний.
+     * Указатели на оставшиеся объекты меняются, маршрутизатор сбрасывается и строится заново через
+     * ConstructUserRouteManager()*/
+    void Compact();
+    /**Построить совершенные хеш-таблицы имен остановок и маршрутов для FindStop/FindBus.
+     * Таблицы сбрасываются при добавлении и удалении остановок и маршрутов, каталог должен быть уплотнен*/
+    void BuildNameLookup();
+    
+    bool HasNameLookup() const;
     /**Найти маршрут по имени, если маршрута нет, возвращается nullopt*/
     std::optional<const Domain::Bus*> FindBus(std::string_view name) const;
     /**Найти остановку по имени, если остановки нет, возвращается nullopt*/
@@ -35,6 +78,14 @@ public:
     std::optional<Domain::StopInfo> GetStopInfo(const Domain::Stop* stop) const;
     /**Получить информацию об остановке, по имени остановки*/
     std::optional<Domain::StopInfo> GetStopInfo(std::string_view stop_name) const;
+    /**Получить не более count ближайших к точке остановок, по возрастанию расстояния.
+     * В замороженном каталоге используется пространственный индекс, иначе перебор*/
+    std::vector<Domain::StopDistance> GetNearestStops(Domain::geo::Coordinates point, size_t count) const;
+    /**Получить остановки не дальше radius метров от точки, по возрастанию расстояния*/
+    std::vector<Domain::StopDistance> GetStopsInRadius(Domain::geo::Coordinates point, double radius) const;
+    /**Найти остановки и маршруты по началу имени, при fuzzy дополнить похожими именами.
+     * В замороженном каталоге индекс построен заранее, иначе строится на каждый вызов*/
+    std::vector<Domain::SearchMatch> SearchNames(std::string_view query, size_t limit, bool fuzzy = false) const;
     /**Добавить в каталог реальное расстояние между остановками*/
     void AddRealDistanceToCatalog(Domain::TrackSection track_section, double distance);
     /**Добавить в каталог реальное расстояние между остановками*/
@@ -46,35 +97,75 @@ public:
     
     /**Получить посчитанное расстояние между списком остановок*/
     double GetBusCalculateLength(const std::vector<const Domain::Stop*>& route) const;
+    /**Получить посчитанное расстояние маршрута с учетом обратного направления*/
+    double GetBusCalculateLength(const Domain::Route& route) const;
     /**Получить реальное расстояние между списком остановок, если реального расстояния нет, вместо него используется посчитанное*/
     double GetBusRealLength(const std::vector<const Domain::Stop*>& route) const;
+    /**Получить реальное расстояние маршрута с учетом обратного направления*/
+    double GetBusRealLength(const Domain::Route& route) const;
     /**Получить словарь маршрутов, с ключом по имени*/
-    const std::unordered_map<std::string_view, Domain::Bus*>& GetBusNameCatalog() const;
+    const std::pmr::unordered_map<std::string_view, Domain::Bus*>& GetBusNameCatalog() const;
     /**Получить словарь остановок, с ключом по имени*/
-    const std::unordered_map<std::string_view, Domain::Stop*>& GetStopNameCatalog() const;
-
-    const std::deque<Domain::Stop>& GetStops() const;
+    const std::pmr::unordered_map<std::string_view, Domain::Stop*>& GetStopNameCatalog() const;
 
-    const std::deque<Domain::Bus>& GetBuses() const;
+    /**Хранилище остановок, до Compact() содержит удаленные остановки, проверяются через IsRemoved()*/
+    const std::pmr::deque<Domain::Stop>& GetStops() const;
+    /**Хранилище маршрутов, до Compact() содержит удаленные маршруты, проверяются через IsRemoved()*/
+    const std::pmr::deque<Domain::Bus>& GetBuses() const;
     
     void ConstructUserRouteManager(Domain::RoutingSettings routing_settings);
     
+    bool HasUserRouteManager() const;
+    
+    std::pmr::memory_resource* GetMemoryResource() const;
+    
     const TransportRouter& GetUserRouteManager() const;
+    
+    /**Заморозить каталог: построить неизменяемый снимок для чтения.
+     * После заморозки все методы чтения работают по снимку без изменения состояния и могут вызываться из любого потока,
+     * методы изменения каталога выбрасывают исключение*/
+    void Freeze();
+    
+    bool IsFrozen() const;
+    /**Получить снимок каталога, если каталог не заморожен, возвращается nullptr*/
+    std::shared_ptr<const TransportCatalogueSnapshot> GetSnapshot() const;
+    /**Номер версии данных каталога, меняется при каждом изменении остановок, маршрутов и расстояний.
+     * По нему производные данные, например отрисованная карта, проверяют, что они не устарели*/
+    uint64_t GetVersion() const;
 
 private:
-    std::deque<Domain::Bus> bus_catalog_;
-    std::deque<Domain::Stop> stop_catalog_;
-    std::unordered_map<std::string_view, Domain::Stop*> stop_name_catalog_;
-    mutable std::unordered_map<Domain::TrackSection, double, Domain::TrackSectionHasher> calculated_distance_catalog_;
-    std::unordered_map<Domain::TrackSection, double, Domain::TrackSectionHasher> real_distance_catalog_;
-    std::unordered_map<std::string_view, Domain::Bus*> bus_name_catalog_;
-    std::unordered_map<const Domain::Stop*, std::unordered_set<const Domain::Bus*>> stop_buses_catalog_;
+    std::pmr::memory_resource* resource_;
+    std::pmr::deque<Domain::Bus> bus_catalog_;
+    std::pmr::deque<Domain::Stop> stop_catalog_;
+    std::pmr::unordered_map<std::string_view, Domain::Stop*> stop_name_catalog_;
+    mutable std::pmr::unordered_map<Domain::TrackSection, double, Domain::TrackSectionHasher> calculated_distance_catalog_;
+    std::pmr::unordered_map<Domain::TrackSection, double, Domain::TrackSectionHasher> real_distance_catalog_;
+    std::pmr::unordered_map<std::string_view, Domain::Bus*> bus_name_catalog_;
+    std::pmr::unordered_map<const Domain::Stop*, std::pmr::unordered_set<const Domain::Bus*>> stop_buses_catalog_;
     std::optional<TransportRouter> user_route_manager_;
+    std::shared_ptr<const TransportCatalogueSnapshot> snapshot_;
+    //Общее хранилище маршрутов всех автобусов каталога
+    //Хранилище в куче: маршруты ссылаются на него по адресу, Compact подменяет его целиком
+    std::unique_ptr<Domain::RoutePool> route_pool_;
+    //Удаленные объекты остаются в деках до Compact(), в словарях по имени их уже нет
+    size_t removed_buses_count_ = 0;
+    size_t removed_stops_count_ = 0;
+    //Совершенные хеш-таблицы имен, id - позиция в деке
+    std::optional<NamePerfectHash> stop_name_lookup_;
+    std::optional<NamePerfectHash> bus_name_lookup_;
+    uint64_t version_ = 0;
     
 private:
+    void CheckNotFrozen() const;
+    void ResetNameLookup();
+    std::vector<std::reference_wrapper<const Domain::Stop>> GetLiveStops() const;
     double GetCalculatedDistance(Domain::TrackSection track_section) const;
     double GetCalculatedDistance(const Domain::Stop* left, const Domain::Stop* right) const;
     void AddCalculatedDistanceToCatalog(Domain::TrackSection track_section) const;
+    template<typename StopRange>
+    std::vector<double> ComputeRouteCalculatedDistances(const StopRange& route) const;
+    template<typename StopRange>
+    double ComputeRouteRealLength(const StopRange& route) const;
     std::optional<double> GetRealDistance(Domain::TrackSection track_section) const;
     std::optional<double> GetRealDistance(const Domain::Stop* left, const Domain::Stop* right) const;
     
@@ -96,18 +187,75 @@ private:
     
 };
 
+/**Пакетная загрузка каталога.
+ * Резервирует контейнеры по заранее известному количеству записей, накапливает сырые записи расстояний и маршрутов
+ * и строит вторичные индексы (длины маршрутов, каталог маршрутов по остановкам) один раз в Finish()*/
+class TransportCatalogueBuilder final {
+public:
+    explicit TransportCatalogueBuilder(TransportCatalogue& catalogue);
+    ~TransportCatalogueBuilder() = default;
+    
+    /**Зарезервировать место под ожидаемое количество остановок, маршрутов и реальных расстояний*/
+    TransportCatalogueBuilder& Reserve(size_t stop_count, size_t bus_count, size_t distance_count = 0);
+    /**Добавить остановку с координатами, остановка сразу доступна в каталоге*/
+    Domain::Stop* AddStop(std::string_view name, double latitude, double longitude);
+    /**Получить остановку по имени, если остановки нет, добавить незаполненную остановку*/
+    Domain::Stop* AddStop(std::string_view name);
+    /**Добавить реальное расстояние между остановками, попадет в каталог в Finish()*/
+    TransportCatalogueBuilder& AddRealDistance(const Domain::Stop* from, const Domain::Stop* to, double distance);
+    /**Добавить маршрут по списку остановок в прямом направлении, маршрут попадет в каталог в Finish().
+     * Если маршрут не кольцевой, обратное направление достраивается автоматически*/
+    TransportCatalogueBuilder& AddBus(std::string name, std::vector<const Domain::Stop*> stops, bool is_roundtrip);
+    /**Количество потоков для расчета маршрутов в Finish(), по умолчанию по числу ядер*/
+    TransportCatalogueBuilder& SetThreadCount(size_t thread_count);
+    /**Перенести накопленные записи в каталог и построить индексы.
+     * Длины маршрутов считаются параллельно, маршруты добавляются в порядке поступления*/
+    void Finish();
+
+private:
+    struct BusRecord {
+        std::string name;
+        std::vector<const Domain::Stop*> stops;
+        bool is_roundtrip;
+    };
+    
+    struct DistanceRecord {
+        Domain::TrackSection track_section;
+        double distance;
+    };
+    
+    TransportCatalogue& catalogue_;
+    std::vector<DistanceRecord> distance_records_;
+    std::vector<BusRecord> bus_records_;
+    //Ключи - копии имен: при росте bus_records_ записи переезжают, и короткие имена меняют адрес
+    std::unordered_map<std::string, size_t> bus_record_index_;
+    bool is_finished_ = false;
+    size_t thread_count_ = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    
+    void CheckNotFinished() const;
+    template<typename Function>
+    void ForEachParallel(size_t count, Function function) const;
+    void BuildStopBusesCatalog(const std::vector<const Domain::Bus*>& buses);
+};
+
 struct SerializerTransportCatalogue final {
 public:
     explicit SerializerTransportCatalogue(BusinessLogic::TransportCatalogue& catalogue);
     ~SerializerTransportCatalogue() = default;
     
-    std::deque<Domain::Bus>& GetBusCatalog();
-    std::deque<Domain::Stop>& GetStopCatalog();
-    std::unordered_map<std::string_view, Domain::Stop*>& GetStopNameCatalog();
-    std::unordered_map<Domain::TrackSection, double, Domain::TrackSectionHasher>& GetCalculatedDistanceCatalog();
-    std::unordered_map<Domain::TrackSection, double, Domain::TrackSectionHasher>& GetRealDistanceCatalog();
-    std::unordered_map<std::string_view, Domain::Bus*>& GetBusNameCatalog();
-    std::unordered_map<const Domain::Stop*, std::unordered_set<const Domain::Bus*>>& GetStopBusesCatalog();
+    /**Отметить, что данные каталога изменены через сериализатор, например восстановлены из базы.
+     * Чтение и подсчет памяти версию не меняют*/
+    void MarkChanged();
+    std::pmr::deque<Domain::Bus>& GetBusCatalog();
+    std::pmr::deque<Domain::Stop>& GetStopCatalog();
+    std::pmr::unordered_map<std::string_view, Domain::Stop*>& GetStopNameCatalog();
+    std::pmr::unordered_map<Domain::TrackSection, double, Domain::TrackSectionHasher>& GetCalculatedDistanceCatalog();
+    std::pmr::unordered_map<Domain::TrackSection, double, Domain::TrackSectionHasher>& GetRealDistanceCatalog();
+    std::pmr::unordered_map<std::string_view, Domain::Bus*>& GetBusNameCatalog();
+    std::pmr::unordered_map<const Domain::Stop*, std::pmr::unordered_set<const Domain::Bus*>>& GetStopBusesCatalog();
+    Domain::RoutePool& GetRoutePool();
+    std::optional<NamePerfectHash>& GetStopNameLookup();
+    std::optional<NamePerfectHash>& GetBusNameLookup();
     std::optional<TransportRouter>& GetUserRouteManager();
     BusinessLogic::TransportCatalogue& GetCatalogue();
 private:
@@ -8,7 +8,8 @@ namespace TransportGuide::BusinessLogic {
 using namespace std::literals;
 
 TransportRouter::TransportRouter(const TransportCatalogue& catalogue,
-        Domain::RoutingSettings routing_settings) : catalogue_(catalogue), routing_settings_(routing_settings) {
+        Domain::RoutingSettings routing_settings) : TransportRouter(catalogue) {
+    routing_settings_ = routing_settings;
     ConstructRouter();
 }
 
@@ -79,7 +80,7 @@ std::optional<Domain::UserRouteInfo> TransportRouter::GetUserRouteInfo(std::stri
 
 void TransportRouter::InitGraph() {
     size_t vertex_count = catalogue_.GetStops().size() * 2;
-    graph_ = graph::DirectedWeightedGraph<Domain::TimeMinuts>(vertex_count);
+    graph_ = graph::DirectedWeightedGraph<Domain::TimeMinuts>(vertex_count, catalogue_.GetMemoryResource());
     
     for (size_t i = 0; i < vertex_count; i+=2) {
         
@@ -95,6 +96,8 @@ void TransportRouter::AddBusesToGraph() {
     static const double METERS_PER_KMETERS = 1000.;
     
     for (const Domain::Bus& bus : catalogue_.GetBuses()) {
+        //Удаленный маршрут ждет уплотнения каталога, по нему не ездят
+        if (catalogue_.GetRemovedCount() && catalogue_.IsRemoved(&bus)) { continue; }
         std::vector<std::pair<graph::VertexId, Domain::TimeMinuts>> traveled_stops;
         for (auto it = bus.route.begin(), it_end = std::prev(bus.route.end()); it != it_end; std::advance(it, 1)) {
             auto it_next = std::next(it);
@@ -127,7 +130,10 @@ Domain::RoutingSettings TransportRouter::GetRoutingSettings() const {
 }
 
 
-TransportRouter::TransportRouter (const TransportCatalogue& catalogue) : catalogue_(catalogue) {}
+TransportRouter::TransportRouter (const TransportCatalogue& catalogue) : catalogue_(catalogue),
+        graph_(catalogue.GetMemoryResource()),
+        graph_stop_to_vertex_id_catalog_(catalogue.GetMemoryResource()),
+        graph_edge_id_to_info_catalog_(catalogue.GetMemoryResource()) {}
 
 SerializerTransportRouter::SerializerTransportRouter(TransportRouter& transport_router) : transport_router_(transport_router) {}
 
@@ -152,11 +158,11 @@ graph::DirectedWeightedGraph<Domain::TimeMinuts>& SerializerTransportRouter::Get
     return transport_router_.graph_;
 }
 
-std::unordered_map<const Domain::Stop*, graph::VertexId>& SerializerTransportRouter::GetGraphStopToVertexIdCatalog() {
+std::pmr::unordered_map<const Domain::Stop*, graph::VertexId>& SerializerTransportRouter::GetGraphStopToVertexIdCatalog() {
     return transport_router_.graph_stop_to_vertex_id_catalog_;
 }
 
-std::unordered_map<graph::EdgeId, Domain::TrackSectionInfo>& SerializerTransportRouter::GetGraphEdgeIdToInfoCatalog() {
+std::pmr::unordered_map<graph::EdgeId, Domain::TrackSectionInfo>& SerializerTransportRouter::GetGraphEdgeIdToInfoCatalog() {
     return transport_router_.graph_edge_id_to_info_catalog_;
 }
 
@@ -8,6 +8,7 @@
 #include <unordered_set>
 #include <functional>
 #include <optional>
+#include <memory_resource>
 #include "../domain/domain.h"
 #include "../external/graph.h"
 #include "../external/router.h"
@@ -16,6 +17,7 @@ namespace TransportGuide::BusinessLogic {
 
 class TransportCatalogue;
 
+/**Граф и таблицы ребер выделяются из ресурса памяти каталога*/
 class TransportRouter {
     friend struct SerializerTransportRouter;
     
@@ -38,8 +40,8 @@ private:
     Domain::RoutingSettings routing_settings_;
     graph::DirectedWeightedGraph<Domain::TimeMinuts> graph_;
     std::optional<graph::Router<Domain::TimeMinuts>> router_;
-    std::unordered_map<const Domain::Stop*, graph::VertexId> graph_stop_to_vertex_id_catalog_;
-    std::unordered_map<graph::EdgeId, Domain::TrackSectionInfo> graph_edge_id_to_info_catalog_;
+    std::pmr::unordered_map<const Domain::Stop*, graph::VertexId> graph_stop_to_vertex_id_catalog_;
+    std::pmr::unordered_map<graph::EdgeId, Domain::TrackSectionInfo> graph_edge_id_to_info_catalog_;
 
 private:
     explicit TransportRouter(const TransportCatalogue& catalogue);
@@ -60,8 +62,8 @@ struct SerializerTransportRouter final {
     Domain::RoutingSettings& GetRoutingSettings();
     std::optional<graph::Router<Domain::TimeMinuts>>& GetRouter();
     graph::DirectedWeightedGraph<Domain::TimeMinuts>& GetGraph();
-    std::unordered_map<const Domain::Stop*, graph::VertexId>& GetGraphStopToVertexIdCatalog();
-    std::unordered_map<graph::EdgeId, Domain::TrackSectionInfo>& GetGraphEdgeIdToInfoCatalog();
+    std::pmr::unordered_map<const Domain::Stop*, graph::VertexId>& GetGraphStopToVertexIdCatalog();
+    std::pmr::unordered_map<graph::EdgeId, Domain::TrackSectionInfo>& GetGraphEdgeIdToInfoCatalog();
 
 private:
     BusinessLogic::TransportRouter& transport_router_;
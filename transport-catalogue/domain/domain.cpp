@@ -8,6 +8,15 @@
 
 namespace TransportGuide::Domain {
 
+namespace {
+
+size_t CountUniqueStops(const Route& route) {
+    std::unordered_set<const Stop*> unique_stops(route.begin(), route.end());
+    return unique_stops.size();
+}
+
+}
+
 //region geo
 
 constexpr double ACCURACY_COMPARISON = 1e-1;
@@ -31,9 +40,8 @@ bool Stop::operator!=(const Stop& rhs) const {
 
 Stop::Stop(std::string name) : name(std::move(name)) {}
 
-Stop::Stop(std::string name, double latitude, double longitude) : name(std::move(name)), latitude(latitude), longitude(
-        longitude) {
-    is_fill = true;
+Stop::Stop(std::string name, double latitude, double longitude) : name(std::move(name)) {
+    SetCoordinates(latitude, longitude);
 }
 
 Stop::Stop(const Stop& other) {
@@ -41,6 +49,7 @@ Stop::Stop(const Stop& other) {
     latitude = other.latitude;
     longitude = other.longitude;
     is_fill = other.is_fill;
+    unit_vector = other.unit_vector;
 }
 
 Stop& Stop::operator=(const Stop& other) {
@@ -50,6 +59,7 @@ Stop& Stop::operator=(const Stop& other) {
         std::swap(latitude, stop.latitude);
         std::swap(longitude, stop.longitude);
         std::swap(is_fill, stop.is_fill);
+        std::swap(unit_vector, stop.unit_vector);
     }
     return *this;
 }
@@ -59,11 +69,19 @@ bool Stop::Update(const Stop& other) {
         latitude = other.latitude;
         longitude = other.longitude;
         is_fill = other.is_fill;
+        unit_vector = other.unit_vector;
         return true;
     }
     return false;
 }
 
+void Stop::SetCoordinates(double latitude, double longitude) {
+    this->latitude = latitude;
+    this->longitude = longitude;
+    unit_vector = geo::ToUnitVector({latitude, longitude});
+    is_fill = true;
+}
+
 //endregion
 
 //region Bus
@@ -76,19 +94,23 @@ bool Bus::operator!=(const Bus& rhs) const {
     return !(rhs == *this);
 }
 
-Bus::Bus(std::string name, const std::vector<const Stop*>& route, double calc_length, double real_length) : name(
-        std::move(name)), route(route), calc_length(calc_length), real_length(real_length) {
-    std::unordered_set<const Stop*> unique_stops(route.begin(), route.end());
-    unique_stops_count = unique_stops.size();
-}
+Bus::Bus(std::string name, const std::vector<const Stop*>& route, double calc_length, double real_length) : Bus(
+        std::move(name), route, 0, calc_length, real_length) {}
 
+//Маршрут вне каталога хранится в собственном хранилище автобуса, каталог переносит его в свое при вставке
 Bus::Bus(std::string name, const std::vector<const Stop*>& route, size_t number_final_stop, double calc_length,
-        double real_length) : Bus(std::move(name), route, calc_length, real_length) {
-    number_final_stop_ = number_final_stop;
-}
+        double real_length) : name(std::move(name)), own_route_pool_(std::make_shared<RoutePool>()),
+        route(RoutePool::Intern(*own_route_pool_, route, number_final_stop)),
+        unique_stops_count(CountUniqueStops(this->route)), calc_length(calc_length), real_length(real_length),
+        number_final_stop_(number_final_stop) {}
+
+Bus::Bus(std::string name, Route route, size_t number_final_stop, double calc_length, double real_length) : name(
+        std::move(name)), route(std::move(route)), unique_stops_count(CountUniqueStops(this->route)),
+        calc_length(calc_length), real_length(real_length), number_final_stop_(number_final_stop) {}
 
 Bus::Bus(const Bus& other) {
     name = other.name;
+    own_route_pool_ = other.own_route_pool_;
     route = other.route;
     unique_stops_count = other.unique_stops_count;
     calc_length = other.calc_length;
@@ -101,6 +123,7 @@ Bus& Bus::operator=(const Bus& other) {
     if (this != &other) {
         Bus bus(other);
         std::swap(name, bus.name);
+        std::swap(own_route_pool_, bus.own_route_pool_);
         std::swap(route, bus.route);
         std::swap(unique_stops_count, bus.unique_stops_count);
         std::swap(calc_length, bus.calc_length);
@@ -112,6 +135,7 @@ Bus& Bus::operator=(const Bus& other) {
 
 bool Bus::Update(const Bus& other) {
     if (name == other.name) {
+        own_route_pool_ = other.own_route_pool_;
         route = other.route;
         unique_stops_count = other.unique_stops_count;
         calc_length = other.calc_length;
@@ -127,12 +151,12 @@ bool Bus::IsRoundtrip() const {
     return number_final_stop_ == 0;
 }
 
-std::vector<const Stop*> Bus::GetForwardRoute() const {
+Route Bus::GetForwardRoute() const {
     if (!route.empty() && IsRoundtrip()) {
-        return {route.begin(), std::prev(route.end(), 1)};
+        return route.GetPrefix(route.size() - 1);
     }
     else if (!route.empty()) {
-        return {route.begin(), std::next(route.begin(), number_final_stop_)};
+        return route.GetPrefix(number_final_stop_);
     }
     return {};
 }
@@ -164,4 +188,16 @@ bool StopInfo::operator!=(const StopInfo& rhs) const {
 
 //endregion
 
+//region StopDistance
+
+bool StopDistance::operator==(const StopDistance& rhs) const {
+    return stop == rhs.stop && std::abs(distance - rhs.distance) < ACCURACY_COMPARISON;
+}
+
+bool StopDistance::operator!=(const StopDistance& rhs) const {
+    return !(rhs == *this);
+}
+
+//endregion
+
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <memory>
 #include <utility>
 #include <vector>
 #include <deque>
@@ -9,6 +10,8 @@
 #include <functional>
 #include <optional>
 #include <variant>
+#include "geo.h"
+#include "route.h"
 
 namespace TransportGuide::Domain {
 
@@ -17,12 +20,18 @@ struct Stop {
     double latitude = 0;
     double longitude = 0;
     bool is_fill = false;
+    //Точка на единичной сфере для расчета расстояний без тригонометрии на каждый отрезок
+    geo::UnitVector unit_vector;
     explicit Stop(std::string name);
     explicit Stop(std::string name, double latitude, double longitude);
     ~Stop() = default;
     Stop(const Stop& other);
+    Stop(Stop&& other) noexcept = default;
     Stop& operator=(const Stop& other);
+    Stop& operator=(Stop&& other) noexcept = default;
     bool Update(const Stop& other);
+    /**Задать координаты, остановка становится заполненной*/
+    void SetCoordinates(double latitude, double longitude);
     bool operator==(const Stop& rhs) const;
     bool operator!=(const Stop& rhs) const;
 };
@@ -30,7 +39,11 @@ struct Stop {
 
 struct Bus {
     std::string name;
-    std::vector<const Stop*> route;
+    //Хранилище маршрута, созданного по списку остановок вне каталога, копии автобуса разделяют его.
+    //У автобусов каталога хранилища нет, их маршруты лежат в хранилище каталога
+    std::shared_ptr<RoutePool> own_route_pool_;
+    //Некольцевой маршрут хранит только прямое направление, обратное восстанавливается по number_final_stop_
+    Route route;
     size_t unique_stops_count;
     //Маршруты теперь хранят длины пути
     double calc_length;
@@ -38,12 +51,17 @@ struct Bus {
     size_t number_final_stop_ = 0;
     explicit Bus(std::string name, const std::vector<const Stop*>& route, double calc_length, double real_length);
     explicit Bus(std::string name, const std::vector<const Stop*>& route, size_t number_final_stop, double calc_length, double real_length);
+    /**Маршрут из общего хранилища каталога*/
+    explicit Bus(std::string name, Route route, size_t number_final_stop, double calc_length, double real_length);
     ~Bus() = default;
     Bus(const Bus& other);
+    Bus(Bus&& other) noexcept = default;
     Bus& operator=(const Bus& other);
+    Bus& operator=(Bus&& other) noexcept = default;
     bool Update(const Bus& other);
     bool IsRoundtrip() const;
-    std::vector<const Stop*> GetForwardRoute() const;
+    /**Прямое направление маршрута без копирования остановок*/
+    Route GetForwardRoute() const;
     bool operator==(const Bus& rhs) const;
     bool operator!=(const Bus& rhs) const;
 };
@@ -76,6 +94,14 @@ struct StopInfo {
 };
 
 
+struct StopDistance {
+    const Stop* stop;
+    double distance;
+    bool operator==(const StopDistance& rhs) const;
+    bool operator!=(const StopDistance& rhs) const;
+};
+
+
 using PixelDelta = std::pair<double, double>;
 
 struct RenderSettings {
@@ -93,9 +119,23 @@ struct RenderSettings {
     std::vector<std::string> color_palette = {"green", "rgb(255,160,0)", "red"};
 };
 
+/**Часть карты для запроса Map: прямоугольник в географических координатах и масштаб относительно всей карты*/
+struct MapViewport {
+    //Юго-западный и северо-восточный углы, пусто - вся карта
+    std::optional<std::pair<geo::Coordinates, geo::Coordinates>> bbox;
+    double zoom = 1.;
+};
+
 using TimeMinuts = double;
 using RouteEntity = std::variant<const Stop*, const Bus*>;
 
+struct SearchMatch {
+    std::string_view name;
+    RouteEntity entity;
+    //1 для совпадения по префиксу, для нечеткого поиска доля общих триграмм
+    double similarity = 1.;
+};
+
 struct RoutingSettings {
     TimeMinuts bus_wait_time = 0;
     double bus_velocity = 0;
@@ -1,7 +1,12 @@
+#include <algorithm>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 #include "geo.h"
 
 //Вынес радиус земли в константу
 static const int AVERAGE_RADIUS_EARTH = 6371000;
+static const double DEGREES_TO_RADIANS = 3.1415926535 / 180.;
 
 bool TransportGuide::Domain::geo::Coordinates::operator==(const Coordinates& other) const {
     return lat == other.lat && lng == other.lng;
@@ -11,6 +16,14 @@ bool TransportGuide::Domain::geo::Coordinates::operator!=(const Coordinates& oth
     return !(*this == other);
 }
 
+bool TransportGuide::Domain::geo::UnitVector::operator==(const UnitVector& other) const {
+    return x == other.x && y == other.y && z == other.z;
+}
+
+bool TransportGuide::Domain::geo::UnitVector::operator!=(const UnitVector& other) const {
+    return !(*this == other);
+}
+
 double TransportGuide::Domain::geo::ComputeDistance(Coordinates from, Coordinates to) {
     using namespace std;
     if (from == to) {
@@ -20,3 +33,47 @@ double TransportGuide::Domain::geo::ComputeDistance(Coordinates from, Coordinate
     return acos(sin(from.lat * dr) * sin(to.lat * dr) + cos(from.lat * dr) * cos(to.lat * dr) * cos(
             abs(from.lng - to.lng) * dr)) * AVERAGE_RADIUS_EARTH;
 }
+
+TransportGuide::Domain::geo::UnitVector TransportGuide::Domain::geo::ToUnitVector(Coordinates coordinates) {
+    double cos_lat = std::cos(coordinates.lat * DEGREES_TO_RADIANS);
+    return {cos_lat * std::cos(coordinates.lng * DEGREES_TO_RADIANS),
+            cos_lat * std::sin(coordinates.lng * DEGREES_TO_RADIANS),
+            std::sin(coordinates.lat * DEGREES_TO_RADIANS)};
+}
+
+//Совпадающие точки дают ровно 0, как и расчет по координатам, округление скалярного произведения отсекается
+static double DotToDistance(const TransportGuide::Domain::geo::UnitVector& from,
+        const TransportGuide::Domain::geo::UnitVector& to, double dot) {
+    if (from == to) {
+        return 0;
+    }
+    return std::acos(std::clamp(dot, -1., 1.)) * AVERAGE_RADIUS_EARTH;
+}
+
+double TransportGuide::Domain::geo::ComputeSphereDistance(const UnitVector& from, const UnitVector& to) {
+    return DotToDistance(from, to, from.x * to.x + from.y * to.y + from.z * to.z);
+}
+
+void TransportGuide::Domain::geo::ComputeSphereDistances(const UnitVector* from, const UnitVector* to, double* distances,
+        size_t count) {
+    size_t i = 0;
+#ifdef __SSE2__
+    //Скалярные произведения для пары отрезков за одну итерацию, acos остается скалярным
+    for (; i + 2 <= count; i += 2) {
+        __m128d from_x = _mm_set_pd(from[i + 1].x, from[i].x);
+        __m128d from_y = _mm_set_pd(from[i + 1].y, from[i].y);
+        __m128d from_z = _mm_set_pd(from[i + 1].z, from[i].z);
+        __m128d to_x = _mm_set_pd(to[i + 1].x, to[i].x);
+        __m128d to_y = _mm_set_pd(to[i + 1].y, to[i].y);
+        __m128d to_z = _mm_set_pd(to[i + 1].z, to[i].z);
+        __m128d dot = _mm_add_pd(_mm_add_pd(_mm_mul_pd(from_x, to_x), _mm_mul_pd(from_y, to_y)), _mm_mul_pd(from_z, to_z));
+        alignas(16) double dots[2];
+        _mm_store_pd(dots, dot);
+        distances[i] = DotToDistance(from[i], to[i], dots[0]);
+        distances[i + 1] = DotToDistance(from[i + 1], to[i + 1], dots[1]);
+    }
+#endif
+    for (; i < count; ++i) {
+        distances[i] = ComputeSphereDistance(from[i], to[i]);
+    }
+}
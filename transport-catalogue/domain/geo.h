@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cmath>
+#include <cstddef>
 namespace TransportGuide::Domain::geo {
 
 struct Coordinates {
@@ -12,7 +13,27 @@ struct Coordinates {
     bool operator!=(const Coordinates& other) const;
 };
 
+/**Точка на единичной сфере, sin/cos широты и долготы посчитаны один раз*/
+struct UnitVector {
+    double x = 0;
+    double y = 0;
+    double z = 0;
+    
+    bool operator==(const UnitVector& other) const;
+    
+    bool operator!=(const UnitVector& other) const;
+};
+
 
 double ComputeDistance(Coordinates from, Coordinates to);
 
+UnitVector ToUnitVector(Coordinates coordinates);
+
+/**Расстояние по заранее посчитанным точкам на единичной сфере*/
+double ComputeSphereDistance(const UnitVector& from, const UnitVector& to);
+
+/**Пакетный расчет расстояний: distances[i] = ComputeSphereDistance(from[i], to[i]).
+ * Скалярные произведения считаются по два за раз на SSE2, если он доступен*/
+void ComputeSphereDistances(const UnitVector* from, const UnitVector* to, double* distances, size_t count);
+
 }
@@ -0,0 +1,152 @@
+#include <algorithm>
+#include <functional>
+#include "route.h"
+#include "../external/memory_counter.h"
+
+namespace TransportGuide::Domain {
+
+//region RoutePool
+
+RoutePool::RoutePool(std::pmr::memory_resource* resource)
+        : stops_(resource), stop_indices_(resource), indices_(resource), spans_by_hash_(resource) {}
+
+Route RoutePool::Intern(RoutePool& pool, const std::vector<const Stop*>& stops,
+        size_t number_final_stop) {
+    //Обратное направление не хранится, только если оно действительно повторяет прямое
+    bool is_mirrored = number_final_stop > 0 && stops.size() == number_final_stop * 2 - 1
+            && std::equal(stops.begin(), std::next(stops.begin(), number_final_stop), stops.rbegin());
+    auto end = is_mirrored ? std::next(stops.begin(), number_final_stop) : stops.end();
+    Span span = pool.AddSpan(stops.begin(), end);
+    return Route(&pool, span.offset, span.count, is_mirrored);
+}
+
+Route RoutePool::InternMirrored(RoutePool& pool, const std::vector<const Stop*>& forward_stops) {
+    Span span = pool.AddSpan(forward_stops.begin(), forward_stops.end());
+    return Route(&pool, span.offset, span.count, !forward_stops.empty());
+}
+
+Route RoutePool::Intern(RoutePool& pool, const Route& route) {
+    if (route.pool_ == &pool) {
+        return route;
+    }
+    auto begin = route.begin();
+    Span span = pool.AddSpan(begin, std::next(begin, route.count_));
+    return Route(&pool, span.offset, span.count, route.is_mirrored_);
+}
+
+const Stop* RoutePool::GetStop(uint32_t index) const {
+    return stops_[index];
+}
+
+size_t RoutePool::GetIndicesCount() const {
+    return indices_.size();
+}
+
+size_t RoutePool::GetMemoryUsage() const {
+    return memory::MeasureVector(stops_) + memory::MeasureUnorderedMap(stop_indices_) + memory::MeasureVector(indices_)
+            + memory::MeasureUnorderedMap(spans_by_hash_);
+}
+
+template<typename StopIt>
+RoutePool::Span RoutePool::AddSpan(StopIt begin, StopIt end) {
+    std::vector<uint32_t> span_indices;
+    size_t count = std::distance(begin, end);
+    span_indices.reserve(count);
+    size_t hash = count;
+    for (auto it = begin; it != end; ++it) {
+        uint32_t index = GetStopIndex(*it);
+        span_indices.push_back(index);
+        hash = hash * 37 + std::hash<uint32_t>{}(index);
+    }
+
+    auto [it, it_end] = spans_by_hash_.equal_range(hash);
+    for (; it != it_end; ++it) {
+        const Span& span = it->second;
+        if (span.count == span_indices.size() && std::equal(span_indices.begin(), span_indices.end(),
+                std::next(indices_.begin(), span.offset))) {
+            return span;
+        }
+    }
+
+    Span span{static_cast<uint32_t>(indices_.size()), static_cast<uint32_t>(span_indices.size())};
+    indices_.insert(indices_.end(), span_indices.begin(), span_indices.end());
+    spans_by_hash_.emplace(hash, span);
+    return span;
+}
+
+uint32_t RoutePool::GetStopIndex(const Stop* stop) {
+    auto [it, is_inserted] = stop_indices_.emplace(stop, static_cast<uint32_t>(stops_.size()));
+    if (is_inserted) {
+        stops_.push_back(stop);
+    }
+    return it->second;
+}
+
+//endregion
+
+//region Route
+
+Route::Route(const RoutePool* pool, uint32_t offset, uint32_t count, bool is_mirrored)
+        : pool_(pool), offset_(offset), count_(count), is_mirrored_(is_mirrored) {}
+
+size_t Route::size() const {
+    if (count_ == 0) { return 0; }
+    return is_mirrored_ ? count_ * 2 - 1 : count_;
+}
+
+bool Route::empty() const {
+    return count_ == 0;
+}
+
+const Stop* Route::operator[](size_t position) const {
+    //Позиции после конечной остановки отражаются на прямое направление
+    size_t stored_position = position < count_ ? position : count_ * 2 - 2 - position;
+    return pool_->GetStop(pool_->indices_[offset_ + stored_position]);
+}
+
+const Stop* Route::front() const {
+    return (*this)[0];
+}
+
+const Stop* Route::back() const {
+    return (*this)[size() - 1];
+}
+
+Route::Iterator Route::begin() const {
+    return {this, 0};
+}
+
+Route::Iterator Route::end() const {
+    return {this, size()};
+}
+
+Route Route::GetPrefix(size_t count) const {
+    return Route(pool_, offset_, static_cast<uint32_t>(std::min<size_t>(count, count_)), false);
+}
+
+size_t Route::GetStoredCount() const {
+    return count_;
+}
+
+bool Route::IsMirrored() const {
+    return is_mirrored_;
+}
+
+const RoutePool* Route::GetPool() const {
+    return pool_;
+}
+
+bool Route::operator==(const Route& rhs) const {
+    if (pool_ == rhs.pool_ && offset_ == rhs.offset_ && count_ == rhs.count_ && is_mirrored_ == rhs.is_mirrored_) {
+        return true;
+    }
+    return size() == rhs.size() && std::equal(begin(), end(), rhs.begin());
+}
+
+bool Route::operator!=(const Route& rhs) const {
+    return !(*this == rhs);
+}
+
+//endregion
+
+}
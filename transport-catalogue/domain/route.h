@@ -0,0 +1,133 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory_resource>
+#include <unordered_map>
+#include <vector>
+
+namespace TransportGuide::Domain {
+
+struct Stop;
+class Route;
+
+/**Общее хранилище маршрутов: остановки пронумерованы uint32, маршруты лежат непрерывными отрезками индексов
+ * в одном массиве. Одинаковые последовательности остановок хранятся один раз.
+ * Хранилище только растет, поэтому отрезки, на которые ссылаются маршруты, не меняются.
+ * Добавление не потокобезопасно, чтение отрезков из нескольких потоков безопасно, пока нет добавлений.
+ * Память выделяется из переданного ресурса, по умолчанию из ресурса по умолчанию*/
+class RoutePool final {
+public:
+    explicit RoutePool(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+    RoutePool(const RoutePool&) = delete;
+    RoutePool& operator=(const RoutePool&) = delete;
+
+    /**Сохранить маршрут. Если number_final_stop не ноль и вторая половина маршрута зеркальна первой,
+     * хранится только прямое направление до конечной остановки, обратное восстанавливается при обходе*/
+    static Route Intern(RoutePool& pool, const std::vector<const Stop*>& stops,
+            size_t number_final_stop = 0);
+    /**Сохранить некольцевой маршрут по прямому направлению, обратное направление не хранится*/
+    static Route InternMirrored(RoutePool& pool, const std::vector<const Stop*>& forward_stops);
+    /**Перенести маршрут из другого хранилища, если маршрут уже в этом хранилище, он возвращается как есть*/
+    static Route Intern(RoutePool& pool, const Route& route);
+
+    const Stop* GetStop(uint32_t index) const;
+    /**Количество индексов остановок во всех отрезках*/
+    size_t GetIndicesCount() const;
+    /**Байты в куче, занятые таблицей остановок, отрезками и словарями дедупликации*/
+    size_t GetMemoryUsage() const;
+
+private:
+    struct Span {
+        uint32_t offset;
+        uint32_t count;
+    };
+
+    std::pmr::vector<const Stop*> stops_;
+    std::pmr::unordered_map<const Stop*, uint32_t> stop_indices_;
+    std::pmr::vector<uint32_t> indices_;
+    std::pmr::unordered_multimap<size_t, Span> spans_by_hash_;
+
+    friend class Route;
+
+    template<typename StopIt>
+    Span AddSpan(StopIt begin, StopIt end);
+    uint32_t GetStopIndex(const Stop* stop);
+};
+
+/**Маршрут как представление отрезка общего хранилища.
+ * Для некольцевого маршрута хранится только прямое направление, обход идет до конечной и обратно.
+ * Копирование не выделяет память, копии ссылаются на тот же отрезок. Хранилищем маршрут не владеет
+ * и живет не дольше его*/
+class Route final {
+public:
+    class Iterator {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = const Stop*;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Stop* const*;
+        using reference = const Stop*;
+
+        Iterator() = default;
+        Iterator(const Route* route, size_t position) : route_(route), position_(position) {}
+
+        reference operator*() const { return (*route_)[position_]; }
+        reference operator[](difference_type n) const { return (*route_)[position_ + n]; }
+        Iterator& operator++() { ++position_; return *this; }
+        Iterator operator++(int) { Iterator it = *this; ++position_; return it; }
+        Iterator& operator--() { --position_; return *this; }
+        Iterator operator--(int) { Iterator it = *this; --position_; return it; }
+        Iterator& operator+=(difference_type n) { position_ += n; return *this; }
+        Iterator& operator-=(difference_type n) { position_ -= n; return *this; }
+        Iterator operator+(difference_type n) const { return {route_, position_ + n}; }
+        Iterator operator-(difference_type n) const { return {route_, position_ - n}; }
+        difference_type operator-(const Iterator& rhs) const {
+            return static_cast<difference_type>(position_) - static_cast<difference_type>(rhs.position_);
+        }
+        bool operator==(const Iterator& rhs) const { return position_ == rhs.position_; }
+        bool operator!=(const Iterator& rhs) const { return position_ != rhs.position_; }
+        bool operator<(const Iterator& rhs) const { return position_ < rhs.position_; }
+        bool operator>(const Iterator& rhs) const { return position_ > rhs.position_; }
+        bool operator<=(const Iterator& rhs) const { return position_ <= rhs.position_; }
+        bool operator>=(const Iterator& rhs) const { return position_ >= rhs.position_; }
+
+    private:
+        const Route* route_ = nullptr;
+        size_t position_ = 0;
+    };
+
+    Route() = default;
+
+    /**Количество остановок с учетом обратного направления*/
+    size_t size() const;
+    bool empty() const;
+    const Stop* operator[](size_t position) const;
+    const Stop* front() const;
+    const Stop* back() const;
+    Iterator begin() const;
+    Iterator end() const;
+
+    /**Первые count остановок маршрута без копирования, для зеркального маршрута не больше прямого направления*/
+    Route GetPrefix(size_t count) const;
+    /**Количество хранимых индексов, для зеркального маршрута это только прямое направление*/
+    size_t GetStoredCount() const;
+    bool IsMirrored() const;
+    const RoutePool* GetPool() const;
+
+    bool operator==(const Route& rhs) const;
+    bool operator!=(const Route& rhs) const;
+
+private:
+    friend class RoutePool;
+
+    const RoutePool* pool_ = nullptr;
+    uint32_t offset_ = 0;
+    uint32_t count_ = 0;
+    bool is_mirrored_ = false;
+
+    Route(const RoutePool* pool, uint32_t offset, uint32_t count, bool is_mirrored);
+};
+
+}
@@ -3,6 +3,7 @@
 #include "ranges.h"
 
 #include <cstdlib>
+#include <memory_resource>
 #include <vector>
 
 namespace TransportGuide::graph {
@@ -20,12 +21,14 @@ struct Edge {
 template<typename Weight> // time minutes -  double
 class DirectedWeightedGraph {
 private:
-    using IncidenceList = std::vector<EdgeId>;
+    using IncidenceList = std::pmr::vector<EdgeId>;
     using IncidentEdgesRange = ranges::Range<typename IncidenceList::const_iterator>;
 
 public:
-    DirectedWeightedGraph() = default;
-    explicit DirectedWeightedGraph(size_t vertex_count);
+    explicit DirectedWeightedGraph(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+    /**Ребра и списки смежности выделяются из resource*/
+    explicit DirectedWeightedGraph(size_t vertex_count,
+            std::pmr::memory_resource* resource = std::pmr::get_default_resource());
     EdgeId AddEdge(const Edge<Weight>& edge);
     
     size_t GetVertexCount() const;
@@ -34,8 +37,8 @@ public:
     IncidentEdgesRange GetIncidentEdges(VertexId vertex) const;
 
 private:
-    std::vector<Edge<Weight>> edges_;
-    std::vector<IncidenceList> incidence_lists_ = {};
+    std::pmr::vector<Edge<Weight>> edges_;
+    std::pmr::vector<IncidenceList> incidence_lists_;
 
 public:
     struct SerializerDirectedWeightedGraph final {
@@ -43,9 +46,9 @@ public:
         
         ~SerializerDirectedWeightedGraph() = default;
         
-        std::vector<Edge<Weight>>& GetEdges() { return graph_.edges_; }
+        std::pmr::vector<Edge<Weight>>& GetEdges() { return graph_.edges_; }
         
-        std::vector<IncidenceList>& GetIncidenceLists() { return graph_.incidence_lists_; }
+        std::pmr::vector<IncidenceList>& GetIncidenceLists() { return graph_.incidence_lists_; }
     
     private:
         DirectedWeightedGraph& graph_;
@@ -55,8 +58,13 @@ public:
 
 
 template <typename Weight>
-DirectedWeightedGraph<Weight>::DirectedWeightedGraph(size_t vertex_count)
-    : incidence_lists_(vertex_count) {
+DirectedWeightedGraph<Weight>::DirectedWeightedGraph(std::pmr::memory_resource* resource)
+    : edges_(resource), incidence_lists_(resource) {
+}
+
+template <typename Weight>
+DirectedWeightedGraph<Weight>::DirectedWeightedGraph(size_t vertex_count, std::pmr::memory_resource* resource)
+    : edges_(resource), incidence_lists_(vertex_count, resource) {
 }
 
 template <typename Weight>
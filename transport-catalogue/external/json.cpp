@@ -1,11 +1,30 @@
 #include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <iterator>
+#include <stdexcept>
 #include <variant>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 #include "json.h"
 
 namespace TransportGuide::json {
 
 //region --------Node--------
+Node::Node(const char* value) : NodeVariant(String(value)) {
+}
+
+Node::Node(std::string_view value) : NodeVariant(String(value)) {
+}
+
+Node::Node(const std::string& value) : NodeVariant(String(value)) {
+}
+
 bool Node::IsInt() const {
     return std::holds_alternative<int>(*this);
 }
@@ -23,7 +42,7 @@ bool Node::IsBool() const {
 }
 
 bool Node::IsString() const {
-    return std::holds_alternative<std::string>(*this);
+    return std::holds_alternative<String>(*this);
 }
 
 bool Node::IsNull() const {
@@ -68,8 +87,8 @@ double Node::AsDouble() const {
     }
 }
 
-const std::string& Node::AsString() const {
-    if (const auto* value_ptr = std::get_if<std::string>(this)) {
+const String& Node::AsString() const {
+    if (const auto* value_ptr = std::get_if<String>(this)) {
         return *value_ptr;
     }
     else {
@@ -107,47 +126,371 @@ bool Node::operator!=(const Node& rhs) const {
 
 //endregion
 
-namespace {
-using namespace std::literals;
+//region --------Dict--------
+
+//Размер словаря, до которого ключ ищется перебором
+static const size_t LINEAR_SEARCH_SIZE = 8;
+
+Dict::Dict(std::pmr::memory_resource* resource) : items_(resource) {
+}
+
+Dict::Dict(std::initializer_list<std::pair<std::string_view, Node>> items) {
+    items_.reserve(items.size());
+    for (const auto& [key, value] : items) {
+        items_.emplace_back(key, value);
+    }
+    SortItems();
+}
+
+Dict::Dict(Storage items) : items_(std::move(items)) {
+    SortItems();
+}
+
+size_t Dict::size() const {
+    return items_.size();
+}
+
+bool Dict::empty() const {
+    return items_.empty();
+}
+
+Dict::iterator Dict::begin() {
+    return items_.begin();
+}
+
+Dict::iterator Dict::end() {
+    return items_.end();
+}
+
+Dict::const_iterator Dict::begin() const {
+    return items_.begin();
+}
+
+Dict::const_iterator Dict::end() const {
+    return items_.end();
+}
+
+Dict::iterator Dict::find(std::string_view key) {
+    return items_.begin() + (static_cast<const Dict&>(*this).find(key) - items_.cbegin());
+}
 
-inline void SkipEscapeSequence(std::istream& input) {
-    const std::string escape_symbol_list = " \n\r\t";
-    while (input.peek() != EOF && escape_symbol_list.find(input.peek()) != std::string::npos) {
-        char c;
-        input.get(c);
+Dict::const_iterator Dict::find(std::string_view key) const {
+    if (items_.size() <= LINEAR_SEARCH_SIZE) {
+        return std::find_if(items_.begin(), items_.end(), [key](const value_type& item) {
+            return item.first == key;
+        });
     }
+    auto it = std::lower_bound(items_.begin(), items_.end(), key, [](const value_type& item, std::string_view key) {
+        return item.first < key;
+    });
+    return it != items_.end() && it->first == key ? it : items_.end();
+}
+
+size_t Dict::count(std::string_view key) const {
+    return find(key) != items_.end() ? 1 : 0;
 }
 
-using Number = std::variant<int, double>;
+Node& Dict::at(std::string_view key) {
+    return const_cast<Node&>(static_cast<const Dict&>(*this).at(key));
+}
 
-Number LoadNumber(std::istream& input) {
+const Node& Dict::at(std::string_view key) const {
     using namespace std::literals;
+    auto it = find(key);
+    if (it == items_.end()) {
+        throw std::out_of_range("Dict has no key \""s + std::string(key) + "\"."s);
+    }
+    return it->second;
+}
+
+std::pair<Dict::iterator, bool> Dict::emplace(std::string_view key, Node value) {
+    auto it = std::lower_bound(items_.begin(), items_.end(), key, [](const value_type& item, std::string_view key) {
+        return item.first < key;
+    });
+    if (it != items_.end() && it->first == key) {
+        return {it, false};
+    }
+    it = items_.emplace(it, key, std::move(value));
+    return {it, true};
+}
+
+bool Dict::operator==(const Dict& rhs) const {
+    return items_ == rhs.items_;
+}
+
+bool Dict::operator!=(const Dict& rhs) const {
+    return !(*this == rhs);
+}
+
+void Dict::SortItems() {
+    auto key_less = [](const value_type& lhs, const value_type& rhs) {
+        return lhs.first < rhs.first;
+    };
+    if (items_.size() <= LINEAR_SEARCH_SIZE) {
+        //Небольшой словарь сортируется вставками на месте, без временного буфера std::stable_sort
+        for (auto it = items_.begin(); it != items_.end(); ++it) {
+            std::rotate(std::upper_bound(items_.begin(), it, *it, key_less), it, std::next(it));
+        }
+    }
+    else {
+        std::stable_sort(items_.begin(), items_.end(), key_less);
+    }
+    //После устойчивой сортировки первым среди одинаковых ключей стоит первый по порядку в тексте
+    items_.erase(std::unique(items_.begin(), items_.end(), [](const value_type& lhs, const value_type& rhs) {
+        return lhs.first == rhs.first;
+    }), items_.end());
+}
+
+//endregion
+
+namespace {
+using namespace std::literals;
+
+//Размер части потока, которая читается за один раз
+static const size_t CHUNK_SIZE = 1 << 16;
+
+/**Позиции первого этапа разбора: значимые символы вне строк по возрастанию и экранирование или перевод строки
+ * внутри строк. Внутри строк значимых позиций нет, поэтому за открывающей кавычкой всегда следует закрывающая*/
+class StructuralIndex {
+public:
+    static const size_t BLOCK_SIZE = 64;
+    
+    explicit StructuralIndex(std::string_view input) {
+        tokens.reserve(input.size() / 8);
+        size_t offset = 0;
+        for (; offset + BLOCK_SIZE <= input.size(); offset += BLOCK_SIZE) {
+            AddBlock(offset, ClassifyBlock(input.data() + offset), ~uint64_t(0));
+        }
+        if (offset < input.size()) {
+            size_t size = input.size() - offset;
+            AddBlock(offset, ClassifyBlockScalar(input.data() + offset, size), (uint64_t(1) << size) - 1);
+        }
+    }
+    
+    std::vector<uint32_t> tokens;
+    std::vector<uint32_t> specials;
+
+private:
+    struct BlockMasks {
+        uint64_t quote = 0;
+        uint64_t backslash = 0;
+        uint64_t line_break = 0;
+        uint64_t structural = 0;
+        uint64_t whitespace = 0;
+    };
     
-    std::string parsed_num;
+    //Переносы между блоками: первый символ экранирован, блок начинается внутри строки, внутри числа или слова
+    bool is_escaped_ = false;
+    bool is_in_string_ = false;
+    bool is_in_scalar_ = false;
+    
+    static BlockMasks ClassifyBlockScalar(const char* block, size_t size) {
+        BlockMasks masks;
+        for (size_t i = 0; i < size; ++i) {
+            uint64_t bit = uint64_t(1) << i;
+            switch (block[i]) {
+                case '"': masks.quote |= bit; break;
+                case '\\': masks.backslash |= bit; break;
+                case '\n': masks.line_break |= bit; masks.whitespace |= bit; break;
+                case '\r': masks.line_break |= bit; masks.whitespace |= bit; break;
+                case ' ': case '\t': masks.whitespace |= bit; break;
+                case '{': case '}': case '[': case ']': case ':': case ',': masks.structural |= bit; break;
+                default: break;
+            }
+        }
+        return masks;
+    }
+
+#ifdef __SSE2__
+    //Маска совпадений 16 байт с символом, бит i соответствует байту i
+    static uint64_t Match(__m128i chunk, char c) {
+        return static_cast<uint64_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(c))));
+    }
     
-    // Считывает в parsed_num очередной символ из input
-    auto read_char = [&parsed_num, &input] {
-        parsed_num += static_cast<char>(input.get());
-        if (!input) {
-            throw ParsingError("Failed to read number from stream"s);
+    static BlockMasks ClassifyBlock(const char* block) {
+        BlockMasks masks;
+        for (size_t part = 0; part < BLOCK_SIZE / 16; ++part) {
+            __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + part * 16));
+            size_t shift = part * 16;
+            uint64_t line_break = Match(chunk, '\n') | Match(chunk, '\r');
+            masks.quote |= Match(chunk, '"') << shift;
+            masks.backslash |= Match(chunk, '\\') << shift;
+            masks.line_break |= line_break << shift;
+            masks.whitespace |= (line_break | Match(chunk, ' ') | Match(chunk, '\t')) << shift;
+            masks.structural |= (Match(chunk, '{') | Match(chunk, '}') | Match(chunk, '[') | Match(chunk, ']')
+                                 | Match(chunk, ':') | Match(chunk, ',')) << shift;
         }
+        return masks;
+    }
+#else
+    static BlockMasks ClassifyBlock(const char* block) {
+        return ClassifyBlockScalar(block, BLOCK_SIZE);
+    }
+#endif
+    
+    //Биты символов, перед которыми стоит незаэкранированная обратная косая черта
+    uint64_t FindEscaped(uint64_t backslash) {
+        uint64_t escaped = 0;
+        if (is_escaped_) {
+            escaped |= 1;
+            backslash &= ~uint64_t(1);
+        }
+        is_escaped_ = false;
+        while (backslash != 0) {
+            int i = __builtin_ctzll(backslash);
+            if (i == 63) {
+                is_escaped_ = true;
+                break;
+            }
+            escaped |= uint64_t(1) << (i + 1);
+            //Следующий символ экранирован, даже если это тоже обратная косая черта
+            backslash &= ~(uint64_t(3) << i);
+        }
+        return escaped;
+    }
+    
+    //Префиксный xor: бит i равен четности кавычек на позициях до i включительно
+    static uint64_t PrefixXor(uint64_t value) {
+        value ^= value << 1;
+        value ^= value << 2;
+        value ^= value << 4;
+        value ^= value << 8;
+        value ^= value << 16;
+        value ^= value << 32;
+        return value;
+    }
+    
+    static void AddPositions(std::vector<uint32_t>& positions, size_t offset, uint64_t mask) {
+        while (mask != 0) {
+            positions.push_back(static_cast<uint32_t>(offset + __builtin_ctzll(mask)));
+            mask &= mask - 1;
+        }
+    }
+    
+    void AddBlock(size_t offset, const BlockMasks& masks, uint64_t valid) {
+        uint64_t quote = masks.quote & ~FindEscaped(masks.backslash);
+        //Открывающая кавычка и содержимое строки внутри, закрывающая кавычка уже снаружи
+        uint64_t in_string = PrefixXor(quote) ^ (is_in_string_ ? ~uint64_t(0) : 0);
+        is_in_string_ = (in_string >> 63) != 0;
+        //Все, что не пробел, не структурный символ и не кавычка вне строк, относится к числам и словам
+        uint64_t scalar = ~(masks.whitespace | masks.structural | quote | in_string) & valid;
+        uint64_t scalar_start = scalar & ~((scalar << 1) | (is_in_scalar_ ? 1 : 0));
+        is_in_scalar_ = (scalar >> 63) != 0;
+        
+        AddPositions(tokens, offset, (masks.structural & ~in_string) | quote | scalar_start);
+        AddPositions(specials, offset, (masks.backslash | masks.line_break) & in_string & ~quote);
+    }
+};
+
+/**Разбор JSON из буфера с передачей событий в Handler.
+ * Позиция в тексте - указатель, символы читаются без peek/get потока, строки копируются целыми отрезками,
+ * числа преобразуются через std::from_chars. Текст из потока читается частями в буфер фиксированного размера*/
+class Parser {
+public:
+    Parser(std::string_view input, Handler& handler)
+            : current_(input.data()), end_(input.data() + input.size()), handler_(handler) {}
+    
+    Parser(std::istream& input, Handler& handler) : input_(&input), chunk_(CHUNK_SIZE, '\0'), handler_(handler) {
+        current_ = end_ = chunk_.data();
+    }
+    
+    void LoadNode();
+    /**Разбор по индексу структурных позиций текста, переданного в конструктор*/
+    void LoadIndexedNode(const StructuralIndex& index);
+    
+private:
+    std::istream* input_ = nullptr;
+    std::string chunk_;
+    const char* current_;
+    const char* end_;
+    Handler& handler_;
+    //Переиспользуемые буферы строк и лексем чисел, после разгона разбор не выделяет под них память
+    std::string string_;
+    std::string token_;
+    
+    //Дочитывает следующую часть потока, если текущая закончилась. Возвращает false, когда текст закончился
+    bool Fill() {
+        if (current_ != end_) { return true; }
+        if (input_ == nullptr) { return false; }
+        input_->read(chunk_.data(), static_cast<std::streamsize>(chunk_.size()));
+        current_ = chunk_.data();
+        end_ = current_ + input_->gcount();
+        return current_ != end_;
+    }
+    
+    int Peek() {
+        return Fill() ? static_cast<unsigned char>(*current_) : EOF;
+    }
+    
+    char Get() {
+        return Fill() ? *current_++ : static_cast<char>(EOF);
+    }
+    
+    bool IsDigit() {
+        return Fill() && std::isdigit(static_cast<unsigned char>(*current_));
+    }
+    
+    void SkipEscapeSequence();
+    void LoadNumber();
+    void LoadString();
+    void LoadWord();
+    void LoadArray();
+    void LoadDict();
+    
+    //Курсоры второго этапа по позициям индекса
+    const char* begin_ = nullptr;
+    const uint32_t* position_ = nullptr;
+    const uint32_t* position_end_ = nullptr;
+    const uint32_t* special_ = nullptr;
+    const uint32_t* special_end_ = nullptr;
+    
+    //Символ следующей позиции индекса без ее извлечения, после последней позиции EOF
+    int PeekToken() const {
+        return position_ != position_end_ ? static_cast<unsigned char>(begin_[*position_]) : EOF;
+    }
+    
+    char GetToken() {
+        if (position_ == position_end_) { return static_cast<char>(EOF); }
+        current_ = begin_ + *position_ + 1;
+        return begin_[*position_++];
+    }
+    
+    void LoadIndexedValue();
+    void LoadIndexedString();
+    void LoadIndexedArray();
+    void LoadIndexedDict();
+    void CheckIndexedValueEnd() const;
+};
+
+void Parser::SkipEscapeSequence() {
+    while (Fill() && (*current_ == ' ' || *current_ == '\n' || *current_ == '\r' || *current_ == '\t')) {
+        ++current_;
+    }
+}
+
+void Parser::LoadNumber() {
+    token_.clear();
+    
+    // Считывает в token_ очередной символ
+    auto read_char = [this] {
+        token_.push_back(*current_++);
     };
     
-    // Считывает одну или более цифр в parsed_num из input
-    auto read_digits = [&input, read_char] {
-        if (!std::isdigit(input.peek())) {
+    // Считывает одну или более цифр в token_
+    auto read_digits = [this, read_char] {
+        if (!IsDigit()) {
             throw ParsingError("A digit is expected"s);
         }
-        while (std::isdigit(input.peek())) {
+        while (IsDigit()) {
             read_char();
         }
     };
     
-    if (input.peek() == '-') {
+    if (Peek() == '-') {
         read_char();
     }
     // Парсим целую часть числа
-    if (input.peek() == '0') {
+    if (Peek() == '0') {
         read_char();
         // После 0 в JSON не могут идти другие цифры
     }
@@ -157,332 +500,488 @@ Number LoadNumber(std::istream& input) {
     
     bool is_int = true;
     // Парсим дробную часть числа
-    if (input.peek() == '.') {
+    if (Peek() == '.') {
         read_char();
         read_digits();
         is_int = false;
     }
     
     // Парсим экспоненциальную часть числа
-    if (int ch = input.peek(); ch == 'e' || ch == 'E') {
+    if (int ch = Peek(); ch == 'e' || ch == 'E') {
         read_char();
-        if (ch = input.peek(); ch == '+' || ch == '-') {
+        if (ch = Peek(); ch == '+' || ch == '-') {
             read_char();
         }
         read_digits();
         is_int = false;
     }
     
-    try {
-        if (is_int) {
-            // Сначала пробуем преобразовать строку в int
-            try {
-                return std::stoi(parsed_num);
-            }
-            catch (...) {
-                // В случае неудачи, например, при переполнении,
-                // код ниже попробует преобразовать строку в double
-            }
+    const char* begin = token_.data();
+    const char* end = token_.data() + token_.size();
+    if (is_int) {
+        // Сначала пробуем преобразовать строку в int, при переполнении число читается как double
+        int value;
+        if (auto [ptr, ec] = std::from_chars(begin, end, value); ec == std::errc()) {
+            handler_.Int(value);
+            return;
         }
-        return std::stod(parsed_num);
     }
-    catch (...) {
-        throw ParsingError("Failed to convert "s + parsed_num + " to number"s);
+    double value;
+    if (auto [ptr, ec] = std::from_chars(begin, end, value); ec != std::errc() || ptr != end) {
+        throw ParsingError("Failed to convert "s + token_ + " to number"s);
     }
+    handler_.Double(value);
 }
 
-// Считывает содержимое строкового литерала JSON-документа
+// Считывает содержимое строкового литерала JSON-документа в string_
 // Функцию следует использовать после считывания открывающего символа ":
-std::string LoadString(std::istream& input) {
-    using namespace std::literals;
-    
-    auto it = std::istreambuf_iterator<char>(input);
-    auto end = std::istreambuf_iterator<char>();
-    std::string s;
+void Parser::LoadString() {
+    string_.clear();
     while (true) {
-        if (it == end) {
+        if (!Fill()) {
             // Поток закончился до того, как встретили закрывающую кавычку?
             throw ParsingError("String parsing error");
         }
-        const char ch = *it;
+        // Обычные символы до ближайшего особого добавляются в строку одним отрезком
+        const char* run_begin = current_;
+        while (current_ != end_ && *current_ != '"' && *current_ != '\\' && *current_ != '\n' && *current_ != '\r') {
+            ++current_;
+        }
+        string_.append(run_begin, current_);
+        if (current_ == end_) {
+            continue;
+        }
+        
+        const char ch = *current_++;
         if (ch == '"') {
             // Встретили закрывающую кавычку
-            ++it;
             break;
         }
         else if (ch == '\\') {
             // Встретили начало escape-последовательности
-            ++it;
-            if (it == end) {
+            if (!Fill()) {
                 // Поток завершился сразу после символа обратной косой черты
                 throw ParsingError("String parsing error");
             }
-            const char escaped_char = *(it);
+            const char escaped_char = *current_++;
             // Обрабатываем одну из последовательностей: \\, \n, \t, \r, \"
             switch (escaped_char) {
                 case 'n':
-                    s.push_back('\n');
+                    string_.push_back('\n');
                     break;
                 case 't':
-                    s.push_back('\t');
+                    string_.push_back('\t');
                     break;
                 case 'r':
-                    s.push_back('\r');
+                    string_.push_back('\r');
                     break;
                 case '"':
-                    s.push_back('"');
+                    string_.push_back('"');
                     break;
                 case '\\':
-                    s.push_back('\\');
+                    string_.push_back('\\');
                     break;
                 default:
                     // Встретили неизвестную escape-последовательность
                     throw ParsingError("Unrecognized escape sequence \\"s + escaped_char);
             }
         }
-        else if (ch == '\n' || ch == '\r') {
+        else {
             // Строковый литерал внутри- JSON не может прерываться символами \r или \n
             throw ParsingError("Unexpected end of line"s);
         }
-        else {
-            // Просто считываем очередной символ и помещаем его в результирующую строку
-            s.push_back(ch);
-        }
-        ++it;
     }
-    
-    return s;
 }
 
-Node LoadNode(std::istream& input) {
-    const std::string end_word_symbol_list = " \n\r\t\\:,}]";
-    SkipEscapeSequence(input);
-    char c = input.peek();
-    if (c == '\"') {
-        input.get(c);
-        std::string str = LoadString(input);
-        return Node(std::move(str));
+void Parser::LoadWord() {
+    const std::string_view end_word_symbol_list = " \n\r\t\\:,}]"sv;
+    token_.assign(1, *current_++);
+    while (Fill() && end_word_symbol_list.find(*current_) == std::string_view::npos) {
+        token_.push_back(*current_++);
     }
-    else if (c == '{') {
-        input.get(c);
-        Dict map;
-        while (true) {
-            SkipEscapeSequence(input);
-            if (input.peek() == '}') {
-                input.get(c);
-                break;
-            }
-            std::string str_key;
-            
-            input.get(c);
-            if (c == '\"') {
-                str_key = LoadString(input);
-            }
-            else {
-                throw json::ParsingError("Key must be in an environment symbol \'\"\'"s);
-            }
-            
-            SkipEscapeSequence(input);
-            input.get(c);
-            
-            if (c != ':') {
-                throw json::ParsingError("After key must be symbol \':\', now \'"s + c + "\'"s);
-            }
-            
-            Node node = LoadNode(input);
-            map.emplace(std::move(str_key), std::move(node));
-            
-            SkipEscapeSequence(input);
-            input.get(c);
-            
-            if (c == ',') {
-                continue;
-            }
-            else if (c == '}') {
-                break;
-            }
-            else {
-                throw json::ParsingError("After value must be symbol \',\' or \'}\'\n"s + c);
-            }
-        }
-        return Node(std::move(map));
+    if (token_ == "true"sv) {
+        handler_.Bool(true);
     }
-    else if (c == '[') {
-        input.get(c);
-        Array arr;
-        while (true) {
-            SkipEscapeSequence(input);
-            if (input.peek() == ']') {
-                input.get(c);
-                break;
-            }
-            
-            Node node = LoadNode(input);
-            arr.emplace_back(std::move(node));
-            
-            SkipEscapeSequence(input);
-            input.get(c);
-            
-            if (c == ',') {
-                continue;
-            }
-            else if (c == ']') {
-                break;
-            }
-            else {
-                throw json::ParsingError("After value must be symbol \',\' or \']\'\n"s + c);
-            }
+    else if (token_ == "false"sv) {
+        handler_.Bool(false);
+    }
+    else if (token_ == "null"sv) {
+        handler_.Null();
+    }
+    else {
+        throw json::ParsingError("Description with an error");
+    }
+}
+
+void Parser::LoadArray() {
+    handler_.StartArray();
+    while (true) {
+        SkipEscapeSequence();
+        if (Peek() == ']') {
+            ++current_;
+            break;
         }
-        return Node(std::move(arr));
         
+        LoadNode();
+        
+        SkipEscapeSequence();
+        char c = Get();
+        
+        if (c == ',') {
+            continue;
+        }
+        else if (c == ']') {
+            break;
+        }
+        else {
+            throw json::ParsingError("After value must be symbol \',\' or \']\'\n"s + c);
+        }
     }
-    else if (c == 't' || c == 'f' || c == 'n') {
-        std::string str;
-        input.get(c);
-        str += c;
-        while (input.get(c)) {
-            str += c;
-            if (end_word_symbol_list.find(input.peek()) != std::string::npos) {
-                break;
-            }
+    handler_.EndArray();
+}
+
+void Parser::LoadDict() {
+    handler_.StartDict();
+    while (true) {
+        SkipEscapeSequence();
+        if (Peek() == '}') {
+            ++current_;
+            break;
         }
-        if (str == "true") {
-            return Node(true);
+        
+        if (Get() != '\"') {
+            throw json::ParsingError("Key must be in an environment symbol \'\"\'"s);
+        }
+        LoadString();
+        handler_.Key(string_);
+        
+        SkipEscapeSequence();
+        char c = Get();
+        
+        if (c != ':') {
+            throw json::ParsingError("After key must be symbol \':\', now \'"s + c + "\'"s);
         }
-        else if (str == "false") {
-            return Node(false);
+        
+        LoadNode();
+        
+        SkipEscapeSequence();
+        c = Get();
+        
+        if (c == ',') {
+            continue;
         }
-        else if (str == "null") {
-            return Node(nullptr);
+        else if (c == '}') {
+            break;
         }
         else {
-            throw json::ParsingError("Description with an error");
+            throw json::ParsingError("After value must be symbol \',\' or \'}\'\n"s + c);
         }
     }
-    else if (std::isdigit(c) || c == '+' || c == '-') {
-        Number number = LoadNumber(input);
-        if (std::holds_alternative<int>(number)) {
-            int num = std::get<int>(number);
-            return Node(num);
-        }
-        else if (std::holds_alternative<double>(number)) {
-            double num = std::get<double>(number);
-            return Node(num);
-        }
+    handler_.EndDict();
+}
+
+void Parser::LoadNode() {
+    SkipEscapeSequence();
+    char c = static_cast<char>(Peek());
+    if (c == '\"') {
+        ++current_;
+        LoadString();
+        handler_.String(string_);
+    }
+    else if (c == '{') {
+        ++current_;
+        LoadDict();
+    }
+    else if (c == '[') {
+        ++current_;
+        LoadArray();
+    }
+    else if (c == 't' || c == 'f' || c == 'n') {
+        LoadWord();
+    }
+    else if (std::isdigit(static_cast<unsigned char>(c)) || c == '+' || c == '-') {
+        LoadNumber();
     }
     else {
         throw json::ParsingError("Invalid character \'"s + c + "\'");
     }
-    return Node(nullptr);
 }
 
+void Parser::LoadIndexedNode(const StructuralIndex& index) {
+    begin_ = current_;
+    position_ = index.tokens.data();
+    position_end_ = position_ + index.tokens.size();
+    special_ = index.specials.data();
+    special_end_ = special_ + index.specials.size();
+    LoadIndexedValue();
+}
 
-struct PrintContext {
-    int indent_step = 4;
-    int indent = 0;
-    bool from_map = false;
-    
-    std::string PrintIndent() const {
-        return std::string(indent, ' ');
+void Parser::LoadIndexedValue() {
+    char c = static_cast<char>(PeekToken());
+    if (c == '\"') {
+        LoadIndexedString();
+        handler_.String(string_);
     }
-    
-    // Возвращает новый контекст вывода с увеличенным смещением
-    PrintContext Indented(bool is_map = false) const {
-        return {indent_step, indent_step + indent, is_map};
+    else if (c == '{') {
+        GetToken();
+        LoadIndexedDict();
     }
-};
-
+    else if (c == '[') {
+        GetToken();
+        LoadIndexedArray();
+    }
+    else if (c == 't' || c == 'f' || c == 'n') {
+        current_ = begin_ + *position_++;
+        LoadWord();
+    }
+    else if (std::isdigit(static_cast<unsigned char>(c)) || c == '+' || c == '-') {
+        current_ = begin_ + *position_++;
+        LoadNumber();
+    }
+    else {
+        throw json::ParsingError("Invalid character \'"s + c + "\'");
+    }
+}
 
-std::ostream& PrintNode(std::ostream& out, const Node& node, PrintContext context = {}) {
-    PrintContext context_indented = context.Indented();
-    if (node.IsInt()) {
-        if (!context.from_map) { out << context.PrintIndent(); }
-        out << node.AsInt();
+void Parser::LoadIndexedString() {
+    const char* content = begin_ + *position_++ + 1;
+    if (position_ == position_end_) {
+        // Текст закончился до того, как встретили закрывающую кавычку
+        throw ParsingError("String parsing error");
     }
-    else if (node.IsDouble()) {
-        if (!context.from_map) { out << context.PrintIndent(); }
-        out << node.AsDouble();
+    const char* content_end = begin_ + *position_++;
+    const uint32_t content_position = static_cast<uint32_t>(content - begin_);
+    while (special_ != special_end_ && *special_ < content_position) {
+        ++special_;
     }
-    else if (node.IsBool()) {
-        if (!context.from_map) { out << context.PrintIndent(); }
-        out << (node.AsBool() ? "true" : "false");
+    if (special_ == special_end_ || begin_ + *special_ >= content_end) {
+        // Строка без экранирования копируется целиком
+        string_.assign(content, content_end);
     }
-    else if (node.IsString()) {
-        const std::string& str = node.AsString();
-        std::string new_str;
-        std::for_each(str.begin(), str.end(), [&new_str](char c) {
-            if (c == '\r') {
-                new_str += R"(\r)";
-            }
-            else if (c == '\n') {
-                new_str += R"(\n)";
-            }
-            else if (c == '\"') {
-                new_str += R"(\")";
-            }
-            else if (c == '\\') {
-                new_str += R"(\\)";
-            }
-            else {
-                new_str += c;
-            }
-        });
-        if (!context.from_map) { out << context.PrintIndent(); }
-        out <<  "\"" << new_str << "\"";
+    else {
+        current_ = content;
+        LoadString();
     }
-    else if (node.IsNull()) {
-        if (!context.from_map) { out << context.PrintIndent(); }
-        out <<  "null";
+    current_ = content_end + 1;
+}
+
+//После числа или слова внутри массива или словаря не должно остаться символов лексемы
+void Parser::CheckIndexedValueEnd() const {
+    if (current_ != end_ && std::strchr(" \n\r\t{}[]:,\"", *current_) == nullptr) {
+        throw json::ParsingError("After value must be symbol \',\' or closing bracket\n"s + *current_);
     }
-    else if (node.IsArray()) {
-        if (!context.from_map) { out << context.PrintIndent(); }
-        out << "[";
-        bool is_first = true;
-        for (auto internal_node : node.AsArray()) {
-            if (is_first) {
-                out << "\n";
-                is_first = false;
-            }
-            else {
-                out << ",\n";
-            }
-            PrintNode(out, internal_node, context_indented);
+}
+
+void Parser::LoadIndexedArray() {
+    handler_.StartArray();
+    while (true) {
+        if (PeekToken() == ']') {
+            GetToken();
+            break;
+        }
+        
+        LoadIndexedValue();
+        CheckIndexedValueEnd();
+        
+        char c = GetToken();
+        if (c == ',') {
+            continue;
+        }
+        else if (c == ']') {
+            break;
+        }
+        else {
+            throw json::ParsingError("After value must be symbol \',\' or \']\'\n"s + c);
         }
-        if(!node.AsArray().empty()) out << "\n";
-        out << context.PrintIndent();
-        out <<  "]";
     }
-    else if (node.IsMap()) {
-        if (!context.from_map) { out << context.PrintIndent(); }
-        out << "{";
-        bool is_first = true;
-        for (auto [key, internal_node] : node.AsMap()) {
-            if (is_first) {
-                out << "\n";
-                is_first = false;
-            }
-            else {
-                out << ",\n";
-            }
-            out << context_indented.PrintIndent();
-            out << "\"" << key << "\": ";
-            PrintNode(out, internal_node, context.Indented(true));
+    handler_.EndArray();
+}
+
+void Parser::LoadIndexedDict() {
+    handler_.StartDict();
+    while (true) {
+        if (PeekToken() == '}') {
+            GetToken();
+            break;
+        }
+        
+        if (PeekToken() != '\"') {
+            throw json::ParsingError("Key must be in an environment symbol \'\"\'"s);
+        }
+        LoadIndexedString();
+        handler_.Key(string_);
+        
+        char c = GetToken();
+        if (c != ':') {
+            throw json::ParsingError("After key must be symbol \':\', now \'"s + c + "\'"s);
+        }
+        
+        LoadIndexedValue();
+        CheckIndexedValueEnd();
+        
+        c = GetToken();
+        if (c == ',') {
+            continue;
+        }
+        else if (c == '}') {
+            break;
+        }
+        else {
+            throw json::ParsingError("After value must be symbol \',\' or \'}\'\n"s + c);
         }
-        out << "\n";
-        out << context.PrintIndent();
-        out <<  "}";
     }
-    return out;
+    handler_.EndDict();
 }
 
+
+//Накопленный вывод сбрасывается в поток частями такого размера
+const size_t PRINT_FLUSH_SIZE = 64 * 1024;
+const int PRINT_INDENT_STEP = 4;
+
 }  // namespace
 
 
+//region --------NodeHandler--------
+
+void NodeHandler::Null() {
+    AddNode(Node(nullptr));
+}
+
+void NodeHandler::Bool(bool value) {
+    AddNode(Node(value));
+}
+
+void NodeHandler::Int(int value) {
+    AddNode(Node(value));
+}
+
+void NodeHandler::Double(double value) {
+    AddNode(Node(value));
+}
+
+void NodeHandler::String(std::string_view value) {
+    AddNode(Node(json::String(value, GetResource())));
+}
+
+void NodeHandler::StartArray() {
+    containers_.push_back(ContainerType::ARRAY);
+    if (array_depth_ == array_levels_.size()) {
+        array_levels_.emplace_back();
+    }
+    ++array_depth_;
+}
+
+void NodeHandler::EndArray() {
+    std::vector<Node>& level = array_levels_[--array_depth_];
+    Array array(GetResource());
+    array.reserve(level.size());
+    std::move(level.begin(), level.end(), std::back_inserter(array));
+    level.clear();
+    containers_.pop_back();
+    AddNode(Node(std::move(array)));
+}
+
+void NodeHandler::StartDict() {
+    containers_.push_back(ContainerType::DICT);
+    if (dict_depth_ == dict_levels_.size()) {
+        dict_levels_.emplace_back();
+    }
+    ++dict_depth_;
+}
+
+void NodeHandler::Key(std::string_view key) {
+    keys_.emplace_back(key, GetResource());
+}
+
+void NodeHandler::EndDict() {
+    std::vector<Dict::value_type>& level = dict_levels_[--dict_depth_];
+    Dict::Storage items(GetResource());
+    items.reserve(level.size());
+    std::move(level.begin(), level.end(), std::back_inserter(items));
+    level.clear();
+    containers_.pop_back();
+    AddNode(Node(Dict(std::move(items))));
+}
+
+size_t NodeHandler::GetDepth() const {
+    return containers_.size();
+}
+
+bool NodeHandler::HasNode() const {
+    return node_.has_value();
+}
+
+Document NodeHandler::ExtractDocument() {
+    if (!node_.has_value()) {
+        throw ParsingError("Document is incomplete"s);
+    }
+    Document document(std::move(node_.value()), std::move(resource_));
+    node_.reset();
+    resource_.reset();
+    return document;
+}
+
+std::pmr::memory_resource* NodeHandler::GetResource() {
+    if (!resource_) {
+        resource_ = std::make_shared<std::pmr::monotonic_buffer_resource>();
+    }
+    return resource_.get();
+}
+
+void NodeHandler::AddNode(Node node) {
+    if (containers_.empty()) {
+        node_ = std::move(node);
+    }
+    else if (containers_.back() == ContainerType::ARRAY) {
+        array_levels_[array_depth_ - 1].emplace_back(std::move(node));
+    }
+    else {
+        dict_levels_[dict_depth_ - 1].emplace_back(std::move(keys_.back()), std::move(node));
+        keys_.pop_back();
+    }
+}
+
+//endregion
+
+void Parse(std::istream& input, Handler& handler) {
+    Parser(input, handler).LoadNode();
+}
+
+void Parse(std::string_view input, Handler& handler) {
+    if (input.size() >= STRUCTURAL_INDEX_THRESHOLD) {
+        ParseIndexed(input, handler);
+        return;
+    }
+    Parser(input, handler).LoadNode();
+}
+
+void ParseIndexed(std::string_view input, Handler& handler) {
+    //Позиции индекса 32-битные, больший текст разбирается за один проход
+    if (input.size() > std::numeric_limits<uint32_t>::max()) {
+        Parser(input, handler).LoadNode();
+        return;
+    }
+    StructuralIndex index(input);
+    Parser(input, handler).LoadIndexedNode(index);
+}
+
 //region --------Document--------
 
 Document::Document(Node root) : root_(std::move(root)) {
 }
 
+Document::Document(Node root, std::shared_ptr<std::pmr::memory_resource> resource)
+        : resource_(std::move(resource)), root_(std::move(root)) {
+}
+
+Document& Document::operator=(Document other) {
+    //Значения с прежней арены освобождаются, пока она жива, новые переходят вместе со своей ареной
+    root_ = Node();
+    root_ = std::move(other.root_);
+    resource_ = std::move(other.resource_);
+    return *this;
+}
+
 const Node& Document::GetRoot() const {
     return root_;
 }
@@ -496,14 +995,247 @@ bool Document::operator!=(const Document& rhs) const {
 }
 
 Document Load(std::istream& input) {
-    return Document(LoadNode(input));
+    NodeHandler handler;
+    Parse(input, handler);
+    return handler.ExtractDocument();
+}
+
+Document Load(std::string_view input) {
+    NodeHandler handler;
+    Parse(input, handler);
+    return handler.ExtractDocument();
+}
+
+//endregion
+
+
+//region --------Writer--------
+
+Writer::Writer(std::ostream& out, PrintMode mode, size_t depth) : out_(&out), mode_(mode),
+        precision_(static_cast<int>(out.precision())), base_depth_(depth), buffer_(own_buffer_) {
+}
+
+Writer::Writer(std::string& out, PrintMode mode, size_t depth, int precision) : out_(nullptr), mode_(mode),
+        precision_(precision), base_depth_(depth), buffer_(out) {
+}
+
+Writer::~Writer() {
+    Flush();
+}
+
+Writer& Writer::StartDict() {
+    StartContainer(true);
+    return *this;
+}
+
+Writer& Writer::EndDict() {
+    if (depth_ == 0 || !levels_[depth_ - 1].is_dict) { throw std::logic_error("EndDict must close Dictionary."s); }
+    if (levels_[depth_ - 1].has_key) { throw std::logic_error("Key in Dictionary must have value."s); }
+    --depth_;
+    //Закрывающая скобка словаря всегда переносится на новую строку, даже у пустого словаря
+    PrintLineBreak(depth_);
+    buffer_ += '}';
+    AfterValue();
+    return *this;
+}
+
+Writer& Writer::StartArray() {
+    StartContainer(false);
+    return *this;
+}
+
+Writer& Writer::EndArray() {
+    if (depth_ == 0 || levels_[depth_ - 1].is_dict) { throw std::logic_error("EndArray must close Array."s); }
+    --depth_;
+    if (!levels_[depth_].is_empty) { PrintLineBreak(depth_); }
+    buffer_ += ']';
+    AfterValue();
+    return *this;
+}
+
+Writer& Writer::Key(std::string_view key) {
+    if (depth_ == 0 || !levels_[depth_ - 1].is_dict) {
+        throw std::logic_error("\'"s + std::string(key) + "\' must be key in Dictionary"s);
+    }
+    Level& level = levels_[depth_ - 1];
+    if (level.has_key) { throw std::logic_error("Key in Dictionary must have value."s); }
+    if (!level.is_empty && key <= level.last_key) {
+        throw std::logic_error("\'"s + std::string(key) + "\' must be written in ascending order of keys"s);
+    }
+    if (!level.is_empty) { buffer_ += ','; }
+    level.is_empty = false;
+    level.has_key = true;
+    level.last_key.assign(key.data(), key.size());
+    PrintLineBreak(depth_);
+    PrintString(key);
+    buffer_ += mode_ == PrintMode::COMPACT ? ":"sv : ": "sv;
+    return *this;
+}
+
+Writer& Writer::Value(const Node& node) {
+    if (node.IsInt()) {
+        return Value(node.AsInt());
+    }
+    else if (node.IsDouble()) {
+        return Value(node.AsDouble());
+    }
+    else if (node.IsBool()) {
+        return Value(node.AsBool());
+    }
+    else if (node.IsString()) {
+        return Value(std::string_view(node.AsString()));
+    }
+    else if (node.IsArray()) {
+        StartArray();
+        for (const Node& item : node.AsArray()) {
+            Value(item);
+        }
+        return EndArray();
+    }
+    else if (node.IsMap()) {
+        StartDict();
+        for (const auto& [key, item] : node.AsMap()) {
+            Key(key).Value(item);
+        }
+        return EndDict();
+    }
+    return Value(nullptr);
+}
+
+Writer& Writer::Value(std::string_view value) {
+    BeforeValue();
+    PrintString(value);
+    AfterValue();
+    return *this;
+}
+
+Writer& Writer::Value(const std::string& value) {
+    return Value(std::string_view(value));
+}
+
+Writer& Writer::Value(const char* value) {
+    return Value(std::string_view(value));
+}
+
+Writer& Writer::Value(int value) {
+    BeforeValue();
+    char digits[16];
+    auto result = std::to_chars(std::begin(digits), std::end(digits), value);
+    buffer_.append(digits, result.ptr);
+    AfterValue();
+    return *this;
+}
+
+Writer& Writer::Value(double value) {
+    BeforeValue();
+    char digits[64];
+    auto result = std::to_chars(std::begin(digits), std::end(digits), value, std::chars_format::general, precision_);
+    buffer_.append(digits, result.ptr);
+    AfterValue();
+    return *this;
+}
+
+Writer& Writer::Value(bool value) {
+    BeforeValue();
+    buffer_ += value ? "true"sv : "false"sv;
+    AfterValue();
+    return *this;
+}
+
+Writer& Writer::Value(std::nullptr_t) {
+    BeforeValue();
+    buffer_ += "null"sv;
+    AfterValue();
+    return *this;
+}
+
+Writer& Writer::RawValue(std::string_view text) {
+    BeforeValue();
+    buffer_ += text;
+    AfterValue();
+    return *this;
+}
+
+void Writer::Flush() {
+    if (!out_) { return; }
+    out_->write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+    flushed_size_ += buffer_.size();
+    buffer_.clear();
+}
+
+size_t Writer::GetWrittenSize() const {
+    return flushed_size_ + buffer_.size();
+}
+
+void Writer::BeforeValue() {
+    if (depth_ == 0) {
+        if (has_root_) { throw std::logic_error("Document must have one root value."s); }
+        has_root_ = true;
+        return;
+    }
+    Level& level = levels_[depth_ - 1];
+    if (level.is_dict) {
+        if (!level.has_key) { throw std::logic_error("Value in Dictionary must have key."s); }
+        level.has_key = false;
+        return;
+    }
+    if (!level.is_empty) { buffer_ += ','; }
+    level.is_empty = false;
+    PrintLineBreak(depth_);
+}
+
+void Writer::AfterValue() {
+    if (buffer_.size() >= PRINT_FLUSH_SIZE) { Flush(); }
+}
+
+void Writer::StartContainer(bool is_dict) {
+    BeforeValue();
+    buffer_ += is_dict ? '{' : '[';
+    if (levels_.size() == depth_) { levels_.emplace_back(); }
+    Level& level = levels_[depth_++];
+    level.is_dict = is_dict;
+    level.is_empty = true;
+    level.has_key = false;
+}
+
+void Writer::PrintString(std::string_view str) {
+    AppendEscapedString(buffer_, str);
+}
+
+void Writer::PrintLineBreak(size_t depth) {
+    if (mode_ == PrintMode::PRETTY) {
+        buffer_ += '\n';
+        buffer_.append((base_depth_ + depth) * PRINT_INDENT_STEP, ' ');
+    }
 }
 
 //endregion
 
+void AppendEscapedString(std::string& out, std::string_view str) {
+    out += '\"';
+    //Отрезки без экранируемых символов копируются целиком
+    size_t run_begin = 0;
+    for (size_t i = 0; i < str.size(); ++i) {
+        std::string_view escaped;
+        switch (str[i]) {
+            case '\r': escaped = R"(\r)"sv; break;
+            case '\n': escaped = R"(\n)"sv; break;
+            case '\"': escaped = R"(\")"sv; break;
+            case '\\': escaped = R"(\\)"sv; break;
+            default: continue;
+        }
+        out.append(str.data() + run_begin, i - run_begin);
+        out += escaped;
+        run_begin = i + 1;
+    }
+    out.append(str.data() + run_begin, str.size() - run_begin);
+    out += '\"';
+}
 
-void Print(const Document& doc, std::ostream& out) {
-    PrintNode(out, doc.GetRoot(), PrintContext());
+void Print(const Document& doc, std::ostream& out, PrintMode mode) {
+    Writer writer(out, mode);
+    writer.Value(doc.GetRoot());
+    writer.Flush();
     out << std::endl;
 }
 
@@ -1,8 +1,13 @@
 #pragma once
 
+#include <cstddef>
+#include <initializer_list>
 #include <iostream>
-#include <map>
+#include <memory>
+#include <memory_resource>
+#include <optional>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 #include <variant>
@@ -12,8 +17,49 @@ namespace TransportGuide::json {
 
 class Node;
 
-using Array = std::vector<Node>;
-using Dict = std::map<std::string, Node>;
+/**Строки и массивы берут память из ресурса документа, у созданных вручную значений это ресурс по умолчанию.
+ * Копия значения всегда размещается в ресурсе по умолчанию и не зависит от исходного документа*/
+using String = std::pmr::string;
+using Array = std::pmr::vector<Node>;
+
+/**Словарь JSON: пары ключ-значение лежат в одном массиве и упорядочены по ключу, порядок обхода как у std::map.
+ * В небольших словарях ключ ищется перебором, в больших двоичным поиском*/
+class Dict {
+public:
+    using value_type = std::pair<String, Node>;
+    using Storage = std::pmr::vector<value_type>;
+    using iterator = Storage::iterator;
+    using const_iterator = Storage::const_iterator;
+    
+    Dict() = default;
+    explicit Dict(std::pmr::memory_resource* resource);
+    Dict(std::initializer_list<std::pair<std::string_view, Node>> items);
+    /**Пары в произвольном порядке, при повторе ключа остается первое значение*/
+    explicit Dict(Storage items);
+    
+    [[nodiscard]] size_t size() const;
+    [[nodiscard]] bool empty() const;
+    iterator begin();
+    iterator end();
+    const_iterator begin() const;
+    const_iterator end() const;
+    
+    iterator find(std::string_view key);
+    const_iterator find(std::string_view key) const;
+    size_t count(std::string_view key) const;
+    Node& at(std::string_view key);
+    const Node& at(std::string_view key) const;
+    /**Вставить пару на место по порядку ключей, если ключ уже есть, значение не меняется*/
+    std::pair<iterator, bool> emplace(std::string_view key, Node value);
+    
+    bool operator==(const Dict& rhs) const;
+    bool operator!=(const Dict& rhs) const;
+
+private:
+    Storage items_;
+    
+    void SortItems();
+};
 
 // Эта ошибка должна выбрасываться при ошибках парсинга JSON
 class ParsingError : public std::runtime_error {
@@ -21,7 +67,7 @@ public:
     using runtime_error::runtime_error;
 };
 
-using NodeVariant = std::variant<std::nullptr_t, bool, int, double, std::string, Array, Dict>;
+using NodeVariant = std::variant<std::nullptr_t, bool, int, double, String, Array, Dict>;
 
 class Builder;
 
@@ -33,6 +79,10 @@ public:
     using variant::variant;
     using Value = variant;
     
+    Node(const char* value);
+    Node(std::string_view value);
+    Node(const std::string& value);
+    
     [[nodiscard]] bool IsInt() const;
     [[nodiscard]] bool IsDouble() const; //Возвращает true, если в Node хранится int либо double.
     [[nodiscard]] bool IsPureDouble() const; //Возвращает true, если в Node хранится double.
@@ -47,7 +97,7 @@ public:
     int AsInt() const;
     bool AsBool() const;
     double AsDouble() const;
-    const std::string& AsString() const;
+    const String& AsString() const;
     
     const Array& AsArray() const;
     const Dict& AsMap() const;
@@ -67,17 +117,177 @@ public:
 class Document {
 public:
     explicit Document(Node root);
+    /**Документ, значения которого размещены в арене resource, арена живет вместе с документом*/
+    Document(Node root, std::shared_ptr<std::pmr::memory_resource> resource);
+    Document(const Document& other) = default;
+    Document(Document&& other) = default;
+    /**Прежние значения освобождаются до смены арены*/
+    Document& operator=(Document other);
     
     const Node& GetRoot() const;
     
     bool operator==(const Document& rhs) const;
     bool operator!=(const Document& rhs) const;
 private:
+    //Арена объявлена раньше корня и разрушается после него
+    std::shared_ptr<std::pmr::memory_resource> resource_;
     Node root_;
 };
 
+/**Получатель событий потокового разбора JSON.
+ * Строки и ключи передаются видом на буфер разборщика, вид действителен только до возврата из метода*/
+class Handler {
+public:
+    virtual ~Handler() = default;
+    
+    virtual void Null() = 0;
+    virtual void Bool(bool value) = 0;
+    virtual void Int(int value) = 0;
+    virtual void Double(double value) = 0;
+    virtual void String(std::string_view value) = 0;
+    virtual void StartArray() = 0;
+    virtual void EndArray() = 0;
+    virtual void StartDict() = 0;
+    virtual void Key(std::string_view key) = 0;
+    virtual void EndDict() = 0;
+};
+
+/**Обработчик, который собирает из событий разбора Node*/
+class NodeHandler final : public Handler {
+public:
+    void Null() override;
+    void Bool(bool value) override;
+    void Int(int value) override;
+    void Double(double value) override;
+    void String(std::string_view value) override;
+    void StartArray() override;
+    void EndArray() override;
+    void StartDict() override;
+    void Key(std::string_view key) override;
+    void EndDict() override;
+    
+    /**Количество незакрытых массивов и словарей*/
+    size_t GetDepth() const;
+    /**Значение собрано полностью*/
+    bool HasNode() const;
+    /**Забрать собранное значение вместе с его ареной, обработчик готов собирать следующее*/
+    Document ExtractDocument();
+
+private:
+    enum class ContainerType {
+        ARRAY, DICT
+    };
+    
+    //Строки, массивы и словари значения размещаются в арене, которая переходит в документ
+    std::shared_ptr<std::pmr::monotonic_buffer_resource> resource_;
+    std::vector<ContainerType> containers_;
+    //Элементы незакрытых массивов и словарей по уровням вложенности. Уровни не освобождаются,
+    //поэтому после разгона разбор выделяет память только в арене, под каждый контейнер ровно по размеру
+    std::vector<std::vector<Node>> array_levels_;
+    std::vector<std::vector<Dict::value_type>> dict_levels_;
+    size_t array_depth_ = 0;
+    size_t dict_depth_ = 0;
+    std::vector<json::String> keys_;
+    std::optional<Node> node_;
+    
+    std::pmr::memory_resource* GetResource();
+    void AddNode(Node node);
+};
+
+/**Разобрать поток, передавая события в handler.
+ * Поток читается частями фиксированного размера, текст документа целиком в памяти не хранится*/
+void Parse(std::istream& input, Handler& handler);
+/**Текст от STRUCTURAL_INDEX_THRESHOLD байт разбирается в два этапа через ParseIndexed*/
+void Parse(std::string_view input, Handler& handler);
+
+static const size_t STRUCTURAL_INDEX_THRESHOLD = 256 * 1024;
+
+/**Разбор в два этапа. Первый находит блоками по 64 байта скобки, двоеточия, запятые, кавычки вне строк и начала
+ * чисел и слов, с SSE2 блок классифицируется векторными сравнениями, без него побайтно. Второй этап идет по найденным
+ * позициям, не просматривая пробелы и содержимое строк без экранирования. События и ошибки те же, что у Parse*/
+void ParseIndexed(std::string_view input, Handler& handler);
+
 Document Load(std::istream& input);
+Document Load(std::string_view input);
+
+/**Режим вывода: с переносами строк и отступами или одной строкой без пробелов для машинной обработки*/
+enum class PrintMode {
+    PRETTY, COMPACT
+};
+
+/**Потоковая запись JSON без построения Node: значения сразу форматируются в буфер вывода.
+ * Вызовы связываются цепочкой, как у Builder. Ключи словаря записываются по возрастанию, как их выводит Print,
+ * тогда запись совпадает с выводом Print для документа из тех же значений.
+ * Буфер сбрасывается в поток крупными частями и при вызове Flush, после прогрева запись не выделяет память.
+ * Числа выводятся через std::to_chars, дробные с точностью потока, как оператором вывода*/
+class Writer {
+public:
+    /**depth - вложенность, на которой стоит корневое значение: так пишется фрагмент для последующей вставки
+     * через RawValue в документ другой записи*/
+    explicit Writer(std::ostream& out, PrintMode mode = PrintMode::PRETTY, size_t depth = 0);
+    /**Вывод дописывается в строку out без промежуточного потока, Flush ничего не делает.
+     * precision - точность дробных чисел, как у потока, в который потом попадет текст*/
+    Writer(std::string& out, PrintMode mode, size_t depth, int precision);
+    Writer(const Writer&) = delete;
+    Writer& operator=(const Writer&) = delete;
+    /**Оставшийся в буфере вывод сбрасывается в поток*/
+    ~Writer();
+    
+    Writer& StartDict();
+    Writer& EndDict();
+    Writer& StartArray();
+    Writer& EndArray();
+    /**Ключ должен быть больше предыдущего ключа того же словаря*/
+    Writer& Key(std::string_view key);
+    Writer& Value(const Node& node);
+    Writer& Value(std::string_view value);
+    Writer& Value(const std::string& value);
+    Writer& Value(const char* value);
+    Writer& Value(int value);
+    Writer& Value(double value);
+    Writer& Value(bool value);
+    Writer& Value(std::nullptr_t);
+    /**Записать готовый текст JSON как значение, текст не проверяется*/
+    Writer& RawValue(std::string_view text);
+    
+    void Flush();
+    /**Количество записанных символов, включая уже сброшенные в поток*/
+    size_t GetWrittenSize() const;
+
+private:
+    struct Level {
+        bool is_dict = false;
+        bool is_empty = true;
+        bool has_key = false;
+        std::string last_key;
+    };
+    
+    //Без потока вывод остается в строке, на которую ссылается buffer_
+    std::ostream* out_;
+    PrintMode mode_;
+    //Дробные числа выводятся с точностью потока
+    int precision_;
+    size_t base_depth_;
+    std::string own_buffer_;
+    std::string& buffer_;
+    size_t flushed_size_ = 0;
+    //Уровни вложенности переиспользуются вместе с памятью их ключей
+    std::vector<Level> levels_;
+    size_t depth_ = 0;
+    bool has_root_ = false;
+    
+    void BeforeValue();
+    void AfterValue();
+    void StartContainer(bool is_dict);
+    void PrintString(std::string_view str);
+    void PrintLineBreak(size_t depth);
+};
+
+/**Дописать в out строку str как строковое значение JSON: в кавычках и с экранированием.
+ * Результат можно записать через Writer::RawValue без повторного экранирования*/
+void AppendEscapedString(std::string& out, std::string_view str);
 
-void Print(const Document& doc, std::ostream& out);
+/**Значение обходится по ссылкам и записывается через Writer*/
+void Print(const Document& doc, std::ostream& out, PrintMode mode = PrintMode::PRETTY);
 
 }  // namespace json
\ No newline at end of file
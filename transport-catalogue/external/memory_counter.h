@@ -0,0 +1,187 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace TransportGuide::memory {
+
+/**Аллокатор, который считает занятые через него байты.
+ * Нужен для пробных контейнеров, по которым определяется размер узла хеш-таблицы*/
+template<typename T>
+class CountingAllocator {
+public:
+    using value_type = T;
+
+    explicit CountingAllocator(size_t* bytes) noexcept : bytes_(bytes) {}
+
+    template<typename U>
+    CountingAllocator(const CountingAllocator<U>& other) noexcept : bytes_(other.GetCounter()) {}
+
+    T* allocate(size_t n) {
+        *bytes_ += n * sizeof(T);
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* ptr, size_t n) noexcept {
+        *bytes_ -= n * sizeof(T);
+        std::allocator<T>().deallocate(ptr, n);
+    }
+
+    size_t* GetCounter() const noexcept {
+        return bytes_;
+    }
+
+    template<typename U>
+    bool operator==(const CountingAllocator<U>& other) const noexcept {
+        return bytes_ == other.GetCounter();
+    }
+
+    template<typename U>
+    bool operator!=(const CountingAllocator<U>& other) const noexcept {
+        return !(*this == other);
+    }
+
+private:
+    size_t* bytes_;
+};
+
+/**Ресурс памяти, который считает запросы к вышестоящему ресурсу и занятые через него байты*/
+class CountingResource final : public std::pmr::memory_resource {
+public:
+    explicit CountingResource(std::pmr::memory_resource* upstream = std::pmr::new_delete_resource()) noexcept
+            : upstream_(upstream) {}
+
+    size_t GetAllocationsCount() const noexcept {
+        return allocations_count_;
+    }
+
+    size_t GetBytes() const noexcept {
+        return bytes_;
+    }
+
+    size_t GetPeakBytes() const noexcept {
+        return peak_bytes_;
+    }
+
+private:
+    std::pmr::memory_resource* upstream_;
+    size_t allocations_count_ = 0;
+    size_t bytes_ = 0;
+    size_t peak_bytes_ = 0;
+
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        ++allocations_count_;
+        bytes_ += bytes;
+        peak_bytes_ = std::max(peak_bytes_, bytes_);
+        return upstream_->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* ptr, size_t bytes, size_t alignment) override {
+        bytes_ -= bytes;
+        upstream_->deallocate(ptr, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+/**Байты в куче, занятые строкой, короткие строки хранятся в самом объекте и кучу не занимают*/
+template<typename Char, typename Traits, typename Alloc>
+size_t MeasureString(const std::basic_string<Char, Traits, Alloc>& str) {
+    const size_t local_capacity = std::basic_string<Char, Traits, Alloc>().capacity();
+    return str.capacity() > local_capacity ? (str.capacity() + 1) * sizeof(Char) : 0;
+}
+
+/**Байты в куче, занятые буфером вектора, память, которой владеют сами элементы, не учитывается*/
+template<typename T, typename Alloc>
+size_t MeasureVector(const std::vector<T, Alloc>& vector) {
+    return vector.capacity() * sizeof(T);
+}
+
+/**Байты в куче, занятые блоками и картой блоков дека.
+ * Дек заполняется только добавлением в конец, как каталоги: число блоков следует из количества элементов,
+ * а размер карты - из правила ее роста при добавлении блока в конец*/
+template<typename T, typename Alloc>
+size_t MeasureDeque(const std::deque<T, Alloc>& deque) {
+    const size_t block_size = sizeof(T) < 512 ? 512 / sizeof(T) : 1;
+    const size_t block_count = deque.size() / block_size + 1;
+    //Пустой дек держит один блок в середине карты из 8 указателей
+    size_t map_size = 8;
+    size_t start = (map_size - 1) / 2;
+    for (size_t node_count = 1; node_count < block_count; ++node_count) {
+        if (start + node_count + 1 > map_size) {
+            const size_t new_node_count = node_count + 1;
+            if (map_size <= 2 * new_node_count) {
+                map_size += std::max<size_t>(map_size, 1) + 2;
+            }
+            start = (map_size - new_node_count) / 2;
+        }
+    }
+    return block_count * block_size * sizeof(T) + map_size * sizeof(T*);
+}
+
+/**Размер узла хеш-таблицы с ключом Key и значением размера Value.
+ * Определяется один раз вставкой пустого ключа в пробную таблицу: узел зависит от хешера, но не от содержимого,
+ * поэтому измеряемая таблица не копируется*/
+template<typename Key, typename Value, typename Hash, typename Equal>
+size_t GetHashNodeSize() {
+    using Cell = std::aligned_storage_t<sizeof(Value), alignof(Value)>;
+    using Pair = std::pair<const Key, Cell>;
+    static const size_t node_size = [] {
+        size_t bytes = 0;
+        std::unordered_map<Key, Cell, Hash, Equal, CountingAllocator<Pair>> probe(2, Hash{}, Equal{},
+                CountingAllocator<Pair>(&bytes));
+        const size_t buckets_bytes = bytes;
+        probe.emplace(Key{}, Cell{});
+        return bytes - buckets_bytes;
+    }();
+    return node_size;
+}
+
+/**Размер узла хеш-множества с ключом Key*/
+template<typename Key, typename Hash, typename Equal>
+size_t GetHashSetNodeSize() {
+    static const size_t node_size = [] {
+        size_t bytes = 0;
+        std::unordered_set<Key, Hash, Equal, CountingAllocator<Key>> probe(2, Hash{}, Equal{},
+                CountingAllocator<Key>(&bytes));
+        const size_t buckets_bytes = bytes;
+        probe.emplace();
+        return bytes - buckets_bytes;
+    }();
+    return node_size;
+}
+
+/**Байты в куче, занятые массивом корзин, единственная корзина пустой таблицы хранится внутри объекта*/
+inline size_t MeasureBuckets(size_t bucket_count) {
+    return bucket_count > 1 ? bucket_count * sizeof(void*) : 0;
+}
+
+/**Байты в куче, занятые узлами и корзинами хеш-таблицы, память, которой владеют сами значения, не учитывается*/
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+size_t MeasureUnorderedMap(const std::unordered_map<Key, Value, Hash, Equal, Alloc>& map) {
+    return map.size() * GetHashNodeSize<Key, Value, Hash, Equal>() + MeasureBuckets(map.bucket_count());
+}
+
+/**Байты в куче, занятые узлами и корзинами хеш-таблицы с повторяющимися ключами*/
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+size_t MeasureUnorderedMap(const std::unordered_multimap<Key, Value, Hash, Equal, Alloc>& map) {
+    return map.size() * GetHashNodeSize<Key, Value, Hash, Equal>() + MeasureBuckets(map.bucket_count());
+}
+
+/**Байты в куче, занятые узлами и корзинами хеш-множества*/
+template<typename Key, typename Hash, typename Equal, typename Alloc>
+size_t MeasureUnorderedSet(const std::unordered_set<Key, Hash, Equal, Alloc>& set) {
+    return set.size() * GetHashSetNodeSize<Key, Hash, Equal>() + MeasureBuckets(set.bucket_count());
+}
+
+}
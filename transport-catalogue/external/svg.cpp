@@ -1,6 +1,7 @@
 #include <algorithm>
-#include <regex>
+#include <charconv>
 #include <iomanip>
+#include <sstream>
 #include "svg.h"
 
 namespace TransportGuide::svg {
@@ -32,6 +33,46 @@ std::ostream& operator<<(std::ostream &out, const Color& color) {
     return out;
 }
 
+namespace {
+
+void AppendColorComponent(std::string& buffer, uint8_t component) {
+    char chars[4];
+    auto [end, error] = std::to_chars(std::begin(chars), std::end(chars), component);
+    buffer.append(chars, end);
+}
+
+}
+
+//Текст совпадает с RenderColorAttribute, прозрачность выводится с точностью потока по умолчанию
+std::string_view GetColorText(const Color& color, std::string& buffer) {
+    if (const auto* str = std::get_if<std::string>(&color)) { return *str; }
+    buffer.clear();
+    if (const auto* rgb = std::get_if<Rgb>(&color)) {
+        buffer += "rgb("sv;
+        AppendColorComponent(buffer, rgb->red);
+        buffer += ',';
+        AppendColorComponent(buffer, rgb->green);
+        buffer += ',';
+        AppendColorComponent(buffer, rgb->blue);
+        buffer += ')';
+    }
+    else if (const auto* rgba = std::get_if<Rgba>(&color)) {
+        buffer += "rgba("sv;
+        AppendColorComponent(buffer, rgba->red);
+        buffer += ',';
+        AppendColorComponent(buffer, rgba->green);
+        buffer += ',';
+        AppendColorComponent(buffer, rgba->blue);
+        buffer += ',';
+        char chars[32];
+        auto [end, error] = std::to_chars(std::begin(chars), std::end(chars), rgba->opacity,
+                std::chars_format::general, 6);
+        buffer.append(chars, end);
+        buffer += ')';
+    }
+    return buffer;
+}
+
 //endregion
 
 //region --------- Enums Stroke ---------
@@ -63,12 +104,14 @@ std::ostream& operator<<(std::ostream& out, const StrokeLineJoin& stroke_line_jo
 //region --------- Object ---------
 
 void Object::Render(const RenderContext& context) const {
-    context.RenderIndent();
-    
-    // Делегируем вывод тега своим подклассам
-    RenderObject(context);
-    
-    context.out << std::endl;
+    //Тег собирается в строку и выводится в поток одной записью, поток не сбрасывается
+    std::string text;
+    {
+        Writer writer(text, static_cast<int>(context.out.precision()));
+        writer.SetIndent(context.indent);
+        Write(writer);
+    }
+    context.out << text;
 }
 
 //endregion
@@ -85,12 +128,14 @@ Circle& Circle::SetRadius(double radius)  {
     return *this;
 }
 
-void Circle::RenderObject(const RenderContext& context) const {
-    auto& out = context.out;
-    out << "<circle cx=\""sv << center_.x << "\" cy=\""sv << center_.y << "\" "sv;
-    out << "r=\""sv << radius_ << "\""sv;
-    RenderAttrs(out);
-    out << "/>"sv;
+size_t Circle::GetMemoryUsage() const {
+    return sizeof(Circle) + GetAttrsMemoryUsage();
+}
+
+void Circle::Write(Writer& writer) const {
+    std::string fill_buffer;
+    std::string stroke_buffer;
+    writer.WriteCircle(center_, radius_, GetPathAttrs(fill_buffer, stroke_buffer));
 }
 //endregion
 
@@ -101,20 +146,18 @@ Polyline& Polyline::AddPoint(Point point) {
     return *this;
 }
 
-void Polyline::RenderObject(const RenderContext& context) const {
-    auto& out = context.out;
-    out << "<polyline points=\""sv;
-    bool is_not_first_point = false;
+size_t Polyline::GetMemoryUsage() const {
+    return sizeof(Polyline) + GetAttrsMemoryUsage() + memory::MeasureVector(pointers_);
+}
+
+void Polyline::Write(Writer& writer) const {
+    writer.StartPolyline();
     for (const auto& p : pointers_) {
-        if (is_not_first_point) {
-            out << " ";
-        }
-        is_not_first_point = true;
-        out << p.x << "," << p.y;
+        writer.AddPoint(p);
     }
-    out << "\"";
-    RenderAttrs(out);
-    out << "/>"sv;
+    std::string fill_buffer;
+    std::string stroke_buffer;
+    writer.EndPolyline(GetPathAttrs(fill_buffer, stroke_buffer));
 }
 
 //endregion
@@ -147,24 +190,20 @@ Text& Text::SetFontWeight(std::string font_weight) {
 }
 
 Text& Text::SetData(std::string data) {
-    data = std::regex_replace(data, std::regex("&"), "&amp;");
-    data = std::regex_replace(data, std::regex("\""), "&quot;");
-    data = std::regex_replace(data, std::regex("\'"), "&apos;");
-    data = std::regex_replace(data, std::regex("<"), "&lt;");
-    data = std::regex_replace(data, std::regex(">"), "&gt;");
     data_ = std::forward<std::string>(data);
     return *this;
 }
 
-void Text::RenderObject(const RenderContext& context) const {
-    auto& out = context.out;
-    out << "<text";
-    RenderAttrs(out);
-    out << " x=\"" << pos_.x << "\" y=\"" << pos_.y << "\" dx=\"" << offset_.x << "\" dy=\"" << offset_.y
-            << "\" font-size=\"" << size_ << "\"";
-    if (!font_family_.empty()) { out << " font-family=\"" << font_family_ << "\""; }
-    if (!font_weight_.empty()) { out << " font-weight=\"" << font_weight_ << "\""; }
-    out << ">" << data_ << "</text>"sv;
+size_t Text::GetMemoryUsage() const {
+    return sizeof(Text) + GetAttrsMemoryUsage() + memory::MeasureString(font_family_)
+            + memory::MeasureString(font_weight_) + memory::MeasureString(data_);
+}
+
+void Text::Write(Writer& writer) const {
+    std::string fill_buffer;
+    std::string stroke_buffer;
+    writer.WriteText(pos_, offset_, size_, font_family_, font_weight_, data_,
+            GetPathAttrs(fill_buffer, stroke_buffer));
 }
 
 //endregion
@@ -177,13 +216,222 @@ void Document::AddPtr(std::unique_ptr<Object>&& obj) {
 }
 
 void Document::Render(std::ostream& out) const {
-    out << "<?xml version=\"1.0\" encoding=\"UTF-8\" ?>\n";
-    out << "<svg xmlns=\"http://www.w3.org/2000/svg\" version=\"1.1\">\n";
-    RenderContext ctx(out, 2, 2);
+    Writer writer(out);
+    writer.StartDocument();
     for (auto& ptr : objects_) {
-        ptr->Render(ctx);
+        ptr->Write(writer);
+    }
+    writer.EndDocument();
+}
+
+size_t Document::GetMemoryUsage() const {
+    size_t bytes = memory::MeasureVector(objects_);
+    for (const auto& ptr : objects_) {
+        bytes += ptr->GetMemoryUsage();
+    }
+    return bytes;
+}
+
+//endregion
+
+//region --------- Writer ---------
+
+namespace {
+
+std::string_view GetStrokeLineCapName(StrokeLineCap stroke_line_cap) {
+    switch (stroke_line_cap) {
+        case StrokeLineCap::BUTT: return "butt"sv;
+        case StrokeLineCap::ROUND: return "round"sv;
+        case StrokeLineCap::SQUARE: return "square"sv;
+    }
+    return {};
+}
+
+std::string_view GetStrokeLineJoinName(StrokeLineJoin stroke_line_join) {
+    switch (stroke_line_join) {
+        case StrokeLineJoin::ARCS: return "arcs"sv;
+        case StrokeLineJoin::BEVEL: return "bevel"sv;
+        case StrokeLineJoin::MITER: return "miter"sv;
+        case StrokeLineJoin::MITER_CLIP: return "miter-clip"sv;
+        case StrokeLineJoin::ROUND: return "round"sv;
+    }
+    return {};
+}
+
+}
+
+Writer::Writer(std::ostream& out) : out_(&out), buffer_(own_buffer_), precision_(static_cast<int>(out.precision())) {
+}
+
+Writer::Writer(std::string& output, int precision) : buffer_(output), precision_(precision) {
+}
+
+Writer::~Writer() {
+    Flush();
+}
+
+Writer& Writer::StartDocument() {
+    buffer_ += "<?xml version=\"1.0\" encoding=\"UTF-8\" ?>\n"sv;
+    buffer_ += "<svg xmlns=\"http://www.w3.org/2000/svg\" version=\"1.1\">\n"sv;
+    return *this;
+}
+
+Writer& Writer::EndDocument() {
+    buffer_ += "</svg>"sv;
+    return *this;
+}
+
+Writer& Writer::SetIndent(int indent) {
+    indent_ = indent;
+    return *this;
+}
+
+Writer& Writer::WriteCircle(Point center, double radius, const PathAttrs& attrs) {
+    StartElement();
+    buffer_ += "<circle cx=\""sv;
+    PrintNumber(center.x);
+    buffer_ += "\" cy=\""sv;
+    PrintNumber(center.y);
+    buffer_ += "\" r=\""sv;
+    PrintNumber(radius);
+    buffer_ += '\"';
+    PrintAttrs(attrs);
+    buffer_ += "/>"sv;
+    EndElement();
+    return *this;
+}
+
+Writer& Writer::StartPolyline() {
+    StartElement();
+    buffer_ += "<polyline points=\""sv;
+    is_first_point_ = true;
+    return *this;
+}
+
+Writer& Writer::AddPoint(Point point) {
+    if (!is_first_point_) { buffer_ += ' '; }
+    is_first_point_ = false;
+    PrintNumber(point.x);
+    buffer_ += ',';
+    PrintNumber(point.y);
+    return *this;
+}
+
+Writer& Writer::EndPolyline(const PathAttrs& attrs) {
+    buffer_ += '\"';
+    PrintAttrs(attrs);
+    buffer_ += "/>"sv;
+    EndElement();
+    return *this;
+}
+
+Writer& Writer::WriteText(Point position, Point offset, uint32_t font_size, std::string_view font_family,
+        std::string_view font_weight, std::string_view data, const PathAttrs& attrs) {
+    StartElement();
+    buffer_ += "<text"sv;
+    PrintAttrs(attrs);
+    buffer_ += " x=\""sv;
+    PrintNumber(position.x);
+    buffer_ += "\" y=\""sv;
+    PrintNumber(position.y);
+    buffer_ += "\" dx=\""sv;
+    PrintNumber(offset.x);
+    buffer_ += "\" dy=\""sv;
+    PrintNumber(offset.y);
+    buffer_ += "\" font-size=\""sv;
+    PrintNumber(font_size);
+    buffer_ += '\"';
+    if (!font_family.empty()) {
+        buffer_ += " font-family=\""sv;
+        buffer_ += font_family;
+        buffer_ += '\"';
+    }
+    if (!font_weight.empty()) {
+        buffer_ += " font-weight=\""sv;
+        buffer_ += font_weight;
+        buffer_ += '\"';
+    }
+    buffer_ += '>';
+    PrintEscapedText(data);
+    buffer_ += "</text>"sv;
+    EndElement();
+    return *this;
+}
+
+void Writer::Flush() {
+    if (out_ == nullptr) { return; }
+    out_->write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+    buffer_.clear();
+}
+
+void Writer::StartElement() {
+    buffer_.append(static_cast<size_t>(indent_), ' ');
+}
+
+void Writer::EndElement() {
+    buffer_ += '\n';
+    if (out_ != nullptr && buffer_.size() >= SVG_FLUSH_SIZE) { Flush(); }
+}
+
+void Writer::PrintAttrs(const PathAttrs& attrs) {
+    if (!attrs.fill_color.empty()) {
+        buffer_ += " fill=\""sv;
+        buffer_ += attrs.fill_color;
+        buffer_ += '\"';
+    }
+    if (!attrs.stroke_color.empty()) {
+        buffer_ += " stroke=\""sv;
+        buffer_ += attrs.stroke_color;
+        buffer_ += '\"';
+    }
+    if (attrs.stroke_width) {
+        buffer_ += " stroke-width=\""sv;
+        PrintNumber(*attrs.stroke_width);
+        buffer_ += '\"';
+    }
+    if (attrs.stroke_line_cap) {
+        buffer_ += " stroke-linecap=\""sv;
+        buffer_ += GetStrokeLineCapName(*attrs.stroke_line_cap);
+        buffer_ += '\"';
+    }
+    if (attrs.stroke_line_join) {
+        buffer_ += " stroke-linejoin=\""sv;
+        buffer_ += GetStrokeLineJoinName(*attrs.stroke_line_join);
+        buffer_ += '\"';
+    }
+}
+
+//Формат general с точностью потока совпадает с выводом double через operator<<
+void Writer::PrintNumber(double value) {
+    char chars[32];
+    auto [end, error] = std::to_chars(std::begin(chars), std::end(chars), value, std::chars_format::general,
+            precision_);
+    buffer_.append(chars, end);
+}
+
+void Writer::PrintNumber(uint32_t value) {
+    char chars[16];
+    auto [end, error] = std::to_chars(std::begin(chars), std::end(chars), value);
+    buffer_.append(chars, end);
+}
+
+void Writer::PrintEscapedText(std::string_view text) {
+    size_t run_begin = 0;
+    for (size_t i = 0; i < text.size(); ++i) {
+        std::string_view escaped;
+        switch (text[i]) {
+            case '&': escaped = "&amp;"sv; break;
+            case '\"': escaped = "&quot;"sv; break;
+            case '\'': escaped = "&apos;"sv; break;
+            case '<': escaped = "&lt;"sv; break;
+            case '>': escaped = "&gt;"sv; break;
+            default: continue;
+        }
+        buffer_.append(text.data() + run_begin, i - run_begin);
+        buffer_ += escaped;
+        run_begin = i + 1;
     }
-    out << "</svg>";
+    buffer_.append(text.data() + run_begin, text.size() - run_begin);
 }
 
 //endregion
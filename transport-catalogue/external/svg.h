@@ -4,14 +4,18 @@
 #include <iostream>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 #include <optional>
 #include <variant>
+#include "memory_counter.h"
 
 namespace TransportGuide::svg {
 using namespace std::literals;
 class Object;
+class Writer;
+struct PathAttrs;
 
 struct Rgb {
     Rgb() = default;
@@ -44,6 +48,10 @@ struct RenderColorAttribute {
 
 std::ostream& operator<< (std::ostream& out, const Color& color);
 
+/**Текст значения атрибута цвета. Строковый цвет возвращается без копирования, rgb и rgba записываются в buffer,
+ * для отсутствующего цвета возвращается пустая строка*/
+std::string_view GetColorText(const Color& color, std::string& buffer);
+
 
 enum class StrokeLineCap {
     BUTT, ROUND, SQUARE
@@ -58,6 +66,17 @@ enum class StrokeLineJoin {
 std::ostream& operator<<(std::ostream& out, const StrokeLineJoin& stroke_line_join);
 
 
+/**Атрибуты обводки и заливки для потоковой записи, строки не копируются.
+ * Цвет задается текстом значения атрибута, пустой цвет не выводится*/
+struct PathAttrs {
+    std::string_view fill_color;
+    std::string_view stroke_color;
+    std::optional<double> stroke_width;
+    std::optional<StrokeLineCap> stroke_line_cap;
+    std::optional<StrokeLineJoin> stroke_line_join;
+};
+
+
 template<typename T>
 class PathProps {
 public:
@@ -94,22 +113,27 @@ public:
 protected:
     ~PathProps() = default;
     
-    void RenderAttrs(std::ostream& out) const {
-        if (!std::holds_alternative<std::monostate>(fill_color_)) {
-            out << " fill=\""sv << std::visit(RenderColorAttribute {}, fill_color_) << "\""sv;
-        }
-        if (!std::holds_alternative<std::monostate>(stroke_color_)) {
-            out << " stroke=\""sv << std::visit(RenderColorAttribute {}, stroke_color_) << "\""sv;
-        }
-        if (stroke_width_) {
-            out << " stroke-width=\""sv << *stroke_width_ << "\""sv;
-        }
-        if (stroke_line_cap_) {
-            out << " stroke-linecap=\""sv << *stroke_line_cap_ << "\""sv;
+    /**Атрибуты для Writer, текст цветов rgb и rgba записывается в буферы и живет, пока живут они*/
+    PathAttrs GetPathAttrs(std::string& fill_buffer, std::string& stroke_buffer) const {
+        PathAttrs attrs;
+        attrs.fill_color = GetColorText(fill_color_, fill_buffer);
+        attrs.stroke_color = GetColorText(stroke_color_, stroke_buffer);
+        attrs.stroke_width = stroke_width_;
+        attrs.stroke_line_cap = stroke_line_cap_;
+        attrs.stroke_line_join = stroke_line_join_;
+        return attrs;
+    }
+    
+    /**Байты в куче, занятые строковыми цветами*/
+    size_t GetAttrsMemoryUsage() const {
+        size_t bytes = 0;
+        if (const auto* color = std::get_if<std::string>(&fill_color_)) {
+            bytes += memory::MeasureString(*color);
         }
-        if (stroke_line_join_) {
-            out << " stroke-linejoin=\""sv << *stroke_line_join_ << "\""sv;
+        if (const auto* color = std::get_if<std::string>(&stroke_color_)) {
+            bytes += memory::MeasureString(*color);
         }
+        return bytes;
     }
 
 private:
@@ -184,16 +208,17 @@ struct RenderContext {
 /**
  * Абстрактный базовый класс Object служит для унифицированного хранения
  * конкретных тегов SVG-документа
- * Реализует паттерн "Шаблонный метод" для вывода содержимого тега
+ * Тег выводится через Writer, Render выводит один тег с отступом контекста
  */
 class   Object {
 public:
     void Render(const RenderContext& context) const;
+    /**Записать тег вместе с отступом и переводом строки*/
+    virtual void Write(Writer& writer) const = 0;
+    /**Байты в куче, занятые объектом вместе с его собственным блоком*/
+    virtual size_t GetMemoryUsage() const = 0;
     
     virtual ~Object() = default;
-
-private:
-    virtual void RenderObject(const RenderContext& context) const = 0;
 };
 
 
@@ -205,10 +230,11 @@ class Circle final : public Object, public PathProps<Circle> {
 public:
     Circle& SetCenter(Point center);
     Circle& SetRadius(double radius);
+    
+    void Write(Writer& writer) const override;
+    size_t GetMemoryUsage() const override;
 
 private:
-    void RenderObject(const RenderContext& context) const override;
-    
     Point center_ = {0, 0};
     double radius_ = 1.0;
 };
@@ -222,9 +248,11 @@ class Polyline final : public Object, public PathProps<Polyline> {
 public:
     // Добавляет очередную вершину к ломаной линии
     Polyline& AddPoint(Point point);
+    
+    void Write(Writer& writer) const override;
+    size_t GetMemoryUsage() const override;
 
 private:
-    void RenderObject(const RenderContext& context) const override;
     std::vector<Point> pointers_;
 };
 
@@ -250,12 +278,13 @@ public:
     // Задаёт толщину шрифта (атрибут font-weight)
     Text& SetFontWeight(std::string font_weight);
     
-    // Задаёт текстовое содержимое объекта (отображается внутри тега text)
+    // Задаёт текстовое содержимое объекта (отображается внутри тега text), спецсимволы XML заменяются при выводе
     Text& SetData(std::string data);
+    
+    void Write(Writer& writer) const override;
+    size_t GetMemoryUsage() const override;
 
 private:
-    void RenderObject(const RenderContext& context) const override;
-    
     Point pos_ = {0.0, 0.0};
     Point offset_ = {0.0, 0.0};
     uint32_t size_ = 1;
@@ -272,8 +301,58 @@ public:
     /** Добавляет в svg-документ объект-наследник svg::Object*/
     void AddPtr(std::unique_ptr<Object>&& obj) override;
     
-    // Выводит в ostream svg-представление документа
+    // Выводит в ostream svg-представление документа, текст отправляется в поток частями без сброса потока
     void Render(std::ostream& out) const;
+    
+    /**Байты в куче, занятые документом и всеми его объектами*/
+    size_t GetMemoryUsage() const;
+};
+
+
+//Размер буфера, при превышении которого Writer отправляет текст в поток
+inline const size_t SVG_FLUSH_SIZE = 64 * 1024;
+
+/**Потоковая запись svg-документа без построения объектов.
+ * Элементы сразу выводятся в буфер в том же виде, что и у Document::Render, числа форматируются через to_chars
+ * с точностью потока. При записи в поток буфер отправляется частями и в деструкторе,
+ * при записи в строку текст дописывается прямо в нее*/
+class Writer {
+public:
+    explicit Writer(std::ostream& out);
+    explicit Writer(std::string& output, int precision = 6);
+    Writer(const Writer&) = delete;
+    Writer& operator=(const Writer&) = delete;
+    ~Writer();
+    
+    Writer& StartDocument();
+    Writer& EndDocument();
+    /**Отступ следующих тегов, по умолчанию отступ тегов внутри svg*/
+    Writer& SetIndent(int indent);
+    Writer& WriteCircle(Point center, double radius, const PathAttrs& attrs);
+    /**Ломаная выводится по вершинам: StartPolyline, AddPoint для каждой вершины, EndPolyline*/
+    Writer& StartPolyline();
+    Writer& AddPoint(Point point);
+    Writer& EndPolyline(const PathAttrs& attrs);
+    /**data - текст без экранирования, спецсимволы XML заменяются при записи*/
+    Writer& WriteText(Point position, Point offset, uint32_t font_size, std::string_view font_family,
+            std::string_view font_weight, std::string_view data, const PathAttrs& attrs);
+    
+    void Flush();
+
+private:
+    std::ostream* out_ = nullptr;
+    std::string own_buffer_;
+    std::string& buffer_;
+    int precision_;
+    int indent_ = 2;
+    bool is_first_point_ = true;
+    
+    void StartElement();
+    void EndElement();
+    void PrintAttrs(const PathAttrs& attrs);
+    void PrintNumber(double value);
+    void PrintNumber(uint32_t value);
+    void PrintEscapedText(std::string_view text);
 };
 
 }  // namespace svg
\ No newline at end of file
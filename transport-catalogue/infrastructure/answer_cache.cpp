@@ -0,0 +1,82 @@
+#include <algorithm>
+#include <charconv>
+#include <functional>
+#include "answer_cache.h"
+
+namespace TransportGuide::IoRequests {
+
+AnswerCache::AnswerCache(size_t max_bytes) : max_bytes_(max_bytes), seen_(SEEN_SLOT_COUNT, 0) {}
+
+const std::string& AnswerCache::MakeKey(RequestType type, std::initializer_list<std::string_view> parameters) {
+    //Параметры записываются с длиной, чтобы разные наборы имен не склеивались в один ключ
+    key_.assign(1, static_cast<char>(type));
+    for (std::string_view parameter : parameters) {
+        key_ += std::to_string(parameter.size());
+        key_ += ':';
+        key_ += parameter;
+    }
+    return key_;
+}
+
+bool AnswerCache::TryWrite(const std::string& key, int request_id, json::Writer& writer) {
+    ++counters_.requests;
+    auto it = index_.find(key);
+    if (it == index_.end()) { return false; }
+    ++counters_.hits;
+    entries_.splice(entries_.begin(), entries_, it->second);
+    
+    const Entry& entry = *it->second;
+    char id_buffer[16];
+    auto [id_end, error] = std::to_chars(std::begin(id_buffer), std::end(id_buffer), request_id);
+    answer_.assign(entry.answer, 0, entry.id_begin).append(id_buffer, id_end)
+           .append(entry.answer, entry.id_end, std::string::npos);
+    writer.RawValue(answer_);
+    return true;
+}
+
+bool AnswerCache::Admit(const std::string& key) {
+    //Ноль - пустая ячейка, поэтому хеш ключа не бывает нулевым
+    const size_t hash = std::hash<std::string>{}(key) | 1;
+    size_t& slot = seen_[hash % SEEN_SLOT_COUNT];
+    if (slot == hash) { return true; }
+    slot = hash;
+    return false;
+}
+
+void AnswerCache::Add(const std::string& key, std::string_view answer, size_t id_begin, size_t id_end) {
+    if (index_.count(key)) { return; }
+    Entry entry{key, std::string(answer), id_begin, id_end};
+    const size_t entry_bytes = GetEntryBytes(entry);
+    if (entry_bytes > max_bytes_) { return; }
+    
+    while (bytes_ + entry_bytes > max_bytes_) {
+        bytes_ -= GetEntryBytes(entries_.back());
+        index_.erase(entries_.back().key);
+        entries_.pop_back();
+    }
+    entries_.push_front(std::move(entry));
+    index_.emplace(entries_.front().key, entries_.begin());
+    bytes_ += entry_bytes;
+}
+
+void AnswerCache::Clear() {
+    index_.clear();
+    entries_.clear();
+    std::fill(seen_.begin(), seen_.end(), 0);
+    bytes_ = 0;
+    counters_ = {};
+}
+
+const AnswerCache::Counters& AnswerCache::GetCounters() const {
+    return counters_;
+}
+
+size_t AnswerCache::GetBytes() const {
+    return bytes_;
+}
+
+size_t AnswerCache::GetEntryBytes(const Entry& entry) {
+    return entry.key.size() + entry.answer.size();
+}
+
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <initializer_list>
+#include <list>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "json_requests.h"
+#include "../external/json.h"
+
+namespace TransportGuide::IoRequests {
+
+/**Сериализованные ответы на повторяющиеся запросы одного пакета stat_requests.
+ * Ключ - тип запроса и его параметры, id в ключ не входит. Ответ хранится текстом вместе с границами значения
+ * request_id, при повторе вместо него записывается id нового запроса.
+ * Ответ сохраняется только на втором появлении ключа: запросы без повторов пишутся сразу в вывод.
+ * Объем кеша ограничен max_bytes, при переполнении вытесняются давно не запрошенные ответы.
+ * Ответы верны, пока не меняется каталог, поэтому кеш очищается перед каждым пакетом*/
+class AnswerCache final {
+public:
+    struct Counters {
+        size_t requests = 0;
+        size_t hits = 0;
+    };
+    
+    static constexpr size_t DEFAULT_MAX_BYTES = 1 << 20;
+    
+    explicit AnswerCache(size_t max_bytes = DEFAULT_MAX_BYTES);
+    
+    /**Собрать ключ запроса во внутренний буфер, ссылка действительна до следующего вызова*/
+    const std::string& MakeKey(RequestType type, std::initializer_list<std::string_view> parameters);
+    /**Записать сохраненный ответ с идентификатором request_id, false - ответа по ключу нет*/
+    bool TryWrite(const std::string& key, int request_id, json::Writer& writer);
+    /**Отметить промах по ключу, true - ключ уже встречался и его ответ стоит сохранить через Add*/
+    bool Admit(const std::string& key);
+    /**Сохранить ответ, значение request_id занимает в нем символы [id_begin, id_end)*/
+    void Add(const std::string& key, std::string_view answer, size_t id_begin, size_t id_end);
+    void Clear();
+    const Counters& GetCounters() const;
+    /**Байты ключей и текстов сохраненных ответов*/
+    size_t GetBytes() const;
+
+private:
+    struct Entry {
+        std::string key;
+        std::string answer;
+        size_t id_begin;
+        size_t id_end;
+    };
+    //Число запомненных ключей, встреченных один раз: фиксированная таблица хешей, коллизия только вытесняет ключ
+    static constexpr size_t SEEN_SLOT_COUNT = 4096;
+    
+    size_t max_bytes_;
+    size_t bytes_ = 0;
+    //Ответы от недавно запрошенных к давно запрошенным, в словаре ключи ссылаются на строки записей
+    std::list<Entry> entries_;
+    std::unordered_map<std::string_view, std::list<Entry>::iterator> index_;
+    std::vector<size_t> seen_;
+    Counters counters_;
+    //Буферы ключа и собираемого ответа переиспользуются между запросами
+    std::string key_;
+    std::string answer_;
+    
+    static size_t GetEntryBytes(const Entry& entry);
+};
+
+}
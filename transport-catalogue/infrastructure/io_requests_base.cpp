@@ -1,4 +1,3 @@
-#include <sstream>
 #include "io_requests_base.h"
 
 
@@ -8,9 +7,14 @@ TransportGuide::IoRequests::IoBase::IoBase(TransportGuide::BusinessLogic::Transp
 TransportGuide::IoRequests::RenderBase::RenderBase(TransportGuide::renderer::MapRenderer& map_renderer)
                                                                                     : map_renderer_(map_renderer) {}
 
-std::string TransportGuide::IoRequests::RenderBase::Render() {
-    std::ostringstream out;
-    map_renderer_.CreateDocument();
-    map_renderer_.Render(out);
-    return out.str();
+const std::string& TransportGuide::IoRequests::RenderBase::Render() {
+    return map_renderer_.GetSvg();
+}
+
+const std::string& TransportGuide::IoRequests::RenderBase::RenderJsonString() {
+    return map_renderer_.GetJsonSvg();
+}
+
+std::string TransportGuide::IoRequests::RenderBase::RenderViewport(const TransportGuide::Domain::MapViewport& viewport) {
+    return map_renderer_.RenderViewport(viewport);
 }
@@ -22,7 +22,12 @@ struct RenderBase {
 protected:
     explicit RenderBase(renderer::MapRenderer& map_renderer);
     virtual ~RenderBase() = default;
-    virtual std::string Render();
+    /**Карта в формате svg, повторные запросы без изменения каталога и настроек не перестраивают ее*/
+    virtual const std::string& Render();
+    /**Карта в виде строкового значения JSON*/
+    virtual const std::string& RenderJsonString();
+    /**Часть карты, попавшая в окно просмотра, строится при каждом запросе*/
+    virtual std::string RenderViewport(const Domain::MapViewport& viewport);
 
 protected:
     renderer::MapRenderer& map_renderer_;
@@ -1,6 +1,8 @@
 #include <memory>
 #include <algorithm>
 #include <cassert>
+#include <functional>
+#include <iterator>
 #include "json_reader.h"
 
 
@@ -14,7 +16,10 @@ JsonReader::JsonReader(renderer::MapRenderer& map_renderer,
 }
 
 void JsonReader::PreloadDocument() {
-    document_ = json::Load(input_stream_);
+    //Документ нужен целиком, поэтому текст читается в память одним блоком,
+    //от json::STRUCTURAL_INDEX_THRESHOLD байт он разбирается в два этапа по структурному индексу
+    const std::string text{std::istreambuf_iterator<char>(input_stream_), std::istreambuf_iterator<char>()};
+    document_ = json::Load(std::string_view(text));
 }
 
 void JsonReader::LoadData() {
@@ -27,33 +32,285 @@ void JsonReader::LoadData() {
     
     std::vector<const json::Node*> stop_requests;
     std::vector<const json::Node*> bus_requests;
+    std::vector<const json::Node*> remove_stop_requests;
+    std::vector<const json::Node*> remove_bus_requests;
     
     for (const json::Node& node : base_requests_node.AsArray()) {
-        if (node.IsMap() && node.AsMap().count("type")) {
-            const json::Node& type_node = node.AsMap().at("type");
-            if (type_node == "Stop"s) {
+        switch (GetBaseRequestType(node)) {
+            case RequestType::STOP:
                 stop_requests.push_back(&node);
-            } else if (type_node == "Bus"s) {
+                break;
+            case RequestType::BUS:
                 bus_requests.push_back(&node);
-            } else if (type_node.IsNull()) {
-                continue;
-            } else {
-                throw std::logic_error("Node key \"type\" must be count value \"Stop\" or \"Bus\"."s);
+                break;
+            case RequestType::REMOVE_STOP:
+                remove_stop_requests.push_back(&node);
+                break;
+            case RequestType::REMOVE_BUS:
+                remove_bus_requests.push_back(&node);
+                break;
+            default:
+                break;
+        }
+    }
+    size_t distance_count = 0;
+    for (const json::Node* node_ptr : stop_requests) {
+        const json::Dict& node_dict = node_ptr->AsMap();
+        if (auto it = node_dict.find("road_distances"s); it != node_dict.end() && it->second.IsMap()) {
+            distance_count += it->second.AsMap().size();
+        }
+    }
+    
+    //При обновлении загруженной базы маршрутизатор строится заново, по прежним настройкам, если новые не заданы
+    std::optional<Domain::RoutingSettings> routing_settings = GetLoadedRoutingSettings();
+    
+    BusinessLogic::TransportCatalogueBuilder builder(catalogue_);
+    builder.Reserve(stop_requests.size(), bus_requests.size(), distance_count);
+    std::for_each(stop_requests.begin(), stop_requests.end(), [this, &builder](const json::Node* node_ptr) {
+        AddStopByNode(*node_ptr, builder);
+    });
+    std::for_each(bus_requests.begin(), bus_requests.end(), [this, &builder](const json::Node* node_ptr) {
+        AddBusByNode(*node_ptr, builder);
+    });
+    
+    std::vector<std::string_view> removed_bus_names;
+    std::vector<std::string_view> removed_stop_names;
+    for (const json::Node* node_ptr : remove_bus_requests) {
+        removed_bus_names.push_back(DecodeRemoveRequest(*node_ptr).name);
+    }
+    for (const json::Node* node_ptr : remove_stop_requests) {
+        removed_stop_names.push_back(DecodeRemoveRequest(*node_ptr).name);
+    }
+    FinishLoadData(builder, removed_bus_names, removed_stop_names, routing_settings);
+}
+
+/**Раскладывает события разбора документа: каждая запись раздела-массива корня собирается в отдельный Node и сразу
+ * передается в обработчик записей, остальные разделы корня собираются целиком и становятся документом читателя*/
+class JsonReader::SectionHandler final : public json::Handler {
+public:
+    using RecordCallback = std::function<void(const json::Node&)>;
+    using StartCallback = std::function<void()>;
+    
+    /**on_records_start вызывается перед первой записью, к этому моменту в документе есть разделы,
+     * которые в тексте стоят раньше раздела записей. Если какого-то из required_sections среди них нет,
+     * записи копируются и обрабатываются после разбора всего документа*/
+    SectionHandler(JsonReader& reader, std::string_view records_key, RecordCallback on_record,
+            StartCallback on_records_start = {}, std::vector<std::string_view> required_sections = {})
+            : reader_(reader), records_key_(records_key), on_record_(std::move(on_record)),
+              on_records_start_(std::move(on_records_start)), required_sections_(std::move(required_sections)) {}
+    
+    void Null() override {
+        OnValue([](json::Handler& handler) { handler.Null(); });
+    }
+    
+    void Bool(bool value) override {
+        OnValue([value](json::Handler& handler) { handler.Bool(value); });
+    }
+    
+    void Int(int value) override {
+        OnValue([value](json::Handler& handler) { handler.Int(value); });
+    }
+    
+    void Double(double value) override {
+        OnValue([value](json::Handler& handler) { handler.Double(value); });
+    }
+    
+    void String(std::string_view value) override {
+        OnValue([value](json::Handler& handler) { handler.String(value); });
+    }
+    
+    void StartArray() override {
+        if (!IsForwarding() && depth_ == ROOT_DEPTH && key_ == records_key_) {
+            depth_ = RECORDS_DEPTH;
+            return;
+        }
+        OnValue([](json::Handler& handler) { handler.StartArray(); });
+    }
+    
+    void EndArray() override {
+        if (!IsForwarding() && depth_ == RECORDS_DEPTH) {
+            depth_ = ROOT_DEPTH;
+            return;
+        }
+        OnValue([](json::Handler& handler) { handler.EndArray(); });
+    }
+    
+    void StartDict() override {
+        if (!IsForwarding() && depth_ == 0) {
+            depth_ = ROOT_DEPTH;
+            return;
+        }
+        OnValue([](json::Handler& handler) { handler.StartDict(); });
+    }
+    
+    void Key(std::string_view key) override {
+        if (!IsForwarding() && depth_ == ROOT_DEPTH) {
+            key_ = key;
+            return;
+        }
+        OnValue([key](json::Handler& handler) { handler.Key(key); });
+    }
+    
+    void EndDict() override {
+        if (!IsForwarding() && depth_ == ROOT_DEPTH) {
+            depth_ = 0;
+            reader_.document_ = json::Document(json::Node(std::move(root_dict_)));
+            //Отложенные записи: теперь в документе есть все разделы
+            if (!pending_records_.empty()) {
+                if (on_records_start_) { on_records_start_(); }
+                for (const json::Node& node : pending_records_) {
+                    ++record_count_;
+                    on_record_(node);
+                }
+                pending_records_.clear();
             }
+            return;
+        }
+        OnValue([](json::Handler& handler) { handler.EndDict(); });
+    }
+    
+    /**В разделе записей была хотя бы одна запись*/
+    bool HasRecords() const {
+        return record_count_ > 0;
+    }
+
+private:
+    static const int ROOT_DEPTH = 1;
+    static const int RECORDS_DEPTH = 2;
+    
+    JsonReader& reader_;
+    std::string_view records_key_;
+    RecordCallback on_record_;
+    StartCallback on_records_start_;
+    std::vector<std::string_view> required_sections_;
+    //Записи, прочитанные раньше нужных разделов
+    std::vector<json::Node> pending_records_;
+    int depth_ = 0;
+    size_t record_count_ = 0;
+    std::string key_;
+    json::Dict root_dict_;
+    json::NodeHandler record_;
+    json::NodeHandler value_;
+    
+    bool HasRequiredSections() const {
+        return std::all_of(required_sections_.begin(), required_sections_.end(), [this](std::string_view key) {
+            return root_dict_.find(key) != root_dict_.end();
+        });
+    }
+    
+    //Идет сборка записи или раздела, события передаются в собирающий обработчик
+    bool IsForwarding() const {
+        return record_.GetDepth() > 0 || value_.GetDepth() > 0;
+    }
+    
+    template<typename Event>
+    void OnValue(Event event) {
+        json::NodeHandler& handler = depth_ == RECORDS_DEPTH ? record_ : value_;
+        event(handler);
+        if (!handler.HasNode()) { return; }
+        
+        if (depth_ == RECORDS_DEPTH) {
+            AddRecord(record_.ExtractDocument().GetRoot());
+        } else if (depth_ == ROOT_DEPTH) {
+            //Раздел копируется из своей арены в документ читателя
+            root_dict_.emplace(key_, value_.ExtractDocument().GetRoot());
         } else {
-            throw std::logic_error("Node is not count key \"type\"."s);
+            reader_.document_ = value_.ExtractDocument();
         }
     }
-    std::for_each(stop_requests.begin(), stop_requests.end(), [this](const json::Node* node_ptr) {
-        AddStopByNode(*node_ptr);
-    });
-    std::for_each(bus_requests.begin(), bus_requests.end(), [this](const json::Node* node_ptr) {
-        AddBusByNode(*node_ptr);
+    
+    void AddRecord(const json::Node& node) {
+        if (!pending_records_.empty() || (record_count_ == 0 && !HasRequiredSections())) {
+            pending_records_.push_back(node);
+            return;
+        }
+        if (record_count_++ == 0 && on_records_start_) {
+            reader_.document_ = json::Document(json::Node(root_dict_));
+            on_records_start_();
+        }
+        on_record_(node);
+    }
+};
+
+void JsonReader::LoadDataStreaming() {
+    std::optional<Domain::RoutingSettings> routing_settings = GetLoadedRoutingSettings();
+    
+    BusinessLogic::TransportCatalogueBuilder builder(catalogue_);
+    std::vector<std::string> removed_bus_names;
+    std::vector<std::string> removed_stop_names;
+    SectionHandler handler(*this, "base_requests"sv, [&](const json::Node& node) {
+        switch (GetBaseRequestType(node)) {
+            case RequestType::STOP:
+                AddStopByNode(node, builder);
+                break;
+            case RequestType::BUS:
+                AddBusByNode(node, builder);
+                break;
+            case RequestType::REMOVE_STOP:
+                removed_stop_names.emplace_back(DecodeRemoveRequest(node).name);
+                break;
+            case RequestType::REMOVE_BUS:
+                removed_bus_names.emplace_back(DecodeRemoveRequest(node).name);
+                break;
+            default:
+                break;
+        }
     });
+    json::Parse(input_stream_, handler);
+    if (!handler.HasRecords()) { return; }
+    
+    FinishLoadData(builder, std::vector<std::string_view>(removed_bus_names.begin(), removed_bus_names.end()),
+                   std::vector<std::string_view>(removed_stop_names.begin(), removed_stop_names.end()),
+                   routing_settings);
+}
+
+RequestType JsonReader::GetBaseRequestType(const json::Node& node) {
+    if (!node.IsMap() || node.AsMap().find("type"sv) == node.AsMap().end()) {
+        throw std::logic_error("Node is not count key \"type\"."s);
+    }
+    RequestType type = GetRequestType(node.AsMap().find("type"sv)->second);
+    switch (type) {
+        case RequestType::STOP:
+        case RequestType::BUS:
+        case RequestType::REMOVE_STOP:
+        case RequestType::REMOVE_BUS:
+        case RequestType::NONE:
+            return type;
+        default:
+            throw std::logic_error(
+                    "Node key \"type\" must be count value \"Stop\" or \"Bus\" or \"RemoveStop\" or \"RemoveBus\"."s);
+    }
+}
+
+std::optional<Domain::RoutingSettings> JsonReader::GetLoadedRoutingSettings() const {
+    if (catalogue_.HasUserRouteManager()) {
+        return catalogue_.GetUserRouteManager().GetRoutingSettings();
+    }
+    return std::nullopt;
+}
+
+void JsonReader::FinishLoadData(BusinessLogic::TransportCatalogueBuilder& builder,
+        const std::vector<std::string_view>& removed_bus_names, const std::vector<std::string_view>& removed_stop_names,
+        std::optional<Domain::RoutingSettings> routing_settings) {
+    builder.Finish();
+    
+    //Маршруты удаляются раньше остановок, чтобы освободить остановки удаляемых маршрутов
+    for (std::string_view name : removed_bus_names) {
+        catalogue_.RemoveBus(name);
+    }
+    for (std::string_view name : removed_stop_names) {
+        catalogue_.RemoveStop(name);
+    }
+    catalogue_.Compact();
+    //Имена после загрузки не меняются, поиск по ним идет через совершенную хеш-таблицу
+    catalogue_.BuildNameLookup();
     
+    const json::Node& root_node = document_.GetRoot();
     if (root_node.IsMap() && root_node.AsMap().count("routing_settings"s)) {
-        Domain::RoutingSettings routing_settings = GetRoutingSettings(root_node.AsMap().at("routing_settings"s));
-        catalogue_.ConstructUserRouteManager(routing_settings);
+        routing_settings = GetRoutingSettings(root_node.AsMap().at("routing_settings"s));
+    }
+    if (routing_settings.has_value()) {
+        catalogue_.ConstructUserRouteManager(routing_settings.value());
     }
     
     if (root_node.IsMap() && root_node.AsMap().count("render_settings"s)) {
@@ -62,68 +319,26 @@ void JsonReader::LoadData() {
     }
 }
 
-void JsonReader::AddStopByNode(const json::Node& node_ptr) {
-    node_ptr.IsMap() ? 0 : throw std::logic_error("Json Stop node must be Dictionary(key,Node)."s);
-    
-    const json::Dict& node_dict = node_ptr.AsMap();
+void JsonReader::AddStopByNode(const json::Node& node_ptr, BusinessLogic::TransportCatalogueBuilder& builder) {
+    StopRequest request = DecodeStopRequest(node_ptr);
+    Domain::Stop* stop_ptr = builder.AddStop(request.name, request.latitude, request.longitude);
     
-    node_dict.count("type"s) ? 0 : throw std::logic_error("Json Stop node must be contains \"type\"."s);
-    node_dict.at("type"s) == "Stop"s ? 0 : throw std::logic_error("Key \"type\" must be contains value \"Stop\"."s);
-    node_dict.count("name"s) ? 0 : throw std::logic_error("Json Stop node must be contains \"name\"."s);
-    node_dict.count("latitude"s) ? 0 : throw std::logic_error("Json Stop node must be contains \"latitude\"."s);
-    node_dict.count("longitude"s) ? 0 : throw std::logic_error("Json Stop node must be contains \"longitude\"."s);
-    node_dict.count("road_distances"s) ? 0 : throw std::logic_error(
-            "Json Stop node must be contains \"road_distances\"."s);
-    node_dict.at("road_distances"s).IsMap() ? 0 : throw std::logic_error(
-            "Key \"road_distances\" must be Dictionary(key,Node)."s);
-    
-    std::string name = node_dict.at("name").AsString();
-    double latitude = node_dict.at("latitude").AsDouble();
-    double longitude = node_dict.at("longitude").AsDouble();
-    Domain::Stop* stop_ptr = catalogue_.InsertStop(Domain::Stop(name, latitude, longitude));
-    
-    for (const auto& [key, value] : node_dict.at("road_distances"s).AsMap()) {
+    for (const auto& [key, value] : *request.road_distances) {
         double distance = value.AsDouble();
-        std::string to_stop_name = key;
-        Domain::Stop* to_stop_ptr = catalogue_.InsertStop(Domain::Stop(to_stop_name));
-        catalogue_.AddRealDistanceToCatalog(stop_ptr, to_stop_ptr, distance);
+        Domain::Stop* to_stop_ptr = builder.AddStop(std::string_view(key));
+        builder.AddRealDistance(stop_ptr, to_stop_ptr, distance);
     }
 }
 
-void JsonReader::AddBusByNode(const json::Node& node_ptr) {
-    node_ptr.IsMap() ? 0 : throw std::logic_error("Json Bus node must be Dictionary(key,Node)."s);
-    
-    const json::Dict& node_dict = node_ptr.AsMap();
-    
-    node_dict.count("type"s) ? 0 : throw std::logic_error("Json Bus node must be contains \"type\"."s);
-    node_dict.at("type"s) == "Bus"s ? 0 : throw std::logic_error("Key \"type\" must be contains value \"Bus\"."s);
-    node_dict.count("name"s) ? 0 : throw std::logic_error("Json Bus node must be contains \"name\"."s);
-    node_dict.count("stops"s) ? 0 : throw std::logic_error("Json Bus node must be contains \"stops\"."s);
-    node_dict.at("stops"s).IsArray() ? 0 : throw std::logic_error("Key \"stops\" must be array."s);
-    node_dict.count("is_roundtrip"s) ? 0 : throw std::logic_error("Json Bus node must be contains \"is_roundtrip\"."s);
-    node_dict.at("is_roundtrip"s).IsBool() ? 0 : throw std::logic_error("Key \"is_roundtrip\" must be bool."s);
-    
-    std::string bus_name = node_dict.at("name").AsString();
+void JsonReader::AddBusByNode(const json::Node& node_ptr, BusinessLogic::TransportCatalogueBuilder& builder) {
+    BusRequest request = DecodeBusRequest(node_ptr);
     std::vector<const Domain::Stop*> route;
+    route.reserve(request.stops->size() * 2);
     
-    for (const auto& stop_node : node_dict.at("stops"s).AsArray()) {
-        const std::string& stop_name = stop_node.AsString();
-        Domain::Stop* stop_ptr = catalogue_.InsertStop(Domain::Stop(stop_name));
-        route.push_back(stop_ptr);
+    for (const auto& stop_node : *request.stops) {
+        route.push_back(builder.AddStop(std::string_view(stop_node.AsString())));
     }
-    size_t number_final_stop = 0;
-    if (!node_dict.at("is_roundtrip"s).AsBool()) {
-        number_final_stop = route.size();
-        std::vector<const Domain::Stop*> backward_route;
-        std::copy(std::next(route.rbegin()), route.rend(),
-                std::back_insert_iterator<std::vector<const Domain::Stop*>>(backward_route));
-        std::move(backward_route.begin(), backward_route.end(),
-                std::back_insert_iterator<std::vector<const Domain::Stop*>>(route));
-    }
-    
-    double calc_dist = catalogue_.GetBusCalculateLength(route);
-    double real_dist = catalogue_.GetBusRealLength(route);
-    catalogue_.InsertBus(Domain::Bus(bus_name, route, number_final_stop, calc_dist, real_dist));
+    builder.AddBus(std::string(request.name), std::move(route), request.is_roundtrip);
 }
 
 Domain::RoutingSettings JsonReader::GetRoutingSettings(const json::Node& node_ptr) {
@@ -147,143 +362,288 @@ void JsonReader::SendAnswer() {
     const json::Node& stat_requests_node = root_node.AsMap().at("stat_requests");
     if (!(stat_requests_node.IsArray() && !stat_requests_node.AsArray().empty())) { return; }
     
-    json::Array answer_array;
-    
+    //Ответы записываются в поток по одному, узлы ответов не строятся
+    answer_cache_.Clear();
+    json::Writer writer(output_stream_);
+    writer.StartArray();
     for (const auto& node : stat_requests_node.AsArray()) {
-        node.IsMap() ? 0 : throw std::logic_error("Json request node must be Dictionary(key,Node)."s);
-        
-        const json::Node& type_node = node.AsMap().at("type");
-        if (type_node == "Stop"s) {
-            answer_array.push_back(GetStopRequestNode(node));
-        } else if (type_node == "Bus"s) {
-            answer_array.push_back(GetBusRequestNode(node));
-        } else if (type_node == "Map"s) {
-            answer_array.push_back(GetMapRequestNode(node));
-        } else if (type_node == "Route"s) {
-            answer_array.push_back(GetRouteRequestNode(node));
+        WriteAnswer(writer, node);
+        writer.Flush();
+    }
+    writer.EndArray().Flush();
+    output_stream_ << std::endl;
+}
+
+void JsonReader::SendAnswerStreaming(const std::function<void()>& prepare,
+        std::vector<std::string_view> prepare_sections) {
+    answer_cache_.Clear();
+    json::Writer writer(output_stream_);
+    SectionHandler handler(*this, "stat_requests"sv, [this, &writer](const json::Node& node) {
+        WriteAnswer(writer, node);
+        writer.Flush();
+    }, [&writer, &prepare]() {
+        if (prepare) { prepare(); }
+        writer.StartArray();
+    }, std::move(prepare_sections));
+    json::Parse(input_stream_, handler);
+    if (handler.HasRecords()) {
+        writer.EndArray().Flush();
+        output_stream_ << std::endl;
+    }
+}
+
+void JsonReader::WriteAnswer(json::Writer& writer, const json::Node& node) {
+    node.IsMap() ? 0 : throw std::logic_error("Json request node must be Dictionary(key,Node)."s);
+    auto type_it = node.AsMap().find("type"sv);
+    type_it != node.AsMap().end() ? 0 : throw std::logic_error("Json request node must be contains \"type\"."s);
+    
+    switch (GetRequestType(type_it->second)) {
+        case RequestType::STOP: {
+            InfoRequest request = DecodeInfoRequest(node);
+            WriteMemoizedAnswer(writer, *request.id, answer_cache_.MakeKey(RequestType::STOP, {request.name}),
+                    [this, &request](json::Writer& answer_writer) { WriteStopAnswer(answer_writer, request); });
+            break;
         }
-//        else if (type_node.IsNull()) {
-//            continue;
-//        }
-        else {
-            throw std::logic_error("Node key \"type\" must be count value \"Stop\" or \"Bus\" or \"Map\"."s);
+        case RequestType::BUS: {
+            InfoRequest request = DecodeInfoRequest(node);
+            WriteMemoizedAnswer(writer, *request.id, answer_cache_.MakeKey(RequestType::BUS, {request.name}),
+                    [this, &request](json::Writer& answer_writer) { WriteBusAnswer(answer_writer, request); });
+            break;
+        }
+        case RequestType::MAP:
+            WriteMapAnswer(writer, node);
+            break;
+        case RequestType::ROUTE: {
+            RouteRequest request = DecodeRouteRequest(node);
+            WriteMemoizedAnswer(writer, *request.id, answer_cache_.MakeKey(RequestType::ROUTE, {request.from, request.to}),
+                    [this, &request](json::Writer& answer_writer) { WriteRouteAnswer(answer_writer, request); });
+            break;
         }
+        case RequestType::NEAREST_STOPS:
+            WriteNearestStopsAnswer(writer, node);
+            break;
+        case RequestType::STOPS_IN_RADIUS:
+            WriteStopsInRadiusAnswer(writer, node);
+            break;
+        case RequestType::SEARCH:
+            WriteSearchAnswer(writer, node);
+            break;
+        case RequestType::STATS:
+            WriteStatsAnswer(writer, node);
+            break;
+        default:
+            throw std::logic_error("Node key \"type\" must be count value \"Stop\" or \"Bus\" or \"Map\"."s);
     }
-    
-    json::Print(json::Document(std::move(answer_array)), output_stream_);
 }
 
-json::Node JsonReader::GetStopRequestNode(const json::Node& node) {
-    const json::Dict& node_dict = node.AsMap();
-    node_dict.count("id"s) ? 0 : throw std::logic_error("Json request node must be contains \"id\"."s);
-    node_dict.count("type"s) ? 0 : throw std::logic_error("Json request node must be contains \"type\"."s);
-    node_dict.count("name"s) ? 0 : throw std::logic_error("Json request node must be contains \"name\"."s);
-    
-    const std::string& name = node_dict.at("name"s).AsString();
-    
-    auto stop_info = catalogue_.GetStopInfo(name);
+void JsonReader::SendMemoryStats() {
+    MemoryReport report = MemoryStats(catalogue_, map_renderer_).Collect();
+    json::Writer writer(output_stream_);
+    WriteMemoryReport(writer, json::Node(), report);
+    writer.Flush();
+    output_stream_ << std::endl;
+}
+
+const AnswerCache::Counters& JsonReader::GetAnswerCacheCounters() const {
+    return answer_cache_.GetCounters();
+}
+
+void JsonReader::WriteMemoizedAnswer(json::Writer& writer, const json::Node& id_node, const std::string& key,
+        const std::function<void(json::Writer&)>& write_answer) {
+    if (!id_node.IsInt()) {
+        write_answer(writer);
+        return;
+    }
+    if (answer_cache_.TryWrite(key, id_node.AsInt(), writer)) { return; }
+    //Запрос встретился впервые, ответ пишется сразу в вывод
+    if (!answer_cache_.Admit(key)) {
+        write_answer(writer);
+        return;
+    }
     
-    auto builder = json::Builder{};
-    auto sub_dict_result = builder.StartDict();
-    sub_dict_result.Key("request_id").Value(node_dict.at("id"));
+    //Ответ пишется отдельно с отступом элемента массива ответов и вставляется в общий вывод готовым текстом
+    answer_buffer_.clear();
+    {
+        json::Writer answer_writer(answer_buffer_, json::PrintMode::PRETTY, 1,
+                static_cast<int>(output_stream_.precision()));
+        write_answer(answer_writer);
+    }
+    writer.RawValue(answer_buffer_);
+    answer_cache_.Add(key, answer_buffer_, request_id_begin_, request_id_end_);
+}
+
+void JsonReader::WriteRequestId(json::Writer& writer, const json::Node& id_node) {
+    writer.Key("request_id"sv);
+    request_id_begin_ = writer.GetWrittenSize();
+    writer.Value(id_node);
+    request_id_end_ = writer.GetWrittenSize();
+}
+
+//Ключи ответов записываются по алфавиту, в том порядке, в котором их выводит json::Print
+
+void JsonReader::WriteStopAnswer(json::Writer& writer, const InfoRequest& request) {
+    auto stop_info = catalogue_.GetStopInfo(request.name);
     
+    writer.StartDict();
     if (stop_info.has_value() /*&& !stop_info.value().buses.empty()*/) {
-        auto sub_array_result = sub_dict_result.Key("buses").StartArray();
+        writer.Key("buses"sv).StartArray();
         for (const auto& bus : stop_info.value().buses) {
-            sub_array_result.Value(bus->name);
+            writer.Value(bus->name);
         }
-        sub_array_result.EndArray();
+        writer.EndArray();
     }
     else {
-        sub_dict_result.Key("error_message").Value("not found"s);
+        writer.Key("error_message"sv).Value("not found"sv);
     }
-    json::Node result = sub_dict_result.EndDict().Build();
-    return result;
+    WriteRequestId(writer, *request.id);
+    writer.EndDict();
 }
 
-json::Node JsonReader::GetBusRequestNode(const json::Node& node) {
-    const json::Dict& node_dict = node.AsMap();
-    node_dict.count("id"s) ? 0 : throw std::logic_error("Json request node must be contains \"id\"."s);
-    node_dict.count("type"s) ? 0 : throw std::logic_error("Json request node must be contains \"type\"."s);
-    node_dict.count("name"s) ? 0 : throw std::logic_error("Json request node must be contains \"name\"."s);
+void JsonReader::WriteBusAnswer(json::Writer& writer, const InfoRequest& request) {
+    auto bus_info = catalogue_.GetBusInfo(request.name);
     
-    std::string bus_name = node_dict.at("name"s).AsString();
-    auto bus_info = catalogue_.GetBusInfo(bus_name);
-    
-    json::Builder builder = json::Builder{};
-    auto sub_result = builder.StartDict().Key("request_id").Value(node_dict.at("id"));
+    writer.StartDict();
     if (bus_info.has_value()) {
-        sub_result.Key("curvature").Value(bus_info.value().curvature)
-                  .Key("route_length").Value(bus_info.value().length)
-                  .Key("stop_count").Value(static_cast<int>(bus_info.value().stops_count))
-                  .Key("unique_stop_count").Value(static_cast<int>(bus_info.value().unique_stops_count));
+        writer.Key("curvature"sv).Value(bus_info.value().curvature);
+        WriteRequestId(writer, *request.id);
+        writer.Key("route_length"sv).Value(bus_info.value().length)
+              .Key("stop_count"sv).Value(static_cast<int>(bus_info.value().stops_count))
+              .Key("unique_stop_count"sv).Value(static_cast<int>(bus_info.value().unique_stops_count));
     }
     else {
-        sub_result.Key("error_message").Value("not found"s);
+        writer.Key("error_message"sv).Value("not found"sv);
+        WriteRequestId(writer, *request.id);
     }
-    json::Node result = sub_result.EndDict().Build();
-    return result;
+    writer.EndDict();
 }
 
-json::Node JsonReader::GetMapRequestNode(const json::Node& node) {
-    const json::Dict& node_dict = node.AsMap();
-    node_dict.count("id"s) ? 0 : throw std::logic_error("Json request node must be contains \"id\"."s);
-    node_dict.count("type"s) ? 0 : throw std::logic_error("Json request node must be contains \"type\"."s);
-    
-    json::Node result_node = json::Builder{}.StartDict()
-                                                .Key("request_id").Value(node_dict.at("id"))
-                                                .Key("map").Value(Render())
-                                            .EndDict()
-                                            .Build();
-    return result_node;
+void JsonReader::WriteMapAnswer(json::Writer& writer, const json::Node& node) {
+    MapRequest request = DecodeMapRequest(node);
+    writer.StartDict();
+    if (request.viewport.has_value()) {
+        writer.Key("map"sv).Value(RenderViewport(*request.viewport));
+    }
+    else {
+        writer.Key("map"sv).RawValue(RenderJsonString());
+    }
+    writer.Key("request_id"sv).Value(*request.id)
+          .EndDict();
 }
 
-json::Node JsonReader::GetRouteRequestNode(const json::Node& node) {
-    const json::Dict& node_dict = node.AsMap();
-    node_dict.count("id"s) ? 0 : throw std::logic_error("Json request node must be contains \"id\"."s);
-    node_dict.count("type"s) ? 0 : throw std::logic_error("Json request node must be contains \"type\"."s);
-    node_dict.count("from"s) ? 0 : throw std::logic_error("Json request node must be contains \"from\"."s);
-    node_dict.count("to"s) ? 0 : throw std::logic_error("Json request node must be contains \"to\"."s);
-    
-    std::string stop_from = node_dict.at("from"s).AsString();
-    std::string stop_to = node_dict.at("to"s).AsString();;
-    std::optional<Domain::UserRouteInfo> route_info = catalogue_.GetUserRouteManager().GetUserRouteInfo(stop_from, stop_to);
-    
-    json::Builder builder = json::Builder{};
-    auto sub_result = builder.StartDict().Key("request_id").Value(node_dict.at("id"));
+void JsonReader::WriteRouteAnswer(json::Writer& writer, const RouteRequest& request) {
+    std::optional<Domain::UserRouteInfo> route_info = catalogue_.GetUserRouteManager().GetUserRouteInfo(request.from,
+            request.to);
     
+    writer.StartDict();
     if (route_info.has_value()) {
-        
-        sub_result.Key("total_time").Value(route_info.value().total_time);
-        
-        auto sub_array_result = sub_result.Key("items").StartArray();
+        writer.Key("items"sv).StartArray();
         for (const auto& item : route_info.value().items) {
             if (std::holds_alternative<Domain::UserRouteInfo::UserWait>(item)) {
                 const auto& user_wait = std::get<Domain::UserRouteInfo::UserWait>(item);
-                sub_array_result.StartDict()
-                                    .Key("type").Value("Wait")
-                                    .Key("stop_name").Value(user_wait.stop->name)
-                                    .Key("time").Value(user_wait.time)
-                                .EndDict();
+                writer.StartDict()
+                          .Key("stop_name"sv).Value(user_wait.stop->name)
+                          .Key("time"sv).Value(user_wait.time)
+                          .Key("type"sv).Value("Wait"sv)
+                      .EndDict();
                 
             } else if (std::holds_alternative<Domain::UserRouteInfo::UserBus>(item)) {
                 const auto& user_bus = std::get<Domain::UserRouteInfo::UserBus>(item);
-                sub_array_result.StartDict()
-                                    .Key("type").Value("Bus")
-                                    .Key("bus").Value(user_bus.bus->name)
-                                    .Key("span_count").Value(static_cast<int>(user_bus.span_count))
-                                    .Key("time").Value(user_bus.time)
-                                .EndDict();
+                writer.StartDict()
+                          .Key("bus"sv).Value(user_bus.bus->name)
+                          .Key("span_count"sv).Value(static_cast<int>(user_bus.span_count))
+                          .Key("time"sv).Value(user_bus.time)
+                          .Key("type"sv).Value("Bus"sv)
+                      .EndDict();
             }
         }
-        sub_array_result.EndArray();
+        writer.EndArray();
+        WriteRequestId(writer, *request.id);
+        writer.Key("total_time"sv).Value(route_info.value().total_time);
     }
     else {
-        sub_result.Key("error_message").Value("not found"s);
+        writer.Key("error_message"sv).Value("not found"sv);
+        WriteRequestId(writer, *request.id);
+    }
+    writer.EndDict();
+}
+
+void JsonReader::WriteNearestStopsAnswer(json::Writer& writer, const json::Node& node) {
+    NearestStopsRequest request = DecodeNearestStopsRequest(node);
+    auto stops = catalogue_.GetNearestStops(request.point, request.count);
+    WriteStopDistances(writer, *request.id, stops);
+}
+
+void JsonReader::WriteStopsInRadiusAnswer(json::Writer& writer, const json::Node& node) {
+    RadiusRequest request = DecodeRadiusRequest(node);
+    auto stops = catalogue_.GetStopsInRadius(request.point, request.radius);
+    WriteStopDistances(writer, *request.id, stops);
+}
+
+void JsonReader::WriteSearchAnswer(json::Writer& writer, const json::Node& node) {
+    SearchRequest request = DecodeSearchRequest(node);
+    auto matches = catalogue_.SearchNames(request.query, request.limit, request.fuzzy);
+    
+    writer.StartDict().Key("items"sv).StartArray();
+    for (const auto& match : matches) {
+        writer.StartDict()
+                  .Key("name"sv).Value(match.name)
+                  .Key("type"sv).Value(std::holds_alternative<const Domain::Stop*>(match.entity) ? "Stop"sv : "Bus"sv)
+              .EndDict();
+    }
+    writer.EndArray()
+          .Key("request_id"sv).Value(*request.id)
+          .EndDict();
+}
+
+void JsonReader::WriteStatsAnswer(json::Writer& writer, const json::Node& node) {
+    StatsRequest request = DecodeStatsRequest(node);
+    MemoryReport report = MemoryStats(catalogue_, map_renderer_).Collect();
+    WriteMemoryReport(writer, *request.id, report);
+}
+
+void JsonReader::WriteStopDistances(json::Writer& writer, const json::Node& id_node,
+        const std::vector<Domain::StopDistance>& stops) {
+    writer.StartDict().Key("request_id"sv).Value(id_node).Key("stops"sv).StartArray();
+    for (const auto& [stop, distance] : stops) {
+        writer.StartDict()
+                  .Key("distance"sv).Value(distance)
+                  .Key("name"sv).Value(stop->name)
+              .EndDict();
+    }
+    writer.EndArray().EndDict();
+}
+
+void JsonReader::WriteMemoryReport(json::Writer& writer, const json::Node& id_node, const MemoryReport& report) {
+    writer.StartDict();
+    //Для вывода из командной строки идентификатора запроса и пакета с кешем ответов нет
+    if (!id_node.IsNull()) {
+        const AnswerCache::Counters& counters = answer_cache_.GetCounters();
+        writer.Key("answer_cache"sv).StartDict()
+                  .Key("hits"sv).Value(static_cast<int>(counters.hits))
+                  .Key("requests"sv).Value(static_cast<int>(counters.requests))
+              .EndDict()
+              .Key("request_id"sv).Value(id_node);
+    }
+    //Структуры выводятся по имени, при повторе имени остается первая
+    std::vector<const std::pair<std::string, size_t>*> structures;
+    structures.reserve(report.structures.size());
+    for (const auto& structure : report.structures) {
+        structures.push_back(&structure);
     }
+    std::stable_sort(structures.begin(), structures.end(), [](const auto* lhs, const auto* rhs) {
+        return lhs->first < rhs->first;
+    });
+    structures.erase(std::unique(structures.begin(), structures.end(), [](const auto* lhs, const auto* rhs) {
+        return lhs->first == rhs->first;
+    }), structures.end());
     
-    json::Node result = sub_result.EndDict().Build();
-    return result;
+    writer.Key("structures"sv).StartDict();
+    for (const auto* structure : structures) {
+        writer.Key(structure->first).Value(static_cast<int>(structure->second));
+    }
+    writer.EndDict()
+          .Key("total_bytes"sv).Value(static_cast<int>(report.total_bytes))
+          .EndDict();
 }
 
 Domain::RenderSettings JsonReader::GetRenderSettings(const json::Node& render_settings_node) {
@@ -294,7 +654,7 @@ Domain::RenderSettings JsonReader::GetRenderSettings(const json::Node& render_se
     
     svg::Color underlayer_color_variant;
     if (map_render.at("underlayer_color").IsString()) {
-        underlayer_color_variant = map_render.at("underlayer_color").AsString();
+        underlayer_color_variant = std::string(map_render.at("underlayer_color").AsString());
     } else if (map_render.at("underlayer_color").IsArray()) {
         auto array_color = map_render.at("underlayer_color").AsArray();
         if (array_color.size() == 3) {
@@ -314,7 +674,7 @@ Domain::RenderSettings JsonReader::GetRenderSettings(const json::Node& render_se
     if (map_render.at("color_palette").IsArray() && !map_render.at("color_palette").AsArray().empty()) {
         for (const auto& node : map_render.at("color_palette").AsArray()) {
             if (node.IsString()) {
-                color_palette_variant.push_back(node.AsString());
+                color_palette_variant.emplace_back(node.AsString());
             } else if (node.IsArray()) {
                 auto array_color = node.AsArray();
                 if (array_color.size() == 3) {
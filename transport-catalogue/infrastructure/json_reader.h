@@ -1,8 +1,12 @@
 #pragma once
 
 #include <filesystem>
+#include <functional>
 #include "../business_logic/transport_catalogue.h"
+#include "answer_cache.h"
 #include "io_requests_base.h"
+#include "json_requests.h"
+#include "memory_stats.h"
 #include "../external/json.h"
 #include "../external/json_builder.h"
 
@@ -14,7 +18,21 @@ public:
             std::istream& input_stream, std::ostream& output_stream);
     void PreloadDocument() override;
     void LoadData() override;
+    /**Загрузить базу потоково, без PreloadDocument.
+     * Остановки и маршруты из base_requests передаются в каталог по мере разбора, дерево строится только
+     * для одной записи. Остальные разделы документа сохраняются как при PreloadDocument*/
+    void LoadDataStreaming();
     void SendAnswer() override;
+    /**Ответить на запросы потоково, без PreloadDocument.
+     * Каждый запрос из stat_requests выполняется сразу после разбора, ответ выводится до чтения следующего.
+     * prepare вызывается перед первым запросом, например для загрузки базы, prepare_sections - разделы документа,
+     * которые ему нужны. Если они стоят в тексте после stat_requests, запросы откладываются до конца документа*/
+    void SendAnswerStreaming(const std::function<void()>& prepare = {},
+            std::vector<std::string_view> prepare_sections = {});
+    /**Вывести отчет о памяти каталога, маршрутизатора и рендера*/
+    void SendMemoryStats();
+    /**Счетчики кеша ответов последнего пакета stat_requests*/
+    const AnswerCache::Counters& GetAnswerCacheCounters() const;
     [[nodiscard]] std::filesystem::path GetOutputFilePath() const;
     [[nodiscard]] std::filesystem::path GetInputFilePath() const;
 
@@ -23,17 +41,47 @@ private:
     std::istream& input_stream_;
     std::ostream& output_stream_;
     json::Document document_ = json::Document(json::Node());
+    AnswerCache answer_cache_;
+    //Строка, в которую записывается ответ перед сохранением в кеш, память переиспользуется между ответами
+    std::string answer_buffer_;
+    //Символы значения request_id последнего записанного ответа, по ним ответ делится для кеша
+    size_t request_id_begin_ = 0;
+    size_t request_id_end_ = 0;
     
 
 private:
-    void AddStopByNode(const json::Node& node_ptr);
-    void AddBusByNode(const json::Node& node_ptr);
+    class SectionHandler;
+    
+    /**Настройки маршрутизации загруженной базы, по ним маршрутизатор строится заново при обновлении*/
+    std::optional<Domain::RoutingSettings> GetLoadedRoutingSettings() const;
+    /**Завершить загрузку: удалить объекты, уплотнить каталог, применить настройки документа*/
+    void FinishLoadData(BusinessLogic::TransportCatalogueBuilder& builder,
+            const std::vector<std::string_view>& removed_bus_names, const std::vector<std::string_view>& removed_stop_names,
+            std::optional<Domain::RoutingSettings> routing_settings);
+    /**Тип записи base_requests, записи без ключа "type" и неизвестных типов - ошибка*/
+    static RequestType GetBaseRequestType(const json::Node& node);
+    void AddStopByNode(const json::Node& node_ptr, BusinessLogic::TransportCatalogueBuilder& builder);
+    void AddBusByNode(const json::Node& node_ptr, BusinessLogic::TransportCatalogueBuilder& builder);
     Domain::RenderSettings GetRenderSettings(const json::Node& node);
     Domain::RoutingSettings GetRoutingSettings(const json::Node& node_ptr);
-    json::Node GetStopRequestNode(const json::Node& node);
-    json::Node GetBusRequestNode(const json::Node& node);
-    json::Node GetMapRequestNode(const json::Node& node);
-    json::Node GetRouteRequestNode(const json::Node& node);
+    void WriteAnswer(json::Writer& writer, const json::Node& node);
+    /**Записать ответ из кеша, а при промахе - через write_answer с сохранением в кеш.
+     * Ответы на запросы с нецелым id не кешируются*/
+    void WriteMemoizedAnswer(json::Writer& writer, const json::Node& id_node, const std::string& key,
+            const std::function<void(json::Writer&)>& write_answer);
+    /**Записать ключ request_id и запомнить положение его значения*/
+    void WriteRequestId(json::Writer& writer, const json::Node& id_node);
+    void WriteStopAnswer(json::Writer& writer, const InfoRequest& request);
+    void WriteBusAnswer(json::Writer& writer, const InfoRequest& request);
+    void WriteMapAnswer(json::Writer& writer, const json::Node& node);
+    void WriteRouteAnswer(json::Writer& writer, const RouteRequest& request);
+    void WriteNearestStopsAnswer(json::Writer& writer, const json::Node& node);
+    void WriteStopsInRadiusAnswer(json::Writer& writer, const json::Node& node);
+    void WriteSearchAnswer(json::Writer& writer, const json::Node& node);
+    void WriteStatsAnswer(json::Writer& writer, const json::Node& node);
+    void WriteStopDistances(json::Writer& writer, const json::Node& id_node,
+            const std::vector<Domain::StopDistance>& stops);
+    void WriteMemoryReport(json::Writer& writer, const json::Node& id_node, const MemoryReport& report);
 };
 
 }
\ No newline at end of file
@@ -0,0 +1,256 @@
+#include <stdexcept>
+#include <string>
+#include "json_requests.h"
+
+namespace TransportGuide::IoRequests {
+using namespace std::literals;
+
+namespace {
+
+//Значение ключа key, если имя совпало с ожидаемым
+void MatchKey(std::string_view key, std::string_view expected, const json::Node& value, const json::Node*& result) {
+    if (key == expected) { result = &value; }
+}
+
+//Ключи запросов stat_requests, name - и у запросов удаления из base_requests
+struct StatKeys {
+    const json::Node* id = nullptr;
+    const json::Node* type = nullptr;
+    const json::Node* name = nullptr;
+    const json::Node* from = nullptr;
+    const json::Node* to = nullptr;
+    const json::Node* bbox = nullptr;
+    const json::Node* zoom = nullptr;
+    const json::Node* latitude = nullptr;
+    const json::Node* longitude = nullptr;
+    const json::Node* count = nullptr;
+    const json::Node* radius = nullptr;
+    const json::Node* query = nullptr;
+    const json::Node* limit = nullptr;
+    const json::Node* fuzzy = nullptr;
+};
+
+StatKeys FindStatKeys(const json::Dict& node_dict) {
+    StatKeys keys;
+    for (const auto& [key, value] : node_dict) {
+        switch (HashKey(key)) {
+            case HashKey("id"): MatchKey(key, "id"sv, value, keys.id); break;
+            case HashKey("type"): MatchKey(key, "type"sv, value, keys.type); break;
+            case HashKey("name"): MatchKey(key, "name"sv, value, keys.name); break;
+            case HashKey("from"): MatchKey(key, "from"sv, value, keys.from); break;
+            case HashKey("to"): MatchKey(key, "to"sv, value, keys.to); break;
+            case HashKey("bbox"): MatchKey(key, "bbox"sv, value, keys.bbox); break;
+            case HashKey("zoom"): MatchKey(key, "zoom"sv, value, keys.zoom); break;
+            case HashKey("latitude"): MatchKey(key, "latitude"sv, value, keys.latitude); break;
+            case HashKey("longitude"): MatchKey(key, "longitude"sv, value, keys.longitude); break;
+            case HashKey("count"): MatchKey(key, "count"sv, value, keys.count); break;
+            case HashKey("radius"): MatchKey(key, "radius"sv, value, keys.radius); break;
+            case HashKey("query"): MatchKey(key, "query"sv, value, keys.query); break;
+            case HashKey("limit"): MatchKey(key, "limit"sv, value, keys.limit); break;
+            case HashKey("fuzzy"): MatchKey(key, "fuzzy"sv, value, keys.fuzzy); break;
+            default: break;
+        }
+    }
+    return keys;
+}
+
+//Углы окна карты из словаря с ключами min_lat, min_lng, max_lat, max_lng
+std::pair<Domain::geo::Coordinates, Domain::geo::Coordinates> DecodeBbox(const json::Node& node) {
+    node.IsMap() ? 0 : throw std::logic_error("Key \"bbox\" must be Dictionary(key,Node)."s);
+    const json::Node* bounds[4] = {};
+    for (const auto& [key, value] : node.AsMap()) {
+        switch (HashKey(key)) {
+            case HashKey("min_lat"): MatchKey(key, "min_lat"sv, value, bounds[0]); break;
+            case HashKey("min_lng"): MatchKey(key, "min_lng"sv, value, bounds[1]); break;
+            case HashKey("max_lat"): MatchKey(key, "max_lat"sv, value, bounds[2]); break;
+            case HashKey("max_lng"): MatchKey(key, "max_lng"sv, value, bounds[3]); break;
+            default: break;
+        }
+    }
+    
+    static const std::string_view BOUND_KEYS[4] = {"min_lat"sv, "min_lng"sv, "max_lat"sv, "max_lng"sv};
+    double values[4] = {};
+    for (size_t i = 0; i < 4; ++i) {
+        bounds[i] ? 0 : throw std::logic_error("Json bbox node must be contains \""s + std::string(BOUND_KEYS[i]) + "\"."s);
+        bounds[i]->IsDouble() ? 0 : throw std::logic_error("Key \""s + std::string(BOUND_KEYS[i]) + "\" must be double."s);
+        values[i] = bounds[i]->AsDouble();
+    }
+    values[0] <= values[2] && values[1] <= values[3] ? 0 : throw std::logic_error(
+            "Json bbox node minimum must be not greater than maximum."s);
+    return {{values[0], values[1]}, {values[2], values[3]}};
+}
+
+}
+
+RequestType GetRequestType(const json::Node& type_node) {
+    if (type_node.IsNull()) { return RequestType::NONE; }
+    if (!type_node.IsString()) { return RequestType::UNKNOWN; }
+    
+    std::string_view type = type_node.AsString();
+    auto match = [type](std::string_view expected, RequestType request_type) {
+        return type == expected ? request_type : RequestType::UNKNOWN;
+    };
+    switch (HashKey(type)) {
+        case HashKey("Stop"): return match("Stop"sv, RequestType::STOP);
+        case HashKey("Bus"): return match("Bus"sv, RequestType::BUS);
+        case HashKey("RemoveStop"): return match("RemoveStop"sv, RequestType::REMOVE_STOP);
+        case HashKey("RemoveBus"): return match("RemoveBus"sv, RequestType::REMOVE_BUS);
+        case HashKey("Map"): return match("Map"sv, RequestType::MAP);
+        case HashKey("Route"): return match("Route"sv, RequestType::ROUTE);
+        case HashKey("NearestStops"): return match("NearestStops"sv, RequestType::NEAREST_STOPS);
+        case HashKey("StopsInRadius"): return match("StopsInRadius"sv, RequestType::STOPS_IN_RADIUS);
+        case HashKey("Search"): return match("Search"sv, RequestType::SEARCH);
+        case HashKey("Stats"): return match("Stats"sv, RequestType::STATS);
+        default: return RequestType::UNKNOWN;
+    }
+}
+
+StopRequest DecodeStopRequest(const json::Node& node) {
+    node.IsMap() ? 0 : throw std::logic_error("Json Stop node must be Dictionary(key,Node)."s);
+    
+    const json::Node* type = nullptr;
+    const json::Node* name = nullptr;
+    const json::Node* latitude = nullptr;
+    const json::Node* longitude = nullptr;
+    const json::Node* road_distances = nullptr;
+    for (const auto& [key, value] : node.AsMap()) {
+        switch (HashKey(key)) {
+            case HashKey("type"): MatchKey(key, "type"sv, value, type); break;
+            case HashKey("name"): MatchKey(key, "name"sv, value, name); break;
+            case HashKey("latitude"): MatchKey(key, "latitude"sv, value, latitude); break;
+            case HashKey("longitude"): MatchKey(key, "longitude"sv, value, longitude); break;
+            case HashKey("road_distances"): MatchKey(key, "road_distances"sv, value, road_distances); break;
+            default: break;
+        }
+    }
+    
+    type ? 0 : throw std::logic_error("Json Stop node must be contains \"type\"."s);
+    GetRequestType(*type) == RequestType::STOP ? 0 : throw std::logic_error(
+            "Key \"type\" must be contains value \"Stop\"."s);
+    name ? 0 : throw std::logic_error("Json Stop node must be contains \"name\"."s);
+    latitude ? 0 : throw std::logic_error("Json Stop node must be contains \"latitude\"."s);
+    longitude ? 0 : throw std::logic_error("Json Stop node must be contains \"longitude\"."s);
+    road_distances ? 0 : throw std::logic_error("Json Stop node must be contains \"road_distances\"."s);
+    road_distances->IsMap() ? 0 : throw std::logic_error("Key \"road_distances\" must be Dictionary(key,Node)."s);
+    
+    return {name->AsString(), latitude->AsDouble(), longitude->AsDouble(), &road_distances->AsMap()};
+}
+
+BusRequest DecodeBusRequest(const json::Node& node) {
+    node.IsMap() ? 0 : throw std::logic_error("Json Bus node must be Dictionary(key,Node)."s);
+    
+    const json::Node* type = nullptr;
+    const json::Node* name = nullptr;
+    const json::Node* stops = nullptr;
+    const json::Node* is_roundtrip = nullptr;
+    for (const auto& [key, value] : node.AsMap()) {
+        switch (HashKey(key)) {
+            case HashKey("type"): MatchKey(key, "type"sv, value, type); break;
+            case HashKey("name"): MatchKey(key, "name"sv, value, name); break;
+            case HashKey("stops"): MatchKey(key, "stops"sv, value, stops); break;
+            case HashKey("is_roundtrip"): MatchKey(key, "is_roundtrip"sv, value, is_roundtrip); break;
+            default: break;
+        }
+    }
+    
+    type ? 0 : throw std::logic_error("Json Bus node must be contains \"type\"."s);
+    GetRequestType(*type) == RequestType::BUS ? 0 : throw std::logic_error(
+            "Key \"type\" must be contains value \"Bus\"."s);
+    name ? 0 : throw std::logic_error("Json Bus node must be contains \"name\"."s);
+    stops ? 0 : throw std::logic_error("Json Bus node must be contains \"stops\"."s);
+    stops->IsArray() ? 0 : throw std::logic_error("Key \"stops\" must be array."s);
+    is_roundtrip ? 0 : throw std::logic_error("Json Bus node must be contains \"is_roundtrip\"."s);
+    is_roundtrip->IsBool() ? 0 : throw std::logic_error("Key \"is_roundtrip\" must be bool."s);
+    
+    return {name->AsString(), &stops->AsArray(), is_roundtrip->AsBool()};
+}
+
+InfoRequest DecodeInfoRequest(const json::Node& node) {
+    StatKeys keys = FindStatKeys(node.AsMap());
+    keys.id ? 0 : throw std::logic_error("Json request node must be contains \"id\"."s);
+    keys.type ? 0 : throw std::logic_error("Json request node must be contains \"type\"."s);
+    keys.name ? 0 : throw std::logic_error("Json request node must be contains \"name\"."s);
+    return {keys.id, keys.name->AsString()};
+}
+
+RouteRequest DecodeRouteRequest(const json::Node& node) {
+    StatKeys keys = FindStatKeys(node.AsMap());
+    keys.id ? 0 : throw std::logic_error("Json request node must be contains \"id\"."s);
+    keys.type ? 0 : throw std::logic_error("Json request node must be contains \"type\"."s);
+    keys.from ? 0 : throw std::logic_error("Json request node must be contains \"from\"."s);
+    keys.to ? 0 : throw std::logic_error("Json request node must be contains \"to\"."s);
+    return {keys.id, keys.from->AsString(), keys.to->AsString()};
+}
+
+MapRequest DecodeMapRequest(const json::Node& node) {
+    StatKeys keys = FindStatKeys(node.AsMap());
+    keys.id ? 0 : throw std::logic_error("Json request node must be contains \"id\"."s);
+    keys.type ? 0 : throw std::logic_error("Json request node must be contains \"type\"."s);
+    MapRequest request{keys.id, std::nullopt};
+    if (keys.bbox || keys.zoom) {
+        request.viewport.emplace();
+        if (keys.bbox) { request.viewport->bbox = DecodeBbox(*keys.bbox); }
+        if (keys.zoom) {
+            keys.zoom->IsDouble() && keys.zoom->AsDouble() > 0. ? 0 : throw std::logic_error(
+                    "Key \"zoom\" must be positive double."s);
+            request.viewport->zoom = keys.zoom->AsDouble();
+        }
+    }
+    return request;
+}
+
+NearestStopsRequest DecodeNearestStopsRequest(const json::Node& node) {
+    StatKeys keys = FindStatKeys(node.AsMap());
+    keys.id ? 0 : throw std::logic_error("Json request node must be contains \"id\"."s);
+    keys.latitude ? 0 : throw std::logic_error("Json request node must be contains \"latitude\"."s);
+    keys.longitude ? 0 : throw std::logic_error("Json request node must be contains \"longitude\"."s);
+    keys.count ? 0 : throw std::logic_error("Json request node must be contains \"count\"."s);
+    keys.count->IsInt() && keys.count->AsInt() >= 0 ? 0 : throw std::logic_error(
+            "Key \"count\" must be non-negative int."s);
+    return {keys.id, {keys.latitude->AsDouble(), keys.longitude->AsDouble()}, static_cast<size_t>(keys.count->AsInt())};
+}
+
+RadiusRequest DecodeRadiusRequest(const json::Node& node) {
+    StatKeys keys = FindStatKeys(node.AsMap());
+    keys.id ? 0 : throw std::logic_error("Json request node must be contains \"id\"."s);
+    keys.latitude ? 0 : throw std::logic_error("Json request node must be contains \"latitude\"."s);
+    keys.longitude ? 0 : throw std::logic_error("Json request node must be contains \"longitude\"."s);
+    keys.radius ? 0 : throw std::logic_error("Json request node must be contains \"radius\"."s);
+    return {keys.id, {keys.latitude->AsDouble(), keys.longitude->AsDouble()}, keys.radius->AsDouble()};
+}
+
+SearchRequest DecodeSearchRequest(const json::Node& node) {
+    StatKeys keys = FindStatKeys(node.AsMap());
+    keys.id ? 0 : throw std::logic_error("Json request node must be contains \"id\"."s);
+    keys.query ? 0 : throw std::logic_error("Json request node must be contains \"query\"."s);
+    keys.query->IsString() ? 0 : throw std::logic_error("Key \"query\" must be string."s);
+    SearchRequest request;
+    request.id = keys.id;
+    request.query = keys.query->AsString();
+    if (keys.limit) {
+        keys.limit->IsInt() && keys.limit->AsInt() >= 0 ? 0 : throw std::logic_error(
+                "Key \"limit\" must be non-negative int."s);
+        request.limit = static_cast<size_t>(keys.limit->AsInt());
+    }
+    if (keys.fuzzy) {
+        keys.fuzzy->IsBool() ? 0 : throw std::logic_error("Key \"fuzzy\" must be bool."s);
+        request.fuzzy = keys.fuzzy->AsBool();
+    }
+    return request;
+}
+
+StatsRequest DecodeStatsRequest(const json::Node& node) {
+    StatKeys keys = FindStatKeys(node.AsMap());
+    keys.id ? 0 : throw std::logic_error("Json request node must be contains \"id\"."s);
+    return {keys.id};
+}
+
+RemoveRequest DecodeRemoveRequest(const json::Node& node) {
+    node.IsMap() ? 0 : throw std::logic_error("Json Remove node must be Dictionary(key,Node)."s);
+    StatKeys keys = FindStatKeys(node.AsMap());
+    keys.name ? 0 : throw std::logic_error("Json Remove node must be contains \"name\"."s);
+    keys.name->IsString() ? 0 : throw std::logic_error("Key \"name\" must be String."s);
+    return {keys.name->AsString()};
+}
+
+}
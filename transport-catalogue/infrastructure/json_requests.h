@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include "../external/json.h"
+#include "../domain/domain.h"
+
+namespace TransportGuide::IoRequests {
+
+/**FNV-1a над именем ключа, вычисляется при компиляции для меток switch.
+ * Совпадение хеша подтверждается сравнением строк, поэтому коллизия не приводит к ошибочному разбору*/
+constexpr uint64_t HashKey(std::string_view key) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (char c : key) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+/**Значение ключа "type" запроса, NONE - null, UNKNOWN - любое другое значение*/
+enum class RequestType {
+    UNKNOWN, NONE, STOP, BUS, REMOVE_STOP, REMOVE_BUS, MAP, ROUTE, NEAREST_STOPS, STOPS_IN_RADIUS, SEARCH, STATS
+};
+
+RequestType GetRequestType(const json::Node& type_node);
+
+//Запросы ссылаются на строки и узлы документа, из которого разобраны, и живут не дольше его
+
+/**Остановка из base_requests*/
+struct StopRequest {
+    std::string_view name;
+    double latitude = 0.;
+    double longitude = 0.;
+    const json::Dict* road_distances = nullptr;
+};
+
+/**Маршрут из base_requests*/
+struct BusRequest {
+    std::string_view name;
+    const json::Array* stops = nullptr;
+    bool is_roundtrip = false;
+};
+
+/**Сведения об остановке или маршруте по имени из stat_requests*/
+struct InfoRequest {
+    const json::Node* id = nullptr;
+    std::string_view name;
+};
+
+/**Поиск пути между остановками из stat_requests*/
+struct RouteRequest {
+    const json::Node* id = nullptr;
+    std::string_view from;
+    std::string_view to;
+};
+
+/**Карта из stat_requests*/
+struct MapRequest {
+    const json::Node* id = nullptr;
+    //Задан, если в запросе есть "bbox" или "zoom"
+    std::optional<Domain::MapViewport> viewport;
+};
+
+/**Ближайшие к точке остановки из stat_requests*/
+struct NearestStopsRequest {
+    const json::Node* id = nullptr;
+    Domain::geo::Coordinates point{};
+    size_t count = 0;
+};
+
+/**Остановки не дальше radius метров от точки из stat_requests*/
+struct RadiusRequest {
+    const json::Node* id = nullptr;
+    Domain::geo::Coordinates point{};
+    double radius = 0.;
+};
+
+/**Поиск остановок и маршрутов по началу имени из stat_requests*/
+struct SearchRequest {
+    static constexpr size_t DEFAULT_LIMIT = 10;
+    
+    const json::Node* id = nullptr;
+    std::string_view query;
+    size_t limit = DEFAULT_LIMIT;
+    bool fuzzy = false;
+};
+
+/**Отчет о памяти из stat_requests*/
+struct StatsRequest {
+    const json::Node* id = nullptr;
+};
+
+/**Удаление остановки или маршрута по имени из base_requests*/
+struct RemoveRequest {
+    std::string_view name;
+};
+
+/**Разбор запроса за один проход по ключам словаря. Проверки и тексты ошибок те же, что у поиска каждого ключа
+ * в словаре, и идут в том же порядке*/
+StopRequest DecodeStopRequest(const json::Node& node);
+BusRequest DecodeBusRequest(const json::Node& node);
+InfoRequest DecodeInfoRequest(const json::Node& node);
+RouteRequest DecodeRouteRequest(const json::Node& node);
+MapRequest DecodeMapRequest(const json::Node& node);
+NearestStopsRequest DecodeNearestStopsRequest(const json::Node& node);
+RadiusRequest DecodeRadiusRequest(const json::Node& node);
+SearchRequest DecodeSearchRequest(const json::Node& node);
+StatsRequest DecodeStatsRequest(const json::Node& node);
+RemoveRequest DecodeRemoveRequest(const json::Node& node);
+
+}
@@ -1,9 +1,29 @@
 #include <set>
+#include <sstream>
 #include <utility>
 #include <vector>
 #include "map_renderer.h"
 
 namespace TransportGuide::renderer {
+using namespace std::literals;
+
+//Постоянные значения атрибутов карты
+static const std::string_view NONE_COLOR = "none"sv;
+static const std::string_view STOP_CIRCLE_COLOR = "white"sv;
+static const std::string_view STOP_NAME_COLOR = "black"sv;
+static const std::string_view FONT_FAMILY = "Verdana"sv;
+static const std::string_view BUS_FONT_WEIGHT = "bold"sv;
+
+//Подложка названий маршрутов и остановок
+static svg::PathAttrs GetUnderlayerAttrs(const Domain::RenderSettings& settings) {
+    svg::PathAttrs attrs;
+    attrs.fill_color = settings.underlayer_color;
+    attrs.stroke_color = settings.underlayer_color;
+    attrs.stroke_width = settings.underlayer_width;
+    attrs.stroke_line_cap = svg::StrokeLineCap::ROUND;
+    attrs.stroke_line_join = svg::StrokeLineJoin::ROUND;
+    return attrs;
+}
 
 bool IsZero(double value) {
     return std::abs(value) < EPSILON;
@@ -15,22 +35,26 @@ svg::Point SphereProjector::operator()(Domain::geo::Coordinates coords) const {
 
 MapRenderer::MapRenderer(const TransportGuide::BusinessLogic::TransportCatalogue& catalogue) : catalogue_(catalogue) {}
 
-void MapRenderer::CreateDocument(const Domain::RenderSettings& settings) {
-    const std::unordered_map<std::string_view, Domain::Bus*>& bus_catalog = catalogue_.GetBusNameCatalog();
-    const std::unordered_map<std::string_view, Domain::Stop*>& stop_catalog = catalogue_.GetStopNameCatalog();
+void MapRenderer::CollectMapObjects(std::set<std::string_view>& buses, std::set<std::string_view>& stops) const {
+    const std::pmr::unordered_map<std::string_view, Domain::Bus*>& bus_catalog = catalogue_.GetBusNameCatalog();
     //Получаем все имена маршрутов
-    std::set<std::string_view> buses;
     for (const auto& [bus_name, bus_ptr] : bus_catalog) {
         if (!bus_ptr->route.empty()) { buses.insert(bus_name); }
     }
     //Получаем все остановки
-    std::set<std::string_view> stops;
     for(const  auto& bus_name : buses) {
         const Domain::Bus* bus_ptr = bus_catalog.at(bus_name);
         for(const auto& stop : bus_ptr->route){
             stops.insert(stop->name);
         }
     }
+}
+
+void MapRenderer::CreateDocument(const Domain::RenderSettings& settings) {
+    const std::pmr::unordered_map<std::string_view, Domain::Stop*>& stop_catalog = catalogue_.GetStopNameCatalog();
+    std::set<std::string_view> buses;
+    std::set<std::string_view> stops;
+    CollectMapObjects(buses, stops);
     //Получаем координаты всех остановок.
     std::vector<Domain::geo::Coordinates> stop_coordinates;
     for (auto stop_name : stops) {
@@ -42,154 +66,263 @@ void MapRenderer::CreateDocument(const Domain::RenderSettings& settings) {
     SphereProjector sphere_projector(stop_coordinates.begin(), stop_coordinates.end(), settings.width, settings.height,
             settings.padding);
     
-    //создаем документ svg
-    svg::Document document;
-    
-    CreatePolyline(document, settings, buses, sphere_projector);
-    CreateNameRoute(document, settings, buses, sphere_projector);
-    CreateCircle(document, settings, stop_coordinates, sphere_projector);
-    CreateNameStop(document, settings, stops, sphere_projector);
+    //Карта записывается сразу текстом, объекты элементов не создаются
+    std::string document;
+    document.reserve(document_.capacity());
+    {
+        svg::Writer writer(document);
+        writer.StartDocument();
+        WritePolyline(writer, settings, buses, sphere_projector);
+        WriteNameRoute(writer, settings, buses, sphere_projector);
+        WriteCircle(writer, settings, stop_coordinates, sphere_projector);
+        WriteNameStop(writer, settings, stops, sphere_projector);
+        writer.EndDocument();
+    }
     document_ = std::move(document);
+    json_document_.clear();
+    document_versions_.reset();
 }
 
 void MapRenderer::CreateDocument() {
     CreateDocument(render_settings_);
+    document_versions_ = {catalogue_.GetVersion(), settings_version_};
 }
 
-void MapRenderer::CreatePolyline(svg::Document& document, const Domain::RenderSettings& settings,
+void MapRenderer::WritePolyline(svg::Writer& writer, const Domain::RenderSettings& settings,
         const std::set<std::string_view>& buses, const SphereProjector& sphere_projector) {
-    const std::unordered_map<std::string_view, Domain::Bus*>& bus_catalog = catalogue_.GetBusNameCatalog();
+    const std::pmr::unordered_map<std::string_view, Domain::Bus*>& bus_catalog = catalogue_.GetBusNameCatalog();
     GetFollowingIt get_following_color(settings.color_palette);
+    svg::PathAttrs attrs;
+    attrs.fill_color = NONE_COLOR;
+    attrs.stroke_width = settings.line_width;
+    attrs.stroke_line_cap = svg::StrokeLineCap::ROUND;
+    attrs.stroke_line_join = svg::StrokeLineJoin::ROUND;
     
     for (const auto& bus_name : buses) {
         const Domain::Bus* bus_ptr = bus_catalog.at(bus_name);
         
-        std::unique_ptr<svg::Polyline> polyline = std::make_unique<svg::Polyline>();
-        std::vector<const Domain::Stop*> unique_route = bus_ptr->route;
-        unique_route.erase(std::unique(unique_route.begin(), unique_route.end()), unique_route.end());
-        for (auto stop : unique_route) {
-            svg::Point point = sphere_projector({stop->latitude, stop->longitude});
-            polyline->AddPoint(point);
+        writer.StartPolyline();
+        //Подряд идущие одинаковые остановки рисуются одной точкой, маршрут обходится без копирования
+        const Domain::Stop* previous_stop = nullptr;
+        for (const Domain::Stop* stop : bus_ptr->route) {
+            if (stop == previous_stop) { continue; }
+            previous_stop = stop;
+            writer.AddPoint(sphere_projector({stop->latitude, stop->longitude}));
         }
-        polyline->SetStrokeColor(get_following_color())
-                .SetFillColor(svg::NoneColor)
-                .SetStrokeWidth(settings.line_width)
-                .SetStrokeLineCap(svg::StrokeLineCap::ROUND)
-                .SetStrokeLineJoin(svg::StrokeLineJoin::ROUND);
-        
-        
-        document.AddPtr(std::move(polyline));
+        attrs.stroke_color = get_following_color();
+        writer.EndPolyline(attrs);
     }
 }
 
-void MapRenderer::CreateNameRoute(svg::Document& document, const Domain::RenderSettings& settings,
+void MapRenderer::WriteNameRoute(svg::Writer& writer, const Domain::RenderSettings& settings,
         const std::set<std::string_view>& buses, const SphereProjector& sphere_projector) {
-    const std::unordered_map<std::string_view, Domain::Bus*>& bus_catalog = catalogue_.GetBusNameCatalog();
+    const std::pmr::unordered_map<std::string_view, Domain::Bus*>& bus_catalog = catalogue_.GetBusNameCatalog();
     GetFollowingIt get_following_color(settings.color_palette);
-    
-    auto add_title_to_doc = [&](const Domain::Bus* bus_ptr) {
-        //добавляю координаты в пикселях
-        std::vector<svg::Point> stops_point;
-        std::vector<const Domain::Stop*> route = bus_ptr->GetForwardRoute();
-        stops_point.push_back(sphere_projector(
-                {route.front()->latitude, route.front()->longitude}));
-        if (!bus_ptr->IsRoundtrip() && route.front() != route.back()) {
-            stops_point.push_back(sphere_projector(
-                    {route.back()->latitude, route.back()->longitude}));
-        }
-        auto color = get_following_color();
-        for (auto point : stops_point) {
-            std::unique_ptr<svg::Text> route_name_background = std::make_unique<svg::Text>();
-            route_name_background->SetPosition(point)
-                               .SetOffset({settings.bus_label_offset.first, settings.bus_label_offset.second})
-                               .SetFontSize(settings.bus_label_font_size)
-                               .SetFontFamily("Verdana")
-                               .SetFontWeight("bold")
-                               .SetData(bus_ptr->name)
-                               .SetFillColor(settings.underlayer_color)
-                               .SetStrokeColor(settings.underlayer_color)
-                               .SetStrokeWidth(settings.underlayer_width)
-                               .SetStrokeLineCap(svg::StrokeLineCap::ROUND)
-                               .SetStrokeLineJoin(svg::StrokeLineJoin::ROUND);
-            document.AddPtr(std::move(route_name_background));
-            std::unique_ptr<svg::Text> route_name = std::make_unique<svg::Text>();
-            route_name->SetPosition(point)
-                      .SetOffset({settings.bus_label_offset.first, settings.bus_label_offset.second})
-                      .SetFontSize(settings.bus_label_font_size)
-                      .SetFontFamily("Verdana")
-                      .SetFontWeight("bold")
-                      .SetData(bus_ptr->name)
-                      .SetFillColor(color);
-            document.AddPtr(std::move(route_name));
-        }
-    };
+    const svg::Point offset{settings.bus_label_offset.first, settings.bus_label_offset.second};
+    const auto font_size = static_cast<uint32_t>(settings.bus_label_font_size);
+    const svg::PathAttrs background_attrs = GetUnderlayerAttrs(settings);
     
     for (const auto& bus_name : buses) {
         const Domain::Bus* bus_ptr = bus_catalog.at(bus_name);
-        add_title_to_doc(bus_ptr);
+        //Название выводится у первой остановки и у конечной, если маршрут не кольцевой
+        const Domain::Stop* first_stop = bus_ptr->route.front();
+        const Domain::Stop* last_stop = bus_ptr->GetForwardRoute().back();
+        svg::PathAttrs attrs;
+        attrs.fill_color = get_following_color();
+        const Domain::Stop* label_stops[] = {first_stop, last_stop};
+        const size_t label_count = !bus_ptr->IsRoundtrip() && first_stop != last_stop ? 2 : 1;
+        for (size_t i = 0; i < label_count; ++i) {
+            svg::Point point = sphere_projector({label_stops[i]->latitude, label_stops[i]->longitude});
+            writer.WriteText(point, offset, font_size, FONT_FAMILY, BUS_FONT_WEIGHT, bus_ptr->name, background_attrs)
+                  .WriteText(point, offset, font_size, FONT_FAMILY, BUS_FONT_WEIGHT, bus_ptr->name, attrs);
+        }
     }
 }
 
-void MapRenderer::CreateCircle(svg::Document& document, const Domain::RenderSettings& settings,
+void MapRenderer::WriteCircle(svg::Writer& writer, const Domain::RenderSettings& settings,
         const std::vector<Domain::geo::Coordinates>& stop_coordinates, const SphereProjector& sphere_projector) {
-    //добавляю координаты в пикселях
-    std::vector<svg::Point> stops_point;
+    svg::PathAttrs attrs;
+    attrs.fill_color = STOP_CIRCLE_COLOR;
     for (const auto& stop_coord : stop_coordinates) {
-        stops_point.push_back(sphere_projector(stop_coord));
-    }
-    for (auto point : stops_point) {
-        std::unique_ptr<svg::Circle> stop_circle = std::make_unique<svg::Circle>();
-        stop_circle->SetCenter(point).SetRadius(settings.stop_radius).SetFillColor("white");
-        document.AddPtr(std::move(stop_circle));
+        writer.WriteCircle(sphere_projector(stop_coord), settings.stop_radius, attrs);
     }
 }
 
-void MapRenderer::CreateNameStop(svg::Document& document, const Domain::RenderSettings& settings,
+void MapRenderer::WriteNameStop(svg::Writer& writer, const Domain::RenderSettings& settings,
         const std::set<std::string_view>& stops, const SphereProjector& sphere_projector) {
+    const std::pmr::unordered_map<std::string_view, Domain::Stop*>& stop_catalog = catalogue_.GetStopNameCatalog();
+    const svg::Point offset{settings.stop_label_offset.first, settings.stop_label_offset.second};
+    const auto font_size = static_cast<uint32_t>(settings.stop_label_font_size);
+    const svg::PathAttrs background_attrs = GetUnderlayerAttrs(settings);
+    svg::PathAttrs attrs;
+    attrs.fill_color = STOP_NAME_COLOR;
     
-    const std::unordered_map<std::string_view, Domain::Stop*>& stop_catalog = catalogue_.GetStopNameCatalog();
-    GetFollowingIt get_following_color(settings.color_palette);
-    
-    auto add_title_to_doc = [&](const Domain::Stop* stop_ptr) {
-        //добавляю координаты в пикселях
+    for (const auto& stop_name : stops) {
+        const Domain::Stop* stop_ptr = stop_catalog.at(stop_name);
         svg::Point point = sphere_projector({stop_ptr->latitude, stop_ptr->longitude});
+        writer.WriteText(point, offset, font_size, FONT_FAMILY, {}, stop_ptr->name, background_attrs)
+              .WriteText(point, offset, font_size, FONT_FAMILY, {}, stop_ptr->name, attrs);
+    }
+}
+
+const MapRenderer::MapLayout& MapRenderer::GetLayout() {
+    const std::pair<uint64_t, uint64_t> versions{catalogue_.GetVersion(), settings_version_};
+    if (layout_.versions == versions) { return layout_; }
+    
+    const std::pmr::unordered_map<std::string_view, Domain::Bus*>& bus_catalog = catalogue_.GetBusNameCatalog();
+    const std::pmr::unordered_map<std::string_view, Domain::Stop*>& stop_catalog = catalogue_.GetStopNameCatalog();
+    std::set<std::string_view> buses;
+    std::set<std::string_view> stops;
+    CollectMapObjects(buses, stops);
+    
+    MapLayout layout;
+    std::vector<Domain::geo::Coordinates> stop_coordinates;
+    stop_coordinates.reserve(stops.size());
+    layout.stops.reserve(stops.size());
+    for (auto stop_name : stops) {
+        const Domain::Stop* stop = stop_catalog.at(stop_name);
+        layout.stops.push_back(stop);
+        stop_coordinates.push_back(Domain::geo::Coordinates{stop->latitude, stop->longitude});
+    }
+    const Domain::RenderSettings& settings = render_settings_;
+    const SphereProjector& sphere_projector = layout.projector.emplace(stop_coordinates.begin(), stop_coordinates.end(),
+            settings.width, settings.height, settings.padding);
+    layout.stop_points.reserve(stop_coordinates.size());
+    for (const auto& stop_coord : stop_coordinates) {
+        layout.stop_points.push_back(sphere_projector(stop_coord));
+    }
+    
+    layout.buses.reserve(buses.size());
+    layout.bus_points.reserve(buses.size());
+    for (const auto& bus_name : buses) {
+        const Domain::Bus* bus_ptr = bus_catalog.at(bus_name);
+        std::vector<svg::Point>& points = layout.bus_points.emplace_back();
+        const Domain::Stop* previous_stop = nullptr;
+        for (const Domain::Stop* stop : bus_ptr->route) {
+            if (stop == previous_stop) { continue; }
+            previous_stop = stop;
+            points.push_back(sphere_projector({stop->latitude, stop->longitude}));
+        }
         
-        std::unique_ptr<svg::Text> stop_name_background = std::make_unique<svg::Text>();
-        stop_name_background->SetPosition(point)
-                            .SetOffset({settings.stop_label_offset.first, settings.stop_label_offset.second})
-                            .SetFontSize(settings.stop_label_font_size)
-                            .SetFontFamily("Verdana")
-                            .SetData(stop_ptr->name)
-                            .SetFillColor(settings.underlayer_color)
-                            .SetStrokeColor(settings.underlayer_color)
-                            .SetStrokeWidth(settings.underlayer_width)
-                            .SetStrokeLineCap(svg::StrokeLineCap::ROUND)
-                            .SetStrokeLineJoin(svg::StrokeLineJoin::ROUND);
-        document.AddPtr(std::move(stop_name_background));
-        
-        std::unique_ptr<svg::Text> stop_name_obj = std::make_unique<svg::Text>();
-        stop_name_obj->SetPosition(point)
-                     .SetOffset({settings.stop_label_offset.first, settings.stop_label_offset.second})
-                     .SetFontSize(settings.stop_label_font_size)
-                     .SetFontFamily("Verdana")
-                     .SetData(stop_ptr->name)
-                     .SetFillColor("black");
-        document.AddPtr(std::move(stop_name_obj));
+        MapLayout::LayoutBus& layout_bus = layout.buses.emplace_back();
+        layout_bus.bus = bus_ptr;
+        const Domain::Stop* first_stop = bus_ptr->route.front();
+        const Domain::Stop* last_stop = bus_ptr->GetForwardRoute().back();
+        layout_bus.labels[0] = sphere_projector({first_stop->latitude, first_stop->longitude});
+        layout_bus.labels[1] = sphere_projector({last_stop->latitude, last_stop->longitude});
+        layout_bus.label_count = !bus_ptr->IsRoundtrip() && first_stop != last_stop ? 2 : 1;
+    }
+    layout.index = MapSpatialIndex(layout.stop_points, layout.bus_points);
+    layout.versions = versions;
+    layout_ = std::move(layout);
+    return layout_;
+}
+
+std::string MapRenderer::RenderViewport(const Domain::MapViewport& viewport) {
+    const MapLayout& layout = GetLayout();
+    const Domain::RenderSettings& settings = render_settings_;
+    
+    MapRect rect{{0., 0.}, {settings.width, settings.height}};
+    if (viewport.bbox.has_value()) {
+        //Широта растет на север, а y проекции - на юг, поэтому углы окна переставляются
+        svg::Point south_west = (*layout.projector)(viewport.bbox->first);
+        svg::Point north_east = (*layout.projector)(viewport.bbox->second);
+        rect = {{south_west.x, north_east.y}, {north_east.x, south_west.y}};
+    }
+    const double zoom = viewport.zoom;
+    auto transform = [&rect, zoom](svg::Point point) {
+        return svg::Point{(point.x - rect.min.x) * zoom, (point.y - rect.min.y) * zoom};
     };
+    const std::vector<MapSpatialIndex::Segment> segments = layout.index.FindSegments(rect);
+    const std::vector<uint32_t> stops = layout.index.FindStops(rect);
     
-    for (const auto& stop_name : stops) {
-        const Domain::Stop* stop_ptr = stop_catalog.at(stop_name);
-        add_title_to_doc(stop_ptr);
+    std::string document;
+    svg::Writer writer(document);
+    writer.StartDocument();
+    //Линии маршрутов: подряд идущие видимые отрезки маршрута рисуются одной ломаной
+    const std::vector<std::string>& palette = settings.color_palette;
+    svg::PathAttrs line_attrs;
+    line_attrs.fill_color = NONE_COLOR;
+    line_attrs.stroke_width = settings.line_width;
+    line_attrs.stroke_line_cap = svg::StrokeLineCap::ROUND;
+    line_attrs.stroke_line_join = svg::StrokeLineJoin::ROUND;
+    for (size_t i = 0; i < segments.size();) {
+        const uint32_t bus = segments[i].bus;
+        const std::vector<svg::Point>& points = layout.bus_points[bus];
+        uint32_t last_position = segments[i].position;
+        writer.StartPolyline().AddPoint(transform(points[last_position]));
+        do {
+            if (last_position + 1 < points.size()) { writer.AddPoint(transform(points[last_position + 1])); }
+            ++i;
+        } while (i < segments.size() && segments[i].bus == bus && segments[i].position == ++last_position);
+        line_attrs.stroke_color = palette[bus % palette.size()];
+        writer.EndPolyline(line_attrs);
+    }
+    
+    //Названия маршрутов у видимых конечных остановок
+    const svg::Point bus_offset{settings.bus_label_offset.first, settings.bus_label_offset.second};
+    const auto bus_font_size = static_cast<uint32_t>(settings.bus_label_font_size);
+    const svg::PathAttrs background_attrs = GetUnderlayerAttrs(settings);
+    for (size_t bus = 0; bus < layout.buses.size(); ++bus) {
+        const MapLayout::LayoutBus& layout_bus = layout.buses[bus];
+        svg::PathAttrs attrs;
+        attrs.fill_color = palette[bus % palette.size()];
+        for (size_t i = 0; i < layout_bus.label_count; ++i) {
+            if (!rect.Contains(layout_bus.labels[i])) { continue; }
+            svg::Point point = transform(layout_bus.labels[i]);
+            writer.WriteText(point, bus_offset, bus_font_size, FONT_FAMILY, BUS_FONT_WEIGHT, layout_bus.bus->name,
+                            background_attrs)
+                  .WriteText(point, bus_offset, bus_font_size, FONT_FAMILY, BUS_FONT_WEIGHT, layout_bus.bus->name, attrs);
+        }
     }
     
+    //Видимые остановки и их названия
+    svg::PathAttrs circle_attrs;
+    circle_attrs.fill_color = STOP_CIRCLE_COLOR;
+    for (uint32_t stop : stops) {
+        writer.WriteCircle(transform(layout.stop_points[stop]), settings.stop_radius, circle_attrs);
+    }
+    const svg::Point stop_offset{settings.stop_label_offset.first, settings.stop_label_offset.second};
+    const auto stop_font_size = static_cast<uint32_t>(settings.stop_label_font_size);
+    svg::PathAttrs name_attrs;
+    name_attrs.fill_color = STOP_NAME_COLOR;
+    for (uint32_t stop : stops) {
+        svg::Point point = transform(layout.stop_points[stop]);
+        writer.WriteText(point, stop_offset, stop_font_size, FONT_FAMILY, {}, layout.stops[stop]->name, background_attrs)
+              .WriteText(point, stop_offset, stop_font_size, FONT_FAMILY, {}, layout.stops[stop]->name, name_attrs);
+    }
+    writer.EndDocument();
+    writer.Flush();
+    return document;
 }
 
 void MapRenderer::Render(std::ostream& out) {
-    document_.Render(out);
+    out << document_;
+}
+
+const std::string& MapRenderer::GetSvg() {
+    if (!document_versions_.has_value() || document_versions_->first != catalogue_.GetVersion()
+            || document_versions_->second != settings_version_) {
+        CreateDocument();
+    }
+    return document_;
+}
+
+const std::string& MapRenderer::GetJsonSvg() {
+    const std::string& svg = GetSvg();
+    if (json_document_.empty()) {
+        json::AppendEscapedString(json_document_, svg);
+    }
+    return json_document_;
+}
+
+size_t MapRenderer::GetDocumentMemoryUsage() const {
+    return memory::MeasureString(document_) + memory::MeasureString(json_document_) + layout_.index.GetMemoryUsage();
 }
 
 void MapRenderer::SetRenderSettings(Domain::RenderSettings render_settings) {
     render_settings_ = std::forward<Domain::RenderSettings>(render_settings);
+    ++settings_version_;
 }
 
 Domain::RenderSettings MapRenderer::GetRenderSettings() const {
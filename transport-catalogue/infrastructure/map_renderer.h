@@ -2,11 +2,14 @@
 #include "../domain/geo.h"
 #include "../external/svg.h"
 #include "../business_logic/transport_catalogue.h"
+#include "../external/json.h"
+#include "map_spatial_index.h"
 
 #include <algorithm>
 #include <cstdlib>
 #include <iostream>
 #include <optional>
+#include <string>
 #include <vector>
 #include <set>
 
@@ -84,22 +87,61 @@ public:
     void CreateDocument(const Domain::RenderSettings& settings);
     void CreateDocument();
     void Render(std::ostream& out);
+    /**Отрисованная по текущим настройкам карта. Документ строится и выводится заново, только если
+     * каталог или настройки изменились после прошлой отрисовки, иначе возвращается сохраненный текст*/
+    const std::string& GetSvg();
+    /**Карта из GetSvg в виде строкового значения JSON, экранируется один раз на версию карты*/
+    const std::string& GetJsonSvg();
+    /**Часть карты в окне просмотра: только остановки и отрезки маршрутов, пересекающие окно, выбранные через
+     * пространственный индекс. Координаты отсчитываются от угла окна и умножаются на масштаб.
+     * Без bbox окно - вся карта, и при масштабе 1 результат совпадает с GetSvg*/
+    std::string RenderViewport(const Domain::MapViewport& viewport);
     void SetRenderSettings(Domain::RenderSettings render_settings);
     Domain::RenderSettings GetRenderSettings() const;
+    /**Байты в куче, занятые текстом последней построенной карты, его JSON-формой и индексом окон просмотра*/
+    size_t GetDocumentMemoryUsage() const;
 
 private:
     const BusinessLogic::TransportCatalogue& catalogue_;
     Domain::RenderSettings render_settings_;
-    svg::Document document_;
+    //Текст последней построенной карты и его экранированная для JSON форма, она строится по запросу
+    std::string document_;
+    std::string json_document_;
+    uint64_t settings_version_ = 0;
+    //Версии каталога и настроек, по которым построен document_, пусто - карта построена по другим настройкам
+    std::optional<std::pair<uint64_t, uint64_t>> document_versions_;
+    
+    /**Спроецированная сеть для окон просмотра, порядок маршрутов и остановок тот же, что на полной карте*/
+    struct MapLayout {
+        struct LayoutBus {
+            const Domain::Bus* bus = nullptr;
+            //Точки подписей у конечных остановок
+            svg::Point labels[2];
+            size_t label_count = 1;
+        };
+        
+        std::optional<SphereProjector> projector;
+        std::vector<LayoutBus> buses;
+        //Вершины ломаных маршрутов без подряд идущих повторов
+        std::vector<std::vector<svg::Point>> bus_points;
+        std::vector<const Domain::Stop*> stops;
+        std::vector<svg::Point> stop_points;
+        MapSpatialIndex index;
+        std::optional<std::pair<uint64_t, uint64_t>> versions;
+    };
+    MapLayout layout_;
     
 private:
-    void CreatePolyline(svg::Document& document, const Domain::RenderSettings& settings, const std::set<std::string_view>& buses,
-            const SphereProjector& sphere_projector);
-    void CreateNameRoute(svg::Document& document, const Domain::RenderSettings& settings,
+    /**Маршруты с остановками и остановки на них в порядке имен*/
+    void CollectMapObjects(std::set<std::string_view>& buses, std::set<std::string_view>& stops) const;
+    const MapLayout& GetLayout();
+    void WritePolyline(svg::Writer& writer, const Domain::RenderSettings& settings,
+            const std::set<std::string_view>& buses, const SphereProjector& sphere_projector);
+    void WriteNameRoute(svg::Writer& writer, const Domain::RenderSettings& settings,
             const std::set<std::string_view>& buses, const SphereProjector& sphere_projector);
-    void CreateCircle(svg::Document& document, const Domain::RenderSettings& settings,
+    void WriteCircle(svg::Writer& writer, const Domain::RenderSettings& settings,
             const std::vector<Domain::geo::Coordinates>& stop_coordinates, const SphereProjector& sphere_projector);
-    void CreateNameStop(svg::Document& document, const Domain::RenderSettings& settings,
+    void WriteNameStop(svg::Writer& writer, const Domain::RenderSettings& settings,
             const std::set<std::string_view>& stops, const SphereProjector& sphere_projector);
 };
 
@@ -110,7 +152,7 @@ public:
         position_ = 0;
     }
     
-    auto operator()() {
+    const typename Container::value_type& operator()() {
         typename Container::const_iterator it = std::next(container_.begin(), position_);
         if (it == container_.end()) {
             position_ = 0;
@@ -0,0 +1,169 @@
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include "map_spatial_index.h"
+#include "../external/memory_counter.h"
+
+namespace TransportGuide::renderer {
+
+//Среднее количество объектов (остановок и отрезков) в ячейке
+static const size_t ITEMS_PER_CELL = 4;
+
+bool MapRect::Contains(svg::Point point) const {
+    return point.x >= min.x && point.x <= max.x && point.y >= min.y && point.y <= max.y;
+}
+
+//Отсечение отрезка по Лиангу - Барски
+bool MapRect::Intersects(svg::Point from, svg::Point to) const {
+    double t_begin = 0.;
+    double t_end = 1.;
+    const double delta_x = to.x - from.x;
+    const double delta_y = to.y - from.y;
+    auto clip = [&t_begin, &t_end](double p, double q) {
+        if (p == 0.) { return q >= 0.; }
+        double t = q / p;
+        if (p < 0.) {
+            t_begin = std::max(t_begin, t);
+        }
+        else {
+            t_end = std::min(t_end, t);
+        }
+        return t_begin <= t_end;
+    };
+    return clip(-delta_x, from.x - min.x) && clip(delta_x, max.x - from.x)
+            && clip(-delta_y, from.y - min.y) && clip(delta_y, max.y - from.y);
+}
+
+bool MapSpatialIndex::Segment::operator<(const Segment& rhs) const {
+    return bus < rhs.bus || (bus == rhs.bus && position < rhs.position);
+}
+
+bool MapSpatialIndex::Segment::operator==(const Segment& rhs) const {
+    return bus == rhs.bus && position == rhs.position;
+}
+
+MapSpatialIndex::MapSpatialIndex(const std::vector<svg::Point>& stop_points,
+        const std::vector<std::vector<svg::Point>>& bus_points) {
+    std::vector<IndexedSegment> segments;
+    for (uint32_t bus = 0; bus < bus_points.size(); ++bus) {
+        const std::vector<svg::Point>& points = bus_points[bus];
+        if (points.size() == 1) {
+            segments.push_back({points.front(), points.front(), {bus, 0}});
+        }
+        for (uint32_t position = 0; position + 1 < points.size(); ++position) {
+            segments.push_back({points[position], points[position + 1], {bus, position}});
+        }
+    }
+    if (stop_points.empty() && segments.empty()) { return; }
+    
+    //Границы сетки - габарит всех объектов
+    bounds_.min = {std::numeric_limits<double>::max(), std::numeric_limits<double>::max()};
+    bounds_.max = {std::numeric_limits<double>::lowest(), std::numeric_limits<double>::lowest()};
+    auto extend = [this](svg::Point point) {
+        bounds_.min = {std::min(bounds_.min.x, point.x), std::min(bounds_.min.y, point.y)};
+        bounds_.max = {std::max(bounds_.max.x, point.x), std::max(bounds_.max.y, point.y)};
+    };
+    std::for_each(stop_points.begin(), stop_points.end(), extend);
+    for (const IndexedSegment& segment : segments) {
+        extend(segment.from);
+        extend(segment.to);
+    }
+    const double width = std::max(bounds_.max.x - bounds_.min.x, 1e-9);
+    const double height = std::max(bounds_.max.y - bounds_.min.y, 1e-9);
+    
+    size_t cells_count = std::max<size_t>(1, (stop_points.size() + segments.size()) / ITEMS_PER_CELL);
+    cols_ = static_cast<uint32_t>(std::clamp(std::round(std::sqrt(cells_count * width / height)), 1., double(cells_count)));
+    rows_ = static_cast<uint32_t>(std::clamp(std::ceil(double(cells_count) / cols_), 1., double(cells_count)));
+    cell_width_ = width / cols_;
+    cell_height_ = height / rows_;
+    
+    //Раскладываю объекты по ячейкам подсчетом: первый проход считает, второй заполняет
+    const size_t cell_count = static_cast<size_t>(rows_) * cols_;
+    stop_offsets_.assign(cell_count + 1, 0);
+    for (const svg::Point& point : stop_points) {
+        ++stop_offsets_[GetRow(point.y) * cols_ + GetCol(point.x) + 1];
+    }
+    std::partial_sum(stop_offsets_.begin(), stop_offsets_.end(), stop_offsets_.begin());
+    cell_stops_.resize(stop_points.size());
+    std::vector<uint32_t> cell_fill(stop_offsets_.begin(), std::prev(stop_offsets_.end()));
+    for (uint32_t id = 0; id < stop_points.size(); ++id) {
+        const svg::Point& point = stop_points[id];
+        cell_stops_[cell_fill[GetRow(point.y) * cols_ + GetCol(point.x)]++] = {point, id};
+    }
+    
+    auto get_box = [](const IndexedSegment& segment) {
+        return MapRect{{std::min(segment.from.x, segment.to.x), std::min(segment.from.y, segment.to.y)},
+                       {std::max(segment.from.x, segment.to.x), std::max(segment.from.y, segment.to.y)}};
+    };
+    segment_offsets_.assign(cell_count + 1, 0);
+    for (const IndexedSegment& segment : segments) {
+        VisitCells(get_box(segment), [this](size_t cell) { ++segment_offsets_[cell + 1]; });
+    }
+    std::partial_sum(segment_offsets_.begin(), segment_offsets_.end(), segment_offsets_.begin());
+    cell_segments_.resize(segment_offsets_.back());
+    cell_fill.assign(segment_offsets_.begin(), std::prev(segment_offsets_.end()));
+    for (const IndexedSegment& segment : segments) {
+        VisitCells(get_box(segment), [this, &cell_fill, &segment](size_t cell) {
+            cell_segments_[cell_fill[cell]++] = segment;
+        });
+    }
+}
+
+std::vector<uint32_t> MapSpatialIndex::FindStops(const MapRect& rect) const {
+    std::vector<uint32_t> result;
+    if (cell_stops_.empty()) { return result; }
+    VisitCells(rect, [this, &rect, &result](size_t cell) {
+        for (uint32_t i = stop_offsets_[cell]; i < stop_offsets_[cell + 1]; ++i) {
+            if (rect.Contains(cell_stops_[i].point)) {
+                result.push_back(cell_stops_[i].id);
+            }
+        }
+    });
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+std::vector<MapSpatialIndex::Segment> MapSpatialIndex::FindSegments(const MapRect& rect) const {
+    std::vector<Segment> result;
+    if (cell_segments_.empty()) { return result; }
+    VisitCells(rect, [this, &rect, &result](size_t cell) {
+        for (uint32_t i = segment_offsets_[cell]; i < segment_offsets_[cell + 1]; ++i) {
+            if (rect.Intersects(cell_segments_[i].from, cell_segments_[i].to)) {
+                result.push_back(cell_segments_[i].segment);
+            }
+        }
+    });
+    //Длинный отрезок лежит в нескольких ячейках окна
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    return result;
+}
+
+size_t MapSpatialIndex::GetMemoryUsage() const {
+    return memory::MeasureVector(stop_offsets_) + memory::MeasureVector(cell_stops_)
+            + memory::MeasureVector(segment_offsets_) + memory::MeasureVector(cell_segments_);
+}
+
+uint32_t MapSpatialIndex::GetCol(double x) const {
+    return static_cast<uint32_t>(std::clamp<int64_t>(std::floor((x - bounds_.min.x) / cell_width_), 0, cols_ - 1));
+}
+
+uint32_t MapSpatialIndex::GetRow(double y) const {
+    return static_cast<uint32_t>(std::clamp<int64_t>(std::floor((y - bounds_.min.y) / cell_height_), 0, rows_ - 1));
+}
+
+template<typename Visitor>
+void MapSpatialIndex::VisitCells(const MapRect& rect, Visitor visitor) const {
+    //Окно вне сетки не накрывает ни одной ячейки
+    if (rect.max.x < bounds_.min.x || rect.min.x > bounds_.max.x || rect.max.y < bounds_.min.y
+            || rect.min.y > bounds_.max.y) { return; }
+    const uint32_t col_end = GetCol(rect.max.x) + 1;
+    const uint32_t row_end = GetRow(rect.max.y) + 1;
+    for (uint32_t row = GetRow(rect.min.y); row < row_end; ++row) {
+        for (uint32_t col = GetCol(rect.min.x); col < col_end; ++col) {
+            visitor(static_cast<size_t>(row) * cols_ + col);
+        }
+    }
+}
+
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "../external/svg.h"
+
+namespace TransportGuide::renderer {
+
+/**Прямоугольник в координатах svg, границы входят в него*/
+struct MapRect {
+    svg::Point min;
+    svg::Point max;
+    
+    bool Contains(svg::Point point) const;
+    /**Пересекает ли прямоугольник отрезок from - to*/
+    bool Intersects(svg::Point from, svg::Point to) const;
+};
+
+/**Пространственный индекс карты: равномерная сетка в координатах проекции всей сети.
+ * Ячейки хранятся в формате CSR, как у StopSpatialIndex. Остановка лежит в одной ячейке, отрезок маршрута -
+ * во всех ячейках, которые накрывает его габарит. Поиск обходит ячейки окна и проверяет попадание точно*/
+class MapSpatialIndex final {
+public:
+    /**Отрезок маршрута bus между вершинами position и position + 1.
+     * Маршрут из одной вершины представлен отрезком нулевой длины с position = 0*/
+    struct Segment {
+        uint32_t bus = 0;
+        uint32_t position = 0;
+        
+        bool operator<(const Segment& rhs) const;
+        bool operator==(const Segment& rhs) const;
+    };
+    
+    MapSpatialIndex() = default;
+    /**stop_points - точки остановок, bus_points - вершины ломаных маршрутов, номера в результатах поиска
+     * это позиции в этих списках*/
+    MapSpatialIndex(const std::vector<svg::Point>& stop_points, const std::vector<std::vector<svg::Point>>& bus_points);
+    
+    /**Номера остановок внутри прямоугольника по возрастанию*/
+    std::vector<uint32_t> FindStops(const MapRect& rect) const;
+    /**Отрезки, пересекающие прямоугольник, по маршруту и позиции*/
+    std::vector<Segment> FindSegments(const MapRect& rect) const;
+    /**Байты в куче, занятые ячейками сетки*/
+    size_t GetMemoryUsage() const;
+
+private:
+    struct IndexedStop {
+        svg::Point point;
+        uint32_t id;
+    };
+    
+    struct IndexedSegment {
+        svg::Point from;
+        svg::Point to;
+        Segment segment;
+    };
+    
+    MapRect bounds_;
+    double cell_width_ = 1;
+    double cell_height_ = 1;
+    uint32_t rows_ = 0;
+    uint32_t cols_ = 0;
+    std::vector<uint32_t> stop_offsets_;
+    std::vector<IndexedStop> cell_stops_;
+    std::vector<uint32_t> segment_offsets_;
+    std::vector<IndexedSegment> cell_segments_;
+    
+    uint32_t GetCol(double x) const;
+    uint32_t GetRow(double y) const;
+    /**Вызвать visitor для каждой ячейки, которую накрывает прямоугольник*/
+    template<typename Visitor>
+    void VisitCells(const MapRect& rect, Visitor visitor) const;
+};
+
+}
@@ -0,0 +1,113 @@
+#include "memory_stats.h"
+#include "../external/memory_counter.h"
+
+namespace TransportGuide::IoRequests {
+using namespace std::literals;
+
+void MemoryReport::Add(std::string name, size_t bytes) {
+    total_bytes += bytes;
+    structures.emplace_back(std::move(name), bytes);
+}
+
+MemoryStats::MemoryStats(BusinessLogic::TransportCatalogue& transport_catalogue, renderer::MapRenderer& map_renderer)
+        : transport_catalogue_(transport_catalogue), map_renderer_(map_renderer) {}
+
+MemoryReport MemoryStats::Collect() {
+    MemoryReport report;
+    BusinessLogic::SerializerTransportCatalogue serializer_catalogue(transport_catalogue_);
+    CollectCatalogue(report, serializer_catalogue);
+    CollectRouter(report, serializer_catalogue);
+    CollectRenderer(report);
+    return report;
+}
+
+void MemoryStats::CollectCatalogue(MemoryReport& report,
+        BusinessLogic::SerializerTransportCatalogue& serializer_catalogue) {
+    //Деки вместе с именами и маршрутами, которыми владеют элементы
+    const auto& stop_catalog = serializer_catalogue.GetStopCatalog();
+    size_t stops_bytes = memory::MeasureDeque(stop_catalog);
+    for (const Domain::Stop& stop : stop_catalog) {
+        stops_bytes += memory::MeasureString(stop.name);
+    }
+    report.Add("catalogue.stops"s, stops_bytes);
+    
+    const auto& bus_catalog = serializer_catalogue.GetBusCatalog();
+    size_t buses_bytes = memory::MeasureDeque(bus_catalog);
+    for (const Domain::Bus& bus : bus_catalog) {
+        buses_bytes += memory::MeasureString(bus.name);
+    }
+    report.Add("catalogue.buses"s, buses_bytes);
+    report.Add("catalogue.route_pool"s, serializer_catalogue.GetRoutePool().GetMemoryUsage());
+    
+    report.Add("catalogue.stop_name_catalog"s, memory::MeasureUnorderedMap(serializer_catalogue.GetStopNameCatalog()));
+    report.Add("catalogue.bus_name_catalog"s, memory::MeasureUnorderedMap(serializer_catalogue.GetBusNameCatalog()));
+    size_t name_lookup_bytes = 0;
+    if (serializer_catalogue.GetStopNameLookup()) {
+        name_lookup_bytes += serializer_catalogue.GetStopNameLookup()->GetMemoryUsage();
+    }
+    if (serializer_catalogue.GetBusNameLookup()) {
+        name_lookup_bytes += serializer_catalogue.GetBusNameLookup()->GetMemoryUsage();
+    }
+    report.Add("catalogue.name_lookup"s, name_lookup_bytes);
+    report.Add("catalogue.calculated_distance_catalog"s,
+            memory::MeasureUnorderedMap(serializer_catalogue.GetCalculatedDistanceCatalog()));
+    report.Add("catalogue.real_distance_catalog"s,
+            memory::MeasureUnorderedMap(serializer_catalogue.GetRealDistanceCatalog()));
+    
+    //Словарь остановка -> маршруты вместе с вложенными множествами
+    const auto& stop_buses_catalog = serializer_catalogue.GetStopBusesCatalog();
+    size_t stop_buses_bytes = memory::MeasureUnorderedMap(stop_buses_catalog);
+    for (const auto& [stop, buses] : stop_buses_catalog) {
+        stop_buses_bytes += memory::MeasureUnorderedSet(buses);
+    }
+    report.Add("catalogue.stop_buses_catalog"s, stop_buses_bytes);
+    
+    auto snapshot = transport_catalogue_.GetSnapshot();
+    report.Add("catalogue.snapshot"s, snapshot ? snapshot->GetMemoryUsage() : 0);
+}
+
+void MemoryStats::CollectRouter(MemoryReport& report,
+        BusinessLogic::SerializerTransportCatalogue& serializer_catalogue) {
+    size_t graph_bytes = 0;
+    size_t stop_to_vertex_bytes = 0;
+    size_t edge_to_info_bytes = 0;
+    size_t router_bytes = 0;
+    
+    //Маршрутизатор может быть не построен, тогда структуры попадают в отчет с нулевым размером
+    if (serializer_catalogue.GetUserRouteManager().has_value()) {
+        BusinessLogic::SerializerTransportRouter serializer_transport_router(
+                serializer_catalogue.GetUserRouteManager().value());
+        
+        graph::DirectedWeightedGraph<Domain::TimeMinuts>::SerializerDirectedWeightedGraph serializer_graph(
+                serializer_transport_router.GetGraph());
+        graph_bytes = memory::MeasureVector(serializer_graph.GetEdges())
+                + memory::MeasureVector(serializer_graph.GetIncidenceLists());
+        for (const auto& incidence_list : serializer_graph.GetIncidenceLists()) {
+            graph_bytes += memory::MeasureVector(incidence_list);
+        }
+        
+        stop_to_vertex_bytes = memory::MeasureUnorderedMap(serializer_transport_router.GetGraphStopToVertexIdCatalog());
+        edge_to_info_bytes = memory::MeasureUnorderedMap(serializer_transport_router.GetGraphEdgeIdToInfoCatalog());
+        
+        auto& router = serializer_transport_router.GetRouter();
+        if (router.has_value()) {
+            graph::Router<Domain::TimeMinuts>::SerializerRouter serializer_router(router.value());
+            const auto& routes_internal_data = serializer_router.GetRoutesInternalData();
+            router_bytes = memory::MeasureVector(routes_internal_data);
+            for (const auto& row : routes_internal_data) {
+                router_bytes += memory::MeasureVector(row);
+            }
+        }
+    }
+    
+    report.Add("router.graph"s, graph_bytes);
+    report.Add("router.stop_to_vertex_id_catalog"s, stop_to_vertex_bytes);
+    report.Add("router.edge_id_to_info_catalog"s, edge_to_info_bytes);
+    report.Add("router.routes_internal_data"s, router_bytes);
+}
+
+void MemoryStats::CollectRenderer(MemoryReport& report) {
+    report.Add("renderer.document"s, map_renderer_.GetDocumentMemoryUsage());
+}
+
+}
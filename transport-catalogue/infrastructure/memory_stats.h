@@ -0,0 +1,38 @@
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+#include "../business_logic/transport_catalogue.h"
+#include "../business_logic/transport_router.h"
+#include "map_renderer.h"
+
+namespace TransportGuide::IoRequests {
+
+/**Отчет о памяти: байты в куче по каждой структуре данных в порядке обхода*/
+struct MemoryReport {
+    std::vector<std::pair<std::string, size_t>> structures;
+    size_t total_bytes = 0;
+    
+    void Add(std::string name, size_t bytes);
+};
+
+/**Подсчет памяти каталога, маршрутизатора и svg-документа рендера.
+ * Контейнеры не копируются: размер хеш-таблицы - узлы на размер узла плюс корзины, размер узла берется
+ * из счетчика аллокатора на пробной таблице, дека - блоки и карта блоков*/
+class MemoryStats final {
+public:
+    explicit MemoryStats(BusinessLogic::TransportCatalogue& transport_catalogue, renderer::MapRenderer& map_renderer);
+    
+    MemoryReport Collect();
+
+private:
+    BusinessLogic::TransportCatalogue& transport_catalogue_;
+    renderer::MapRenderer& map_renderer_;
+    
+    void CollectCatalogue(MemoryReport& report, BusinessLogic::SerializerTransportCatalogue& serializer_catalogue);
+    void CollectRouter(MemoryReport& report, BusinessLogic::SerializerTransportCatalogue& serializer_catalogue);
+    void CollectRenderer(MemoryReport& report);
+};
+
+}
@@ -7,6 +7,10 @@ TransportGuide::IoRequests::ProtoSerialization::ProtoSerialization(
 
 void TransportGuide::IoRequests::ProtoSerialization::Serialize([[maybe_unused]]std::ostream& output) {
     //Декомпозировал методы сериализации и десериализации каталога, в main писал ремарку, можно узнать, как правильно?
+    //Идентификаторы в файле - позиции в хранилищах, удаленные объекты должны быть убраны до сериализации
+    if (transport_catalogue_.GetRemovedCount()) {
+        throw std::logic_error("TransportCatalogue must be compacted before serialization.");
+    }
     Serialization::TransportCatalogue result_catalogue;
     
     BusinessLogic::SerializerTransportCatalogue serializer_catalogue(transport_catalogue_);
@@ -20,6 +24,11 @@ void TransportGuide::IoRequests::ProtoSerialization::Serialize([[maybe_unused]]s
     SerializerRealDistanceCatalog(result_catalogue, serializer_catalogue);
     // Сериализация настроек рендера
     SerializerRenderSettings(result_catalogue);
+    // Сериализация хеш-таблиц имен, id в таблицах совпадают с порядком остановок и маршрутов в файле
+    if (serializer_catalogue.GetStopNameLookup() && serializer_catalogue.GetBusNameLookup()) {
+        SerializerNameLookup(*result_catalogue.mutable_stop_name_lookup(), *serializer_catalogue.GetStopNameLookup());
+        SerializerNameLookup(*result_catalogue.mutable_bus_name_lookup(), *serializer_catalogue.GetBusNameLookup());
+    }
     
     //Если есть UserRouteManager
     if (serializer_catalogue.GetUserRouteManager().has_value()) {
@@ -52,6 +61,7 @@ void TransportGuide::IoRequests::ProtoSerialization::Deserialize([[maybe_unused]
     Serialization::TransportCatalogue parsed_catalog;
     
     BusinessLogic::SerializerTransportCatalogue serializer_catalogue(transport_catalogue_);
+    serializer_catalogue.MarkChanged();
     
     std::map<uint64_t, const Domain::Stop*> temp_stops_catalog;
     std::map<uint64_t, const Domain::Bus*> temp_buses_catalog;
@@ -66,6 +76,17 @@ void TransportGuide::IoRequests::ProtoSerialization::Deserialize([[maybe_unused]
     DeserializerCalculatedDistanceCatalog(parsed_catalog, serializer_catalogue, temp_stops_catalog);
     //Заполняем каталог реальных расстояний
     DeserializerRealDistanceCatalog(parsed_catalog, serializer_catalogue, temp_stops_catalog);
+    //Восстанавливаем хеш-таблицы имен, базы без таблиц или с несогласованными таблицами ищут по словарям
+    if (parsed_catalog.has_stop_name_lookup() && parsed_catalog.has_bus_name_lookup()) {
+        auto stop_name_lookup = DeserializerNameLookup(parsed_catalog.stop_name_lookup(),
+                serializer_catalogue.GetStopCatalog().size());
+        auto bus_name_lookup = DeserializerNameLookup(parsed_catalog.bus_name_lookup(),
+                serializer_catalogue.GetBusCatalog().size());
+        if (stop_name_lookup && bus_name_lookup) {
+            serializer_catalogue.GetStopNameLookup() = std::move(stop_name_lookup);
+            serializer_catalogue.GetBusNameLookup() = std::move(bus_name_lookup);
+        }
+    }
     
     //Если есть настройки маршрутов, зполняем менеджер маршрутов
     if (parsed_catalog.has_user_route_manager()) {
@@ -370,8 +391,9 @@ void TransportGuide::IoRequests::ProtoSerialization::DeserializerGraph(
         serializer_graph.GetEdges().push_back({edge.from(), edge.to(), edge.weight()});
     }
     for (const auto& parsed_incidence_list : parsed_user_route_manager.graph().incidence_lists()) {
-        std::__debug::vector<graph::EdgeId> incidence_list_edges(parsed_incidence_list.edge_id().begin(),parsed_incidence_list.edge_id().end());
-        serializer_graph.GetIncidenceLists().push_back(std::move(incidence_list_edges));
+        //Список смежности создается на месте и получает ресурс памяти графа
+        serializer_graph.GetIncidenceLists().emplace_back(parsed_incidence_list.edge_id().begin(),
+                parsed_incidence_list.edge_id().end());
     }
 }
 
@@ -388,7 +410,7 @@ TransportGuide::BusinessLogic::SerializerTransportRouter TransportGuide::IoReque
             transport_catalogue_));
     BusinessLogic::SerializerTransportRouter serializer_transport_router (*serializer_catalogue.GetUserRouteManager());
     {
-        graph::DirectedWeightedGraph<Domain::TimeMinuts> graph;
+        graph::DirectedWeightedGraph<Domain::TimeMinuts> graph(transport_catalogue_.GetMemoryResource());
         serializer_transport_router.GetGraph() = std::move(graph);
         graph::Router<Domain::TimeMinuts> router = graph::Router<double>::SerializerRouter::Construct(serializer_transport_router.GetGraph(), {});
         serializer_transport_router.GetRouter().emplace(std::move(router));
@@ -430,8 +452,10 @@ void TransportGuide::IoRequests::ProtoSerialization::DeserializerBusCatalog(
         }
         // создаем маршрут
         Domain::Bus* b_ptr = &serializer_catalogue.GetBusCatalog()
-                                                  .emplace_back(bus.name(), route, bus.number_final_stop(),
-                                                          bus.calc_length(), bus.real_length());
+                                                  .emplace_back(bus.name(),
+                                                          Domain::RoutePool::Intern(serializer_catalogue.GetRoutePool(),
+                                                                  route, bus.number_final_stop()),
+                                                          bus.number_final_stop(), bus.calc_length(), bus.real_length());
         
         //создаем список маршрутов у остановок
         for (const Domain::Stop* stop_ptr : route) {
@@ -457,3 +481,37 @@ void TransportGuide::IoRequests::ProtoSerialization::DeserializerStopCatalog(
         
     }
 }
+
+void TransportGuide::IoRequests::ProtoSerialization::SerializerNameLookup(
+        TransportGuide::Serialization::NameLookup& result_name_lookup,
+        const TransportGuide::BusinessLogic::NamePerfectHash& name_lookup) {
+    result_name_lookup.set_seed(name_lookup.GetSeed());
+    for (uint32_t displacement : name_lookup.GetDisplacements()) {
+        result_name_lookup.add_displacements(displacement);
+    }
+    for (const auto& slot : name_lookup.GetSlots()) {
+        result_name_lookup.add_fingerprints(slot.fingerprint);
+        result_name_lookup.add_ids(slot.id);
+    }
+}
+
+std::optional<TransportGuide::BusinessLogic::NamePerfectHash>
+TransportGuide::IoRequests::ProtoSerialization::DeserializerNameLookup(
+        const TransportGuide::Serialization::NameLookup& parsed_name_lookup, size_t name_count) {
+    //Ячейка на каждое имя, id в пределах каталога, корзина на каждые 4 имени, как при построении таблицы
+    const size_t slot_count = parsed_name_lookup.ids_size();
+    const size_t displacement_count = parsed_name_lookup.displacements_size();
+    if (static_cast<size_t>(parsed_name_lookup.fingerprints_size()) != slot_count || slot_count != name_count
+            || displacement_count != (name_count + 3) / 4) {
+        return std::nullopt;
+    }
+    std::vector<uint32_t> displacements(parsed_name_lookup.displacements().begin(),
+            parsed_name_lookup.displacements().end());
+    std::vector<BusinessLogic::NamePerfectHash::Slot> slots;
+    slots.reserve(slot_count);
+    for (int i = 0; i < parsed_name_lookup.ids_size(); ++i) {
+        if (parsed_name_lookup.ids(i) >= name_count) { return std::nullopt; }
+        slots.push_back({parsed_name_lookup.fingerprints(i), parsed_name_lookup.ids(i)});
+    }
+    return BusinessLogic::NamePerfectHash(parsed_name_lookup.seed(), std::move(displacements), std::move(slots));
+}
@@ -26,6 +26,8 @@ private:
     void SerializerRealDistanceCatalog(Serialization::TransportCatalogue& result_catalogue,
             BusinessLogic::SerializerTransportCatalogue& serializer_catalogue);
     void SerializerRenderSettings(Serialization::TransportCatalogue& result_catalogue);
+    void SerializerNameLookup(Serialization::NameLookup& result_name_lookup,
+            const BusinessLogic::NamePerfectHash& name_lookup);
     void SerializerRoutingSettings(Serialization::TransportRouter& result_user_route_manager,
             BusinessLogic::SerializerTransportRouter& serializer_transport_router);
     void SerializerGraph(Serialization::TransportRouter& result_user_route_manager,
@@ -65,6 +67,9 @@ private:
     void DeserializerRouter(BusinessLogic::SerializerTransportRouter& serializer_transport_router,
             const Serialization::TransportRouter& parsed_user_route_manager);
     void DeserializerRenderSettings(const Serialization::TransportCatalogue& parsed_catalog);
+    /**Таблица имен, если она согласована с количеством имен в каталоге, иначе пусто*/
+    std::optional<BusinessLogic::NamePerfectHash> DeserializerNameLookup(const Serialization::NameLookup& parsed_name_lookup,
+            size_t name_count);
 };
 
 }
\ No newline at end of file
@@ -28,7 +28,8 @@ inline auto extract_sub_str = [](std::string_view& str, const std::string& separ
         str.remove_prefix(str.find_first_not_of(separator, str.find_first_of(separator)));
         str.remove_prefix(str.find_first_not_of(" \n"));
     }
-    return static_cast<std::string>(sub_str);
+    //Возвращаю представление на исходную строку, имена копируются только в каталог
+    return sub_str;
 };
 
 
@@ -53,7 +54,7 @@ void StreamReader::LoadData() {
         std::getline(input_string_stream_, str);
         std::string_view str_view = str;
         
-        std::string code_str = extract_sub_str(str_view, " ");
+        std::string_view code_str = extract_sub_str(str_view, " ");
         if (code_str == "Stop") {
             stop_requests.emplace_back(str_view);
         }
@@ -62,55 +63,44 @@ void StreamReader::LoadData() {
         }
     }
     
-    for_each(stop_requests.begin(), stop_requests.end(), [this](const std::string& str) {
-        AddStopByDescription(str);
+    BusinessLogic::TransportCatalogueBuilder builder(catalogue_);
+    builder.Reserve(stop_requests.size(), bus_requests.size());
+    for_each(stop_requests.begin(), stop_requests.end(), [this, &builder](const std::string& str) {
+        AddStopByDescription(str, builder);
     });
-    for_each(bus_requests.begin(), bus_requests.end(), [this](const std::string& str) {
-        AddBusByDescription(str);
+    for_each(bus_requests.begin(), bus_requests.end(), [this, &builder](const std::string& str) {
+        AddBusByDescription(str, builder);
     });
+    builder.Finish();
 }
 
-void StreamReader::AddStopByDescription(std::string_view str_view) {
-    std::string name = extract_sub_str(str_view, ":");
-    double latitude = std::stod(extract_sub_str(str_view, ","));
-    double longitude = std::stod(extract_sub_str(str_view, ", \n"));
-    Domain::Stop* stop_ptr = catalogue_.InsertStop(Domain::Stop(name, latitude, longitude));
+void StreamReader::AddStopByDescription(std::string_view str_view, BusinessLogic::TransportCatalogueBuilder& builder) {
+    std::string_view name = extract_sub_str(str_view, ":");
+    double latitude = std::stod(std::string(extract_sub_str(str_view, ",")));
+    double longitude = std::stod(std::string(extract_sub_str(str_view, ", \n")));
+    Domain::Stop* stop_ptr = builder.AddStop(name, latitude, longitude);
     
     while (!str_view.empty()) {
-        double distance = std::stod(extract_sub_str(str_view, "m"));
+        double distance = std::stod(std::string(extract_sub_str(str_view, "m")));
         extract_sub_str(str_view, " ");
-        std::string to_stop_name = extract_sub_str(str_view, ",");
-        Domain::Stop* to_stop_ptr = catalogue_.InsertStop(Domain::Stop(to_stop_name));
-        catalogue_.AddRealDistanceToCatalog(stop_ptr, to_stop_ptr, distance);
+        std::string_view to_stop_name = extract_sub_str(str_view, ",");
+        Domain::Stop* to_stop_ptr = builder.AddStop(to_stop_name);
+        builder.AddRealDistance(stop_ptr, to_stop_ptr, distance);
     }
 }
 
-void StreamReader::AddBusByDescription(std::string_view str_view) {
-    std::string bus_name = extract_sub_str(str_view, ":");
+void StreamReader::AddBusByDescription(std::string_view str_view, BusinessLogic::TransportCatalogueBuilder& builder) {
+    std::string bus_name(extract_sub_str(str_view, ":"));
     std::vector<const Domain::Stop*> route;
     auto fill_route = [&](const std::string& separator) {
         while (!str_view.empty()) {
-            std::string stop_name = extract_sub_str(str_view, separator);
-            Domain::Stop* stop_ptr = catalogue_.InsertStop(Domain::Stop(stop_name));
-            route.push_back(stop_ptr);
+            std::string_view stop_name = extract_sub_str(str_view, separator);
+            route.push_back(builder.AddStop(stop_name));
         }
     };
-    size_t number_final_stop = 0;
-    if (str_view.find('>') != std::string::npos) {
-        fill_route(">\n");
-    }
-    else {
-        fill_route("-\n");
-        std::vector<const Domain::Stop*> backward_route;
-        number_final_stop = route.size();
-        std::copy(std::next(route.rbegin()), route.rend(),
-                std::back_insert_iterator<std::vector<const Domain::Stop*>>(backward_route));
-        std::move(backward_route.begin(), backward_route.end(),
-                std::back_insert_iterator<std::vector<const Domain::Stop*>>(route));
-    }
-    double calc_dist = catalogue_.GetBusCalculateLength(route);
-    double real_dist = catalogue_.GetBusRealLength(route);
-    catalogue_.InsertBus(Domain::Bus(bus_name, route, number_final_stop, calc_dist, real_dist));
+    bool is_roundtrip = str_view.find('>') != std::string::npos;
+    fill_route(is_roundtrip ? ">\n" : "-\n");
+    builder.AddBus(std::move(bus_name), std::move(route), is_roundtrip);
 }
 
 std::ostream& operator<< (std::ostream& o_stream, const Domain::BusInfo& bus_info) {
@@ -141,9 +131,9 @@ void StreamReader::SendAnswer() {
         std::getline(input_string_stream_, str);
         std::string_view str_view = str;
         
-        std::string code_str = extract_sub_str(str_view, " ");
+        std::string_view code_str = extract_sub_str(str_view, " ");
         if (code_str == "Stop") {
-            std::string stop_name = extract_sub_str(str_view, "\n");
+            std::string_view stop_name = extract_sub_str(str_view, "\n");
             auto stop_info = catalogue_.GetStopInfo(stop_name);
             if (stop_info.has_value() && !stop_info.value().buses.empty()) {
                 output_stream_ << stop_info.value() << std::endl;
@@ -156,7 +146,7 @@ void StreamReader::SendAnswer() {
             }
         }
         else if (code_str == "Bus") {
-            std::string bus_name = extract_sub_str(str_view, "\n");
+            std::string_view bus_name = extract_sub_str(str_view, "\n");
             auto bus_info = catalogue_.GetBusInfo(bus_name);
             if (bus_info.has_value()) {
                 output_stream_ << bus_info.value() << std::endl;
@@ -21,7 +21,7 @@ private:
     std::string document_;
     std::istringstream input_string_stream_;
     
-    void AddStopByDescription(std::string_view str_view);
-    void AddBusByDescription(std::string_view str_view);
+    void AddStopByDescription(std::string_view str_view, BusinessLogic::TransportCatalogueBuilder& builder);
+    void AddBusByDescription(std::string_view str_view, BusinessLogic::TransportCatalogueBuilder& builder);
 };
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include <iostream>
 #include <fstream>
+#include <memory_resource>
 #include "domain/geo.h"
 #include "infrastructure/stream_reader.h"
 #include "business_logic/transport_catalogue.h"
@@ -10,7 +11,7 @@
 using namespace std::literals;
 
 void PrintUsage(std::ostream& stream = std::cerr) {
-    stream << "Usage: transport_catalogue [make_base|process_requests]\n"sv;
+    stream << "Usage: transport_catalogue [make_base|update_base|process_requests|memory_stats|benchmarks]\n"sv;
 }
 
 // Ремарка для ревьюера
@@ -35,6 +36,12 @@ void PrintUsage(std::ostream& stream = std::cerr) {
 
 int main(int argc, char* argv[]) {
     
+    //Замеры времени запускаются отдельно и не замедляют остальные режимы
+    if (argc == 2 && argv[1] == "benchmarks"sv) {
+        TransportGuide::Test::AllBenchmarks();
+        return 0;
+    }
+    
     TransportGuide::Test::AllTests();
     
     if (argc != 2) {
@@ -42,8 +49,12 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
+    //Память каталога, маршрутов и графа берется из арены без освобождения по одному объекту,
+    //арена объявлена раньше каталога и освобождается целиком сразу после него
+    std::pmr::monotonic_buffer_resource catalogue_resource;
+
     //Бизнес-логика
-    TransportGuide::BusinessLogic::TransportCatalogue transport_catalogue{};
+    TransportGuide::BusinessLogic::TransportCatalogue transport_catalogue{&catalogue_resource};
 
     //Ввод-вывод
     TransportGuide::renderer::MapRenderer map_renderer(transport_catalogue);
@@ -59,16 +70,39 @@ int main(int argc, char* argv[]) {
     const std::string_view mode(argv[1]);
 
     if (mode == "make_base"sv) {
+        //Базу можно строить по мере чтения: путь к файлу базы нужен только после загрузки
+        json_reader.LoadDataStreaming();
+        std::ofstream output_file(json_reader.GetOutputFilePath(), std::ios::binary);
+        serializer.Serialize(output_file);
+
+    } else if (mode == "update_base"sv) {
+        //Изменения из base_requests применяются к сохраненной базе, файл базы перезаписывается
         input_reader.PreloadDocument();
+        {
+            std::ifstream input_file(json_reader.GetInputFilePath(), std::ios::binary);
+            serializer.Deserialize(input_file);
+        }
         input_reader.LoadData();
         std::ofstream output_file(json_reader.GetOutputFilePath(), std::ios::binary);
         serializer.Serialize(output_file);
 
     } else if (mode == "process_requests"sv) {
+        //Ответы выводятся по мере разбора запросов, база загружается перед первым запросом.
+        //Если serialization_settings стоит после stat_requests, запросы выполняются в конце документа
+        json_reader.SendAnswerStreaming([&] {
+            std::ifstream input_file(json_reader.GetInputFilePath(), std::ios::binary);
+            serializer.Deserialize(input_file);
+            transport_catalogue.Freeze();
+        }, {"serialization_settings"sv});
+
+    } else if (mode == "memory_stats"sv) {
         input_reader.PreloadDocument();
         std::ifstream input_file(json_reader.GetInputFilePath(), std::ios::binary);
         serializer.Deserialize(input_file);
-        input_reader.SendAnswer();
+        transport_catalogue.Freeze();
+        //Документ карты строится заранее, чтобы в отчет попал и он
+        map_renderer.CreateDocument();
+        json_reader.SendMemoryStats();
 
     } else {
         PrintUsage();
@@ -1,4 +1,8 @@
+#include <algorithm>
+#include <array>
+#include <cstdio>
 #include <random>
+#include <thread>
 #include <sstream>
 #include <fstream>
 #include "tests.h"
@@ -6,6 +10,8 @@
 #include "../domain/domain.h"
 #include "../infrastructure/json_reader.h"
 #include "../infrastructure/serialization.h"
+#include "../infrastructure/memory_stats.h"
+#include "../external/memory_counter.h"
 
 namespace TransportGuide::Test {
 using namespace std::literals;
@@ -61,6 +67,16 @@ std::string getexepath()
 {
     return ".";
 }
+
+size_t GetProcessMemoryKb(std::string_view)
+{
+    return 0;
+}
+
+bool ResetPeakRss()
+{
+    return false;
+}
 #else
 #include <limits.h>
 #include <unistd.h>
@@ -72,6 +88,28 @@ std::string getexepath()
     path = path.substr(0, path.find_last_of('/'));
     return path;
 }
+
+//Поле /proc/self/status в килобайтах: VmRSS - текущая резидентная память, VmHWM - ее пик
+size_t GetProcessMemoryKb(std::string_view field)
+{
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, field.size(), field) == 0 && line.size() > field.size() && line[field.size()] == ':') {
+            return std::stoul(line.substr(field.size() + 1));
+        }
+    }
+    return 0;
+}
+
+//Сбросить пик резидентной памяти до текущей, чтобы следующий участок измерялся отдельно
+bool ResetPeakRss()
+{
+    std::ofstream clear_refs("/proc/self/clear_refs");
+    clear_refs << "5";
+    clear_refs.flush();
+    return clear_refs.good();
+}
 #endif
 
 
@@ -122,6 +160,33 @@ std::deque<Domain::Bus> BusGenerator(std::deque<Domain::Stop>& stops, size_t cou
 
 }
 
+//Случайный каталог через пакетную загрузку: кольцевые маршруты по 20 остановок, кольцо расстояний и маршрутизатор
+void LoadRandomCatalogue(BusinessLogic::TransportCatalogue& transport_catalogue, size_t stop_count, size_t bus_count) {
+    std::mt19937 generator(36);
+    std::uniform_real_distribution<double> lat_distribution(55.5, 55.9);
+    std::uniform_real_distribution<double> lng_distribution(37.3, 37.9);
+    std::uniform_int_distribution<size_t> stop_distribution(0, stop_count - 1);
+    BusinessLogic::TransportCatalogueBuilder builder(transport_catalogue);
+    builder.Reserve(stop_count, bus_count, stop_count);
+    std::vector<const Domain::Stop*> stops;
+    for (size_t i = 0; i < stop_count; ++i) {
+        stops.push_back(builder.AddStop("Stop "s + std::to_string(i), lat_distribution(generator), lng_distribution(generator)));
+    }
+    for (size_t i = 0; i < stop_count; ++i) {
+        builder.AddRealDistance(stops[i], stops[(i + 1) % stop_count], 1000. + i);
+    }
+    for (size_t i = 0; i < bus_count; ++i) {
+        std::vector<const Domain::Stop*> route;
+        for (int j = 0; j < 20; ++j) {
+            route.push_back(stops[stop_distribution(generator)]);
+        }
+        route.push_back(route.front());
+        builder.AddBus(std::to_string(i), std::move(route), true);
+    }
+    builder.Finish();
+    transport_catalogue.ConstructUserRouteManager({.bus_wait_time = 6, .bus_velocity = 40});
+}
+
 std::deque<Domain::TrackSection> TrackSectionCatalogGenerator(std::deque<Domain::Stop>& stops, size_t count) {
     std::mt19937 generator;
     int stops_bound = stops.size() - 1;
@@ -301,6 +366,7 @@ void IntegrationTests::TestCase_8_Serialization_Deserialization() {
         input_reader.PreloadDocument();
         std::ifstream input_file(json_reader.GetInputFilePath(), std::ios::binary);
         serializer.Deserialize(input_file);
+        transport_catalogue.Freeze();
         input_reader.SendAnswer();
     }
     
@@ -318,6 +384,320 @@ void IntegrationTests::TestCase_8_Serialization_Deserialization() {
     ASSERT(correct_json == answer_json);
 }
 
+void IntegrationTests::TestCase_9_NearestStopsRequests() {
+    std::istringstream i_string_stream("{\n" "  \"base_requests\": [\n"
+                                       "    { \"type\": \"Stop\", \"name\": \"Ривьерский мост\", \"latitude\": 43.587795, \"longitude\": 39.716901, \"road_distances\": {} },\n"
+                                       "    { \"type\": \"Stop\", \"name\": \"Морской вокзал\", \"latitude\": 43.581969, \"longitude\": 39.719848, \"road_distances\": {} },\n"
+                                       "    { \"type\": \"Stop\", \"name\": \"Электросети\", \"latitude\": 43.598701, \"longitude\": 39.730623, \"road_distances\": {} }\n"
+                                       "  ],\n"
+                                       "  \"stat_requests\": [\n"
+                                       "    { \"id\": 1, \"type\": \"NearestStops\", \"latitude\": 43.5878, \"longitude\": 39.7169, \"count\": 2 },\n"
+                                       "    { \"id\": 2, \"type\": \"StopsInRadius\", \"latitude\": 43.5878, \"longitude\": 39.7169, \"radius\": 1000 }\n"
+                                       "  ]\n" "} "s);
+    
+    std::ostringstream o_string_stream;
+    TransportCatalogue transport_catalogue{};
+    renderer::MapRenderer map_renderer(transport_catalogue);
+    IoRequests::JsonReader json_reader(map_renderer, transport_catalogue, i_string_stream, o_string_stream);
+    IoRequests::IoBase& input_reader = json_reader;
+    
+    input_reader.PreloadDocument();
+    input_reader.LoadData();
+    transport_catalogue.Freeze();
+    input_reader.SendAnswer();
+    
+    std::istringstream answer_stream(o_string_stream.str());
+    json::Document answer_doc = json::Load(answer_stream);
+    const json::Array& answers = answer_doc.GetRoot().AsArray();
+    ASSERT(answers.size() == 2);
+    
+    auto get_names = [](const json::Node& answer) {
+        std::vector<std::string> names;
+        for (const auto& stop_node : answer.AsMap().at("stops"s).AsArray()) {
+            names.emplace_back(stop_node.AsMap().at("name"s).AsString());
+        }
+        return names;
+    };
+    ASSERT(answers[0].AsMap().at("request_id"s) == 1);
+    ASSERT(get_names(answers[0]) == std::vector<std::string>({"Ривьерский мост"s, "Морской вокзал"s}));
+    ASSERT(answers[1].AsMap().at("request_id"s) == 2);
+    ASSERT(get_names(answers[1]) == std::vector<std::string>({"Ривьерский мост"s, "Морской вокзал"s}));
+    double distance = answers[1].AsMap().at("stops"s).AsArray().back().AsMap().at("distance"s).AsDouble();
+    ASSERT(std::abs(distance - Domain::geo::ComputeDistance({43.5878, 39.7169}, {43.581969, 39.719848})) < 1e-1);
+}
+
+void IntegrationTests::TestCase_10_MemoryStats() {
+    //Счетчик аллокатора видит ровно запрошенные блоки
+    std::vector<int> vector;
+    vector.reserve(10);
+    ASSERT(memory::MeasureVector(vector) == 10 * sizeof(int));
+    ASSERT(memory::MeasureString("short"s) == 0);
+    std::string long_string(100, 'x');
+    ASSERT(memory::MeasureString(long_string) == long_string.capacity() + 1);
+    std::unordered_set<int> empty_set;
+    ASSERT(memory::MeasureUnorderedSet(empty_set) == 0);
+    
+    //Подсчет по узлам, корзинам и блокам совпадает с тем, что контейнеры на самом деле заняли у ресурса
+    {
+        memory::CountingResource map_resource;
+        std::pmr::unordered_map<std::string_view, int> map(&map_resource);
+        memory::CountingResource set_resource;
+        std::pmr::unordered_set<const char*> set(&set_resource);
+        memory::CountingResource deque_resource;
+        std::pmr::deque<Domain::geo::Coordinates> deque(&deque_resource);
+        memory::CountingResource big_deque_resource;
+        std::pmr::deque<std::array<char, 600>> big_deque(&big_deque_resource);
+        memory::CountingResource string_resource;
+        std::pmr::string string(&string_resource);
+        std::vector<std::string> names;
+        for (int i = 0; i < 5000; ++i) {
+            names.push_back(std::to_string(i));
+        }
+        for (int i = 0; i < 5000; ++i) {
+            map.emplace(names[i], i);
+            set.insert(names[i].data());
+            deque.emplace_back();
+            big_deque.emplace_back();
+            string.push_back('x');
+            if (i % 997 == 0) {
+                ASSERT(memory::MeasureUnorderedMap(map) == map_resource.GetBytes());
+                ASSERT(memory::MeasureUnorderedSet(set) == set_resource.GetBytes());
+                ASSERT(memory::MeasureDeque(deque) == deque_resource.GetBytes());
+                ASSERT(memory::MeasureDeque(big_deque) == big_deque_resource.GetBytes());
+                ASSERT(memory::MeasureString(string) == string_resource.GetBytes());
+            }
+        }
+        ASSERT(memory::MeasureUnorderedMap(map) == map_resource.GetBytes());
+        ASSERT(memory::MeasureUnorderedSet(set) == set_resource.GetBytes());
+        ASSERT(memory::MeasureDeque(deque) == deque_resource.GetBytes());
+        ASSERT(memory::MeasureDeque(big_deque) == big_deque_resource.GetBytes());
+    }
+    
+    std::ifstream file_input_stream(getexepath() + "/test_case/json_route_case_01_input.json");
+    std::ostringstream o_string_stream;
+    TransportCatalogue transport_catalogue{};
+    renderer::MapRenderer map_renderer(transport_catalogue);
+    IoRequests::JsonReader json_reader(map_renderer, transport_catalogue, file_input_stream, o_string_stream);
+    IoRequests::IoBase& input_reader = json_reader;
+    
+    input_reader.PreloadDocument();
+    input_reader.LoadData();
+    transport_catalogue.Freeze();
+    
+    IoRequests::MemoryReport empty_document_report = IoRequests::MemoryStats(transport_catalogue, map_renderer).Collect();
+    map_renderer.CreateDocument();
+    IoRequests::MemoryReport report = IoRequests::MemoryStats(transport_catalogue, map_renderer).Collect();
+    
+    std::map<std::string, size_t> structures(report.structures.begin(), report.structures.end());
+    ASSERT(structures.size() == report.structures.size());
+    size_t total_bytes = 0;
+    for (const auto& [name, bytes] : structures) {
+        ASSERT_HINT(name == "catalogue.calculated_distance_catalog"s || bytes > 0, name);
+        total_bytes += bytes;
+    }
+    ASSERT(total_bytes == report.total_bytes);
+    ASSERT(structures.at("renderer.document"s) > 0);
+    ASSERT(empty_document_report.total_bytes + structures.at("renderer.document"s) == report.total_bytes);
+    
+    json_reader.SendMemoryStats();
+    std::istringstream answer_stream(o_string_stream.str());
+    json::Document answer_doc = json::Load(answer_stream);
+    const json::Dict& answer = answer_doc.GetRoot().AsMap();
+    ASSERT(answer.at("total_bytes"s).AsInt() == static_cast<int>(report.total_bytes));
+    ASSERT(answer.at("structures"s).AsMap().size() == structures.size());
+    ASSERT(answer.at("structures"s).AsMap().at("router.graph"s).AsInt() == static_cast<int>(structures.at("router.graph"s)));
+}
+
+void IntegrationTests::TestCase_11_StreamingBaseRequests() {
+    for (int case_number = 1; case_number <= 6; ++case_number) {
+        std::string case_name = getexepath() + "/test_case/json_route_case_0"s + std::to_string(case_number);
+        std::ifstream file_input_stream(case_name + "_input.json"s);
+        std::ifstream file_output_stream(case_name + "_output.json"s);
+        std::ostringstream o_string_stream;
+        
+        TransportCatalogue transport_catalogue{};
+        renderer::MapRenderer map_renderer(transport_catalogue);
+        IoRequests::JsonReader json_reader(map_renderer, transport_catalogue, file_input_stream, o_string_stream);
+        
+        //Записи base_requests попадают в каталог во время разбора, stat_requests остаются в документе
+        json_reader.LoadDataStreaming();
+        json_reader.SendAnswer();
+        
+        std::istringstream answer_input(o_string_stream.str());
+        json::Document correct_json = json::Load(file_output_stream);
+        json::Document answer_json = json::Load(answer_input);
+        ASSERT_HINT(correct_json == answer_json, case_name);
+    }
+}
+
+void IntegrationTests::TestCase_12_StreamingStatRequests() {
+    std::ifstream file_input_stream(getexepath() + "/test_case/json_route_case_01_input.json");
+    std::ifstream file_output_stream(getexepath() + "/test_case/json_route_case_01_output.json");
+    std::string input_text = GetTextFromStream(file_input_stream);
+    const std::string base_path = getexepath() + "/streaming_stat_requests.db"s;
+    
+    //make_base
+    {
+        std::istringstream input(input_text);
+        std::ostringstream output;
+        TransportGuide::BusinessLogic::TransportCatalogue transport_catalogue{};
+        TransportGuide::renderer::MapRenderer map_renderer(transport_catalogue);
+        TransportGuide::IoRequests::JsonReader json_reader(map_renderer, transport_catalogue, input, output);
+        TransportGuide::IoRequests::ProtoSerialization proto_serializer(transport_catalogue, map_renderer);
+        json_reader.PreloadDocument();
+        json_reader.LoadData();
+        std::ofstream output_file(base_path, std::ios::binary);
+        proto_serializer.Serialize(output_file);
+    }
+    
+    json::Dict process_requests{
+            {"serialization_settings"s, json::Node(json::Dict{{"file"s, json::Node(base_path)}})},
+            {"stat_requests"s, json::Load(std::string_view(input_text)).GetRoot().AsMap().at("stat_requests"s)}};
+    std::ostringstream process_requests_text;
+    json::Print(json::Document(json::Node(process_requests)), process_requests_text);
+    
+    //Возвращает ответ process_requests, собранный через документ или потоково
+    auto process = [&base_path](const std::string& text, bool is_streaming, int& prepare_count) {
+        std::istringstream input(text);
+        std::ostringstream output;
+        TransportGuide::BusinessLogic::TransportCatalogue transport_catalogue{};
+        TransportGuide::renderer::MapRenderer map_renderer(transport_catalogue);
+        TransportGuide::IoRequests::JsonReader json_reader(map_renderer, transport_catalogue, input, output);
+        TransportGuide::IoRequests::ProtoSerialization proto_serializer(transport_catalogue, map_renderer);
+        auto prepare = [&] {
+            ++prepare_count;
+            ASSERT(json_reader.GetInputFilePath() == base_path);
+            std::ifstream input_file(json_reader.GetInputFilePath(), std::ios::binary);
+            proto_serializer.Deserialize(input_file);
+            transport_catalogue.Freeze();
+        };
+        if (is_streaming) {
+            json_reader.SendAnswerStreaming(prepare, {"serialization_settings"sv});
+        } else {
+            json_reader.PreloadDocument();
+            prepare();
+            json_reader.SendAnswer();
+        }
+        return output.str();
+    };
+    
+    int prepare_count = 0;
+    std::string document_answer = process(process_requests_text.str(), false, prepare_count);
+    std::string streaming_answer = process(process_requests_text.str(), true, prepare_count);
+    ASSERT(prepare_count == 2);
+    ASSERT(streaming_answer == document_answer);
+    std::istringstream answer_input(streaming_answer);
+    ASSERT(json::Load(answer_input) == json::Load(file_output_stream));
+    
+    //Порядок ключей не важен: запросы до serialization_settings выполняются после чтения документа
+    std::ostringstream stat_requests_text;
+    json::Print(json::Document(process_requests.at("stat_requests"s)), stat_requests_text);
+    std::string reordered_text = "{\"stat_requests\": "s + stat_requests_text.str()
+            + ", \"serialization_settings\": {\"file\": \""s + base_path + "\"}}"s;
+    ASSERT(reordered_text.find("stat_requests"s) < reordered_text.find("serialization_settings"s));
+    ASSERT(process(reordered_text, true, prepare_count) == document_answer);
+    ASSERT(prepare_count == 3);
+    
+    //Без запросов ничего не выводится и база не загружается
+    std::string empty_answer = process("{\"serialization_settings\": {\"file\": \"\"}, \"stat_requests\": []}"s, true,
+                                       prepare_count);
+    ASSERT(empty_answer.empty());
+    ASSERT(prepare_count == 3);
+    std::remove(base_path.c_str());
+}
+
+void IntegrationTests::TestCase_13_AnswerCache() {
+    std::ifstream file_input_stream(getexepath() + "/test_case/json_route_case_01_input.json");
+    const json::Document input_doc = json::Load(file_input_stream);
+    
+    //Возвращает ответ на пакет stat_requests и счетчики кеша ответов
+    auto process = [&input_doc](json::Array stat_requests, TransportGuide::IoRequests::AnswerCache::Counters& counters) {
+        json::Dict input_root = input_doc.GetRoot().AsMap();
+        input_root.at("stat_requests"s) = json::Node(std::move(stat_requests));
+        std::ostringstream input_text;
+        json::Print(json::Document(json::Node(std::move(input_root))), input_text);
+        
+        std::istringstream input(input_text.str());
+        std::ostringstream output;
+        TransportGuide::BusinessLogic::TransportCatalogue transport_catalogue{};
+        TransportGuide::renderer::MapRenderer map_renderer(transport_catalogue);
+        TransportGuide::IoRequests::JsonReader json_reader(map_renderer, transport_catalogue, input, output);
+        json_reader.PreloadDocument();
+        json_reader.LoadData();
+        {
+            LogDuration log_duration("Answer cache batch time");
+            json_reader.SendAnswer();
+        }
+        counters = json_reader.GetAnswerCacheCounters();
+        return output.str();
+    };
+    
+    const json::Array& requests = input_doc.GetRoot().AsMap().at("stat_requests"s).AsArray();
+    TransportGuide::IoRequests::AnswerCache::Counters counters;
+    std::istringstream single_answer_input(process(requests, counters));
+    ASSERT(counters.requests == requests.size() && counters.hits == 0);
+    const json::Document single_answer_doc = json::Load(single_answer_input);
+    const json::Array& answers = single_answer_doc.GetRoot().AsArray();
+    
+    //Запросы пакета повторяются с новыми id, ответы на повторы отличаются от исходных только request_id
+    const int repeat_count = 2000;
+    json::Array stat_requests;
+    json::Array expected_answers;
+    for (int repeat = 0; repeat < repeat_count; ++repeat) {
+        for (size_t i = 0; i < requests.size(); ++i) {
+            json::Dict request = requests[i].AsMap();
+            json::Dict answer = answers[i].AsMap();
+            const int id = request.at("id"s).AsInt() + repeat * 100;
+            request.at("id"s) = json::Node(id);
+            answer.at("request_id"s) = json::Node(id);
+            stat_requests.emplace_back(std::move(request));
+            expected_answers.emplace_back(std::move(answer));
+        }
+    }
+    stat_requests.emplace_back(json::Dict{{"id"s, json::Node(-1)}, {"type"s, json::Node("Stats"s)}});
+    
+    std::string answer_text = process(std::move(stat_requests), counters);
+    ASSERT(counters.requests == requests.size() * repeat_count);
+    //Ответ сохраняется на втором появлении запроса, из кеша отвечают начиная с третьего
+    ASSERT(counters.hits == requests.size() * (repeat_count - 2));
+    
+    std::istringstream answer_input(answer_text);
+    json::Document answer_doc = json::Load(answer_input);
+    //Ответы из кеша отформатированы так же, как записанные напрямую: повторный вывод документа совпадает побайтно
+    std::ostringstream reprinted_answer;
+    json::Print(answer_doc, reprinted_answer);
+    ASSERT(reprinted_answer.str() == answer_text);
+    
+    json::Array answer_array = answer_doc.GetRoot().AsArray();
+    const json::Dict& cache_stats = answer_array.back().AsMap().at("answer_cache"s).AsMap();
+    ASSERT(cache_stats.at("hits"s).AsInt() == static_cast<int>(counters.hits));
+    ASSERT(cache_stats.at("requests"s).AsInt() == static_cast<int>(counters.requests));
+    answer_array.pop_back();
+    ASSERT(answer_array == expected_answers);
+    
+    //Объем кеша ограничен: при переполнении вытесняется давно запрошенный ответ
+    using TransportGuide::IoRequests::AnswerCache;
+    using TransportGuide::IoRequests::RequestType;
+    AnswerCache cache(64);
+    const std::string answer = "{\"request_id\": 1, \"text\": \"0123456789\"}"s;
+    const size_t id_begin = answer.find('1');
+    for (std::string_view name : {"a"sv, "b"sv, "c"sv}) {
+        const std::string key = cache.MakeKey(RequestType::STOP, {name});
+        ASSERT(!cache.Admit(key) && cache.Admit(key));
+        cache.Add(key, answer, id_begin, id_begin + 1);
+        ASSERT(cache.GetBytes() <= 64);
+    }
+    std::string cached_text;
+    {
+        json::Writer writer(cached_text, json::PrintMode::PRETTY, 0, 6);
+        ASSERT(!cache.TryWrite(cache.MakeKey(RequestType::STOP, {"a"sv}), 7, writer));
+        ASSERT(cache.TryWrite(cache.MakeKey(RequestType::STOP, {"c"sv}), 17, writer));
+    }
+    ASSERT(cached_text == "{\"request_id\": 17, \"text\": \"0123456789\"}"s);
+    cache.Add(cache.MakeKey(RequestType::BUS, {"a"sv}), std::string(100, ' '), 0, 1);
+    ASSERT(cache.GetBytes() <= 64);
+}
+
 void TransportCatalogueTests::TrackSectionHasher() {
     size_t max_collision_count = 0;
     size_t count_collision_more_one = 0;
@@ -343,7 +723,7 @@ void TransportCatalogueTests::TrackSectionHasher() {
 void TransportCatalogueTests::AddBus() {
     TransportCatalogue transport_catalogue{};
     
-    std::deque<Domain::Bus> null_buses;
+    std::pmr::deque<Domain::Bus> null_buses;
     ASSERT(transport_catalogue.GetBuses() == null_buses);
     
     std::deque<Domain::Stop> stops = StopGenerator(30);
@@ -351,20 +731,22 @@ void TransportCatalogueTests::AddBus() {
     for (const Domain::Bus& bus : buses) {
         transport_catalogue.InsertBus(bus);
     }
-    ASSERT(transport_catalogue.GetBuses() == buses);
+    ASSERT(std::equal(transport_catalogue.GetBuses().begin(), transport_catalogue.GetBuses().end(),
+            buses.begin(), buses.end()));
 }
 
 void TransportCatalogueTests::AddStop() {
     TransportCatalogue transport_catalogue{};
     
-    std::deque<Domain::Stop> null_stops;
+    std::pmr::deque<Domain::Stop> null_stops;
     ASSERT(transport_catalogue.GetStops() == null_stops);
     
     std::deque<Domain::Stop> stops = StopGenerator(30);
     for (const Domain::Stop& stop : stops) {
         transport_catalogue.InsertStop(stop);
     }
-    ASSERT(transport_catalogue.GetStops() == stops);
+    ASSERT(std::equal(transport_catalogue.GetStops().begin(), transport_catalogue.GetStops().end(),
+            stops.begin(), stops.end()));
 }
 
 void TransportCatalogueTests::FindBus() {
@@ -509,6 +891,564 @@ void TransportCatalogueTests::GetStopInfo() {
     ASSERT(stop_info_birul.has_value() && stop_info_birul.value() == stop_info_3);
 }
 
+void TransportCatalogueTests::InsertStopByName() {
+    TransportCatalogue transport_catalogue{};
+    std::string name = "Marushkino"s;
+    //Ссылка на остановку до заполнения координат
+    Domain::Stop* empty_stop = transport_catalogue.InsertStop(std::string_view(name));
+    ASSERT(empty_stop && !empty_stop->is_fill);
+    ASSERT(transport_catalogue.InsertStop(std::string_view(name)) == empty_stop);
+    
+    Domain::Stop* filled_stop = transport_catalogue.InsertStop(name, 55.595884, 37.209755);
+    ASSERT(filled_stop == empty_stop);
+    ASSERT(*filled_stop == Domain::Stop("Marushkino", 55.595884, 37.209755) && filled_stop->is_fill);
+    ASSERT(transport_catalogue.GetStops().size() == 1);
+    
+    //Каталог не ссылается на строку, переданную при вставке
+    name = "Tolstopaltsevo"s;
+    ASSERT(transport_catalogue.FindStop("Marushkino").has_value());
+    ASSERT(!transport_catalogue.FindStop("Tolstopaltsevo").has_value());
+}
+
+void TransportCatalogueTests::BulkLoadBuilder() {
+    TransportCatalogue transport_catalogue{};
+    BusinessLogic::TransportCatalogueBuilder builder(transport_catalogue);
+    builder.Reserve(3, 2, 2);
+    //Маршрут ссылается на остановку до заполнения координат
+    Domain::Stop* stop1 = builder.AddStop("Tolstopaltsevo", 55.611087, 37.20829);
+    Domain::Stop* stop2 = builder.AddStop("Marushkino");
+    builder.AddRealDistance(stop1, stop2, 3900).AddRealDistance(stop2, stop1, 4000);
+    builder.AddBus("750", {stop1, stop2}, false);
+    builder.AddBus("256", {stop1, stop2, stop1}, true);
+    ASSERT(transport_catalogue.GetBuses().empty());
+    //Повторное описание маршрута заменяет предыдущее
+    builder.AddBus("750", {stop2, stop1}, false);
+    ASSERT(builder.AddStop("Marushkino", 55.595884, 37.209755) == stop2);
+    builder.Finish();
+    
+    ASSERT(transport_catalogue.GetBuses().size() == 2);
+    auto bus = transport_catalogue.FindBus("750");
+    ASSERT(bus.has_value());
+    const Domain::Route& route = bus.value()->route;
+    ASSERT(std::vector<const Domain::Stop*>(route.begin(), route.end()) == std::vector<const Domain::Stop*>({stop2, stop1, stop2}));
+    ASSERT(!bus.value()->IsRoundtrip());
+    ASSERT(bus.value()->real_length == 7900);
+    ASSERT(transport_catalogue.FindBus("256").value()->real_length == 7900);
+    ASSERT(transport_catalogue.FindBus("256").value()->calc_length == bus.value()->calc_length);
+    
+    auto stop_info = transport_catalogue.GetStopInfo("Marushkino");
+    ASSERT(stop_info.has_value() && stop_info.value().buses.size() == 2);
+    bool is_throw = false;
+    try {
+        builder.AddStop("Rasskazovka");
+    } catch (const std::logic_error&) {
+        is_throw = true;
+    }
+    ASSERT(is_throw);
+    
+    //Маршрутов больше, чем зарезервировано: записи переезжают, повтор раннего имени находит прежнюю запись
+    TransportCatalogue grown_catalogue{};
+    BusinessLogic::TransportCatalogueBuilder grown_builder(grown_catalogue);
+    grown_builder.Reserve(2, 1);
+    Domain::Stop* grown_stop1 = grown_builder.AddStop("A", 55.611087, 37.20829);
+    Domain::Stop* grown_stop2 = grown_builder.AddStop("B", 55.595884, 37.209755);
+    const int bus_count = 100;
+    for (int i = 0; i < bus_count; ++i) {
+        grown_builder.AddBus(std::to_string(i), {grown_stop1, grown_stop2}, false);
+    }
+    grown_builder.AddBus("0", {grown_stop2, grown_stop1, grown_stop2}, true);
+    grown_builder.AddBus("1", {grown_stop2, grown_stop1}, false);
+    grown_builder.Finish();
+    ASSERT(grown_catalogue.GetBuses().size() == bus_count);
+    ASSERT(grown_catalogue.FindBus("0").value()->IsRoundtrip());
+    const Domain::Route& grown_route = grown_catalogue.FindBus("1").value()->route;
+    ASSERT(grown_route.front() == grown_stop2 && grown_route.size() == 3);
+}
+
+void TransportCatalogueTests::BulkLoadBuilderParallel() {
+    //Один и тот же пакет в одном и в нескольких потоках дает одинаковый каталог
+    auto load = [](TransportCatalogue& transport_catalogue, size_t thread_count) {
+        std::mt19937 generator(32);
+        std::uniform_real_distribution<double> lat_distribution(55.5, 55.9);
+        std::uniform_real_distribution<double> lng_distribution(37.3, 37.9);
+        std::uniform_int_distribution<size_t> stop_distribution(0, 299);
+        BusinessLogic::TransportCatalogueBuilder builder(transport_catalogue);
+        builder.SetThreadCount(thread_count).Reserve(300, 500, 300);
+        std::vector<const Domain::Stop*> stops;
+        for (int i = 0; i < 300; ++i) {
+            stops.push_back(builder.AddStop("Stop "s + std::to_string(i), lat_distribution(generator), lng_distribution(generator)));
+        }
+        for (int i = 0; i < 300; ++i) {
+            builder.AddRealDistance(stops[i], stops[(i + 1) % 300], 1000 + i);
+        }
+        for (int i = 0; i < 500; ++i) {
+            std::vector<const Domain::Stop*> route;
+            for (int j = 0; j < 10; ++j) {
+                route.push_back(stops[stop_distribution(generator)]);
+            }
+            bool is_roundtrip = i % 2 == 0;
+            if (is_roundtrip) {
+                route.push_back(route.front());
+            }
+            builder.AddBus(std::to_string(i), std::move(route), is_roundtrip);
+        }
+        builder.Finish();
+    };
+    TransportCatalogue serial_catalogue{};
+    load(serial_catalogue, 1);
+    TransportCatalogue parallel_catalogue{};
+    load(parallel_catalogue, 4);
+    
+    const auto& serial_buses = serial_catalogue.GetBuses();
+    const auto& parallel_buses = parallel_catalogue.GetBuses();
+    ASSERT(serial_buses.size() == 500 && parallel_buses.size() == 500);
+    for (size_t i = 0; i < serial_buses.size(); ++i) {
+        ASSERT(serial_buses[i].name == parallel_buses[i].name);
+        ASSERT(serial_buses[i].route.size() == parallel_buses[i].route.size());
+        ASSERT(serial_buses[i].calc_length == parallel_buses[i].calc_length);
+        ASSERT(serial_buses[i].real_length == parallel_buses[i].real_length);
+        ASSERT(serial_buses[i].unique_stops_count == parallel_buses[i].unique_stops_count);
+        ASSERT(serial_buses[i].number_final_stop_ == parallel_buses[i].number_final_stop_);
+    }
+    auto get_bus_names = [](const TransportCatalogue& transport_catalogue, std::string_view stop_name) {
+        std::vector<std::string_view> names;
+        auto stop_info = transport_catalogue.GetStopInfo(stop_name);
+        for (const Domain::Bus* bus : stop_info->buses) {
+            names.push_back(bus->name);
+        }
+        return names;
+    };
+    ASSERT(get_bus_names(serial_catalogue, "Stop 7"sv) == get_bus_names(parallel_catalogue, "Stop 7"sv));
+}
+
+void TransportCatalogueTests::FreezeSnapshot() {
+    TransportCatalogue transport_catalogue{};
+    transport_catalogue.InsertStop(Domain::Stop("Tolstopaltsevo", 55.611087, 37.208290));
+    transport_catalogue.InsertStop(Domain::Stop("Marushkino", 55.595884, 37.209755));
+    transport_catalogue.InsertStop(Domain::Stop("Rasskazovka", 55.632761, 37.333324));
+    transport_catalogue.InsertStop(Domain::Stop("Biryulyovo Zapadnoye", 55.574371, 37.651700));
+    transport_catalogue.InsertStop(Domain::Stop("Universam", 55.587655, 37.645687));
+    transport_catalogue.InsertStop(Domain::Stop("Prazhskaya", 55.611678, 37.603831));
+    auto& stops = transport_catalogue.GetStops();
+    transport_catalogue.AddRealDistanceToCatalog(&stops[0], &stops[1], 3900);
+    transport_catalogue.AddRealDistanceToCatalog(&stops[1], &stops[2], 9900);
+    transport_catalogue.InsertBus(Domain::Bus("750", {&stops[0], &stops[1], &stops[2], &stops[1], &stops[0]}, 3, 20939.5, 27600));
+    transport_catalogue.InsertBus(Domain::Bus("256", {&stops[3], &stops[4], &stops[1], &stops[3]}, 60000, 60000));
+    transport_catalogue.InsertBus(Domain::Bus("14", {&stops[4], &stops[1], &stops[4]}, 55000, 55000));
+    
+    std::vector<std::optional<Domain::StopInfo>> expected_stop_infos;
+    for (const auto& stop : stops) {
+        expected_stop_infos.push_back(transport_catalogue.GetStopInfo(stop.name));
+    }
+    std::vector<std::optional<Domain::BusInfo>> expected_bus_infos;
+    for (const auto& bus : transport_catalogue.GetBuses()) {
+        expected_bus_infos.push_back(transport_catalogue.GetBusInfo(bus.name));
+    }
+    double expected_distance = transport_catalogue.GetDistance(&stops[3], &stops[4]);
+    
+    ASSERT(!transport_catalogue.IsFrozen() && !transport_catalogue.GetSnapshot());
+    transport_catalogue.Freeze();
+    ASSERT(transport_catalogue.IsFrozen() && transport_catalogue.GetSnapshot());
+    
+    //Чтение из нескольких потоков дает те же ответы, что и до заморозки
+    std::vector<std::thread> threads;
+    std::vector<bool> results(4, false);
+    for (size_t thread_index = 0; thread_index < results.size(); ++thread_index) {
+        threads.emplace_back([&, thread_index]() {
+            bool is_equal = true;
+            for (size_t i = 0; i < stops.size(); ++i) {
+                is_equal = is_equal && transport_catalogue.GetStopInfo(stops[i].name) == expected_stop_infos[i];
+            }
+            for (size_t i = 0; i < transport_catalogue.GetBuses().size(); ++i) {
+                is_equal = is_equal && transport_catalogue.GetBusInfo(transport_catalogue.GetBuses()[i].name) == expected_bus_infos[i];
+            }
+            is_equal = is_equal && transport_catalogue.GetDistance(&stops[3], &stops[4]) == expected_distance;
+            is_equal = is_equal && transport_catalogue.GetDistance(&stops[1], &stops[0]) == 3900;
+            is_equal = is_equal && !transport_catalogue.FindStop("Biryusinka").has_value();
+            is_equal = is_equal && !transport_catalogue.FindBus("828").has_value();
+            results[thread_index] = is_equal;
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    ASSERT(std::all_of(results.begin(), results.end(), [](bool result) { return result; }));
+    
+    auto stop_info = transport_catalogue.GetStopInfo("Marushkino");
+    ASSERT(stop_info.has_value() && stop_info->buses.size() == 3 && stop_info->buses.front()->name == "14"s);
+    ASSERT(transport_catalogue.GetStopInfo("Prazhskaya").has_value() && transport_catalogue.GetStopInfo("Prazhskaya")->buses.empty());
+    Domain::Stop foreign_stop("Marushkino", 55.595884, 37.209755);
+    ASSERT(!transport_catalogue.GetStopInfo(&foreign_stop).has_value());
+    
+    bool is_throw = false;
+    try {
+        transport_catalogue.InsertStop("Biryusinka", 55.581065, 37.64839);
+    } catch (const std::logic_error&) {
+        is_throw = true;
+    }
+    ASSERT(is_throw);
+    is_throw = false;
+    try {
+        transport_catalogue.ConstructUserRouteManager({6, 40});
+    } catch (const std::logic_error&) {
+        is_throw = true;
+    }
+    ASSERT(is_throw && !transport_catalogue.HasUserRouteManager());
+}
+
+void TransportCatalogueTests::SpatialIndex() {
+    //Одинаковые каталоги: замороженный ищет по индексу, второй перебором
+    TransportCatalogue indexed_catalogue{};
+    TransportCatalogue scanned_catalogue{};
+    std::mt19937 generator(29);
+    std::uniform_real_distribution<double> lat_distribution(55.5, 55.9);
+    std::uniform_real_distribution<double> lng_distribution(37.3, 37.9);
+    for (int i = 0; i < 3000; ++i) {
+        std::string name = "Stop "s + std::to_string(i);
+        double latitude = lat_distribution(generator);
+        double longitude = lng_distribution(generator);
+        indexed_catalogue.InsertStop(name, latitude, longitude);
+        scanned_catalogue.InsertStop(name, latitude, longitude);
+    }
+    //Незаполненная остановка в поиск не попадает
+    indexed_catalogue.InsertStop("Empty"sv);
+    scanned_catalogue.InsertStop("Empty"sv);
+    indexed_catalogue.Freeze();
+    
+    auto get_names = [](const std::vector<Domain::StopDistance>& stops) {
+        std::vector<std::string_view> names;
+        for (const auto& stop_distance : stops) {
+            names.push_back(stop_distance.stop->name);
+        }
+        return names;
+    };
+    std::uniform_int_distribution<size_t> count_distribution(0, 20);
+    std::uniform_real_distribution<double> radius_distribution(0, 3000);
+    for (int i = 0; i < 200; ++i) {
+        //Часть точек вне области остановок
+        Domain::geo::Coordinates point{lat_distribution(generator) + (i % 4 == 0 ? 0.5 : 0.),
+                                       lng_distribution(generator) - (i % 8 == 0 ? 1. : 0.)};
+        size_t count = count_distribution(generator);
+        auto indexed_nearest = indexed_catalogue.GetNearestStops(point, count);
+        auto scanned_nearest = scanned_catalogue.GetNearestStops(point, count);
+        ASSERT(indexed_nearest.size() == count);
+        ASSERT(get_names(indexed_nearest) == get_names(scanned_nearest));
+        
+        double radius = radius_distribution(generator);
+        auto indexed_in_radius = indexed_catalogue.GetStopsInRadius(point, radius);
+        auto scanned_in_radius = scanned_catalogue.GetStopsInRadius(point, radius);
+        ASSERT(get_names(indexed_in_radius) == get_names(scanned_in_radius));
+        ASSERT(std::all_of(indexed_in_radius.begin(), indexed_in_radius.end(), [radius](const auto& stop_distance) {
+            return stop_distance.distance <= radius;
+        }));
+    }
+    ASSERT(indexed_catalogue.GetNearestStops({55.7, 37.6}, 5000).size() == 3000);
+}
+
+void TransportCatalogueTests::NameSearch() {
+    auto fill_catalogue = [](TransportCatalogue& transport_catalogue) {
+        transport_catalogue.InsertStop("Морской вокзал", 43.581969, 39.719848);
+        transport_catalogue.InsertStop("Морпорт", 43.58, 39.72);
+        transport_catalogue.InsertStop("Ривьерский мост", 43.587795, 39.716901);
+        transport_catalogue.InsertStop("Marushkino", 55.595884, 37.209755);
+        transport_catalogue.InsertStop("Universam", 55.587655, 37.645687);
+        auto& stops = transport_catalogue.GetStops();
+        transport_catalogue.InsertBus(Domain::Bus("114", {&stops[0], &stops[2], &stops[0]}, 1, 1));
+        transport_catalogue.InsertBus(Domain::Bus("14", {&stops[3], &stops[4], &stops[3]}, 1, 1));
+    };
+    TransportCatalogue frozen_catalogue{};
+    fill_catalogue(frozen_catalogue);
+    frozen_catalogue.Freeze();
+    TransportCatalogue transport_catalogue{};
+    fill_catalogue(transport_catalogue);
+    
+    auto get_names = [](const std::vector<Domain::SearchMatch>& matches) {
+        std::vector<std::string_view> names;
+        for (const auto& match : matches) {
+            names.push_back(match.name);
+        }
+        return names;
+    };
+    for (const TransportCatalogue* catalogue : {&frozen_catalogue, &transport_catalogue}) {
+        //Регистр не важен, в том числе для кириллицы
+        ASSERT(get_names(catalogue->SearchNames("мор", 10)) == std::vector<std::string_view>({"Морпорт", "Морской вокзал"}));
+        ASSERT(get_names(catalogue->SearchNames("МОРС", 10)) == std::vector<std::string_view>({"Морской вокзал"}));
+        ASSERT(get_names(catalogue->SearchNames("mar", 10)) == std::vector<std::string_view>({"Marushkino"}));
+        ASSERT(get_names(catalogue->SearchNames("14", 10)) == std::vector<std::string_view>({"14"}));
+        ASSERT(get_names(catalogue->SearchNames("1", 1)) == std::vector<std::string_view>({"114"}));
+        ASSERT(std::holds_alternative<const Domain::Bus*>(catalogue->SearchNames("114", 1).front().entity));
+        ASSERT(catalogue->SearchNames("", 100).size() == 7);
+        ASSERT(catalogue->SearchNames("Univ", 0).empty());
+        //Опечатка находится только нечетким поиском
+        ASSERT(catalogue->SearchNames("Marushkina", 10).empty());
+        auto fuzzy_matches = catalogue->SearchNames("Marushkina", 10, true);
+        ASSERT(get_names(fuzzy_matches) == std::vector<std::string_view>({"Marushkino"}));
+        ASSERT(fuzzy_matches.front().similarity > 0.3 && fuzzy_matches.front().similarity < 1.);
+        //Префиксные совпадения идут перед похожими
+        auto mixed_matches = catalogue->SearchNames("Морской", 10, true);
+        ASSERT(!mixed_matches.empty() && mixed_matches.front().name == "Морской вокзал"sv
+               && mixed_matches.front().similarity == 1.);
+    }
+}
+
+void TransportCatalogueTests::SharedRoutePool() {
+    std::deque<Domain::Stop> stops = StopGenerator(10);
+    std::vector<const Domain::Stop*> full_route = {&stops[0], &stops[1], &stops[2], &stops[1], &stops[0]};
+    
+    //Некольцевой маршрут хранит только прямое направление, обход дает полный маршрут
+    Domain::RoutePool pool;
+    Domain::Route route = Domain::RoutePool::Intern(pool, full_route, 3);
+    ASSERT(route.IsMirrored());
+    ASSERT(route.GetStoredCount() == 3 && pool.GetIndicesCount() == 3);
+    ASSERT(std::vector<const Domain::Stop*>(route.begin(), route.end()) == full_route);
+    ASSERT(route.size() == full_route.size() && route.back() == &stops[0]);
+    //Незеркальная вторая половина хранится целиком
+    std::vector<const Domain::Stop*> not_mirrored = {&stops[0], &stops[1], &stops[2], &stops[3], &stops[0]};
+    Domain::Route not_mirrored_route = Domain::RoutePool::Intern(pool, not_mirrored, 3);
+    ASSERT(!not_mirrored_route.IsMirrored());
+    ASSERT(std::vector<const Domain::Stop*>(not_mirrored_route.begin(), not_mirrored_route.end()) == not_mirrored);
+    //Одинаковые последовательности хранятся один раз
+    size_t indices_count = pool.GetIndicesCount();
+    Domain::Route same_route = Domain::RoutePool::InternMirrored(pool, {&stops[0], &stops[1], &stops[2]});
+    ASSERT(pool.GetIndicesCount() == indices_count);
+    ASSERT(same_route == route);
+    
+    //Прямое направление - представление того же отрезка
+    Domain::Bus bus("1", full_route, 3, 1, 1);
+    Domain::Route forward = bus.GetForwardRoute();
+    ASSERT(forward.GetPool() == bus.route.GetPool());
+    ASSERT(std::vector<const Domain::Stop*>(forward.begin(), forward.end())
+           == std::vector<const Domain::Stop*>({&stops[0], &stops[1], &stops[2]}));
+    Domain::Bus roundtrip_bus("2", {&stops[4], &stops[5], &stops[4]}, 1, 1);
+    ASSERT(roundtrip_bus.GetForwardRoute().size() == 2);
+    //Маршрут вне каталога лежит в хранилище своего автобуса, копии автобуса разделяют его
+    ASSERT(bus.route.GetPool() == bus.own_route_pool_.get());
+    ASSERT(roundtrip_bus.route.GetPool() != bus.route.GetPool());
+    Domain::Bus bus_copy = bus;
+    ASSERT(bus_copy.route.GetPool() == bus.route.GetPool() && bus_copy.own_route_pool_ == bus.own_route_pool_);
+    ASSERT(sizeof(Domain::Route) <= 3 * sizeof(void*));
+    
+    //Каталог переносит маршруты в общее хранилище, равенство маршрутов не зависит от хранилища
+    TransportCatalogue transport_catalogue{};
+    const Domain::Bus* inserted_bus = transport_catalogue.InsertBus(bus);
+    const Domain::Bus* inserted_roundtrip_bus = transport_catalogue.InsertBus(roundtrip_bus);
+    ASSERT(inserted_bus->route.GetPool() != bus.route.GetPool());
+    ASSERT(inserted_bus->route.GetPool() == inserted_roundtrip_bus->route.GetPool());
+    ASSERT(!inserted_bus->own_route_pool_ && !inserted_roundtrip_bus->own_route_pool_);
+    ASSERT(*inserted_bus == bus);
+    //Маршрут каталога не зависит от хранилища исходного автобуса
+    {
+        Domain::Bus temporary_bus("3", {&stops[6], &stops[7], &stops[6]}, 1, 1);
+        transport_catalogue.InsertBus(temporary_bus);
+    }
+    const Domain::Bus* inserted_temporary_bus = transport_catalogue.FindBus("3").value();
+    ASSERT(inserted_temporary_bus->route.front() == &stops[6] && inserted_temporary_bus->route.size() == 3);
+    ASSERT(inserted_bus->unique_stops_count == 3);
+    ASSERT(transport_catalogue.GetBusInfo("1").value().stops_count == 5);
+}
+
+void TransportCatalogueTests::RemoveBusAndStop() {
+    TransportCatalogue transport_catalogue{};
+    const Domain::Stop* a = transport_catalogue.InsertStop("A"sv, 55.611087, 37.20829);
+    const Domain::Stop* b = transport_catalogue.InsertStop("B"sv, 55.595884, 37.209755);
+    const Domain::Stop* c = transport_catalogue.InsertStop("C"sv, 55.632761, 37.333324);
+    const Domain::Stop* d = transport_catalogue.InsertStop("D"sv, 55.574371, 37.6517);
+    transport_catalogue.AddRealDistanceToCatalog(a, b, 1000);
+    transport_catalogue.AddRealDistanceToCatalog(c, d, 2000);
+    transport_catalogue.InsertBus(Domain::Bus("1", {a, b, a}, 2, 0, 0));
+    transport_catalogue.InsertBus(Domain::Bus("2", {c, d, c}, 2, 0, 0));
+    transport_catalogue.InsertBus(Domain::Bus("3", {a, c, a}, 0, 0));
+    transport_catalogue.ConstructUserRouteManager({.bus_wait_time = 6, .bus_velocity = 40});
+    
+    //Остановку, через которую идет маршрут, удалить нельзя
+    bool is_thrown = false;
+    try {
+        transport_catalogue.RemoveStop("D"sv);
+    } catch (const std::logic_error&) {
+        is_thrown = true;
+    }
+    ASSERT(is_thrown);
+    
+    //Удаление сразу видно через словари, объекты остаются в хранилище до уплотнения
+    const Domain::Bus* bus_2 = transport_catalogue.FindBus("2"sv).value();
+    ASSERT(transport_catalogue.RemoveBus("2"sv));
+    ASSERT(!transport_catalogue.RemoveBus("2"sv));
+    ASSERT(transport_catalogue.IsRemoved(bus_2));
+    ASSERT(!transport_catalogue.FindBus("2"sv).has_value());
+    ASSERT(transport_catalogue.GetStopInfo("C"sv).value().buses.size() == 1);
+    ASSERT(transport_catalogue.GetStopInfo("D"sv).value().buses.empty());
+    ASSERT(transport_catalogue.RemoveStop("D"sv));
+    ASSERT(transport_catalogue.IsRemoved(d));
+    ASSERT(!transport_catalogue.GetStopInfo("D"sv).has_value());
+    ASSERT(transport_catalogue.GetNearestStops({55.574371, 37.6517}, 4).size() == 3);
+    ASSERT(transport_catalogue.SearchNames("D"sv, 5).empty());
+    ASSERT(transport_catalogue.GetRemovedCount() == 2);
+    ASSERT(transport_catalogue.GetBuses().size() == 3 && transport_catalogue.GetStops().size() == 4);
+    
+    //Уплотнение убирает удаленные объекты, остальные данные каталога сохраняются
+    transport_catalogue.Compact();
+    ASSERT(transport_catalogue.GetRemovedCount() == 0);
+    ASSERT(!transport_catalogue.HasUserRouteManager());
+    ASSERT(transport_catalogue.GetBuses().size() == 2 && transport_catalogue.GetStops().size() == 3);
+    const Domain::Stop* new_a = transport_catalogue.FindStop("A"sv).value();
+    const Domain::Stop* new_b = transport_catalogue.FindStop("B"sv).value();
+    ASSERT(&transport_catalogue.GetStops().front() == new_a);
+    ASSERT(transport_catalogue.GetDistance(new_a, new_b) == 1000);
+    const Domain::Bus* bus_1 = transport_catalogue.FindBus("1"sv).value();
+    ASSERT(transport_catalogue.GetBusRealLength(bus_1->route) == 2000);
+    ASSERT(bus_1->route.front() == new_a && bus_1->route[1] == new_b);
+    ASSERT(bus_1->route.GetPool() == transport_catalogue.FindBus("3"sv).value()->route.GetPool());
+    std::vector<const Domain::Bus*> a_buses = transport_catalogue.GetStopInfo("A"sv).value().buses;
+    ASSERT(a_buses.size() == 2 && a_buses[0] == bus_1);
+    ASSERT(transport_catalogue.GetStopInfo("C"sv).value().buses.size() == 1);
+    //Маршрутизатор строится по уплотненному каталогу
+    transport_catalogue.ConstructUserRouteManager({.bus_wait_time = 6, .bus_velocity = 40});
+    ASSERT(transport_catalogue.GetUserRouteManager().GetUserRouteInfo(new_a, new_b).has_value());
+}
+
+void TransportCatalogueTests::MemoryResourceLoad() {
+    //Один и тот же пакет на ресурсе по умолчанию и на арене, память считают ресурсы-счетчики
+    memory::CountingResource default_resource;
+    memory::CountingResource arena_upstream;
+    std::optional<Domain::UserRouteInfo> default_route;
+    std::optional<Domain::UserRouteInfo> arena_route;
+    {
+        BusinessLogic::TransportCatalogue transport_catalogue(&default_resource);
+        LoadRandomCatalogue(transport_catalogue, 30, 60);
+        ASSERT(default_resource.GetBytes() > 0);
+        default_route = transport_catalogue.GetUserRouteManager().GetUserRouteInfo("Stop 0"sv, "Stop 20"sv);
+    }
+    {
+        std::pmr::monotonic_buffer_resource arena(&arena_upstream);
+        BusinessLogic::TransportCatalogue transport_catalogue(&arena);
+        LoadRandomCatalogue(transport_catalogue, 30, 60);
+        arena_route = transport_catalogue.GetUserRouteManager().GetUserRouteInfo("Stop 0"sv, "Stop 20"sv);
+        //Удаление и сжатие не возвращают арене память, она освобождается только вместе с ареной
+        const size_t arena_bytes = arena_upstream.GetBytes();
+        transport_catalogue.RemoveBus("0"sv);
+        transport_catalogue.Compact();
+        ASSERT(arena_upstream.GetBytes() >= arena_bytes);
+    }
+    //Результат не зависит от ресурса, вся память возвращена, арена берет память крупными блоками
+    ASSERT(default_route.has_value() && arena_route.has_value());
+    ASSERT(std::abs(default_route->total_time - arena_route->total_time) < ACCURACY_COMPARISON);
+    ASSERT(default_resource.GetBytes() == 0 && arena_upstream.GetBytes() == 0);
+    ASSERT(arena_upstream.GetAllocationsCount() * 10 < default_resource.GetAllocationsCount());
+}
+
+void TransportCatalogueTests::NameLookupPerfectHash() {
+    std::mt19937 generator(37);
+    std::set<std::string> unique_names;
+    while (unique_names.size() < 3000) {
+        unique_names.insert(GenerateWord(generator, 12));
+    }
+    std::vector<std::string> names(unique_names.begin(), unique_names.end());
+    std::vector<std::string_view> known_names(names.begin(), names.begin() + 2000);
+    
+    //Каждое имя находит свою позицию, позиции - перестановка
+    BusinessLogic::NamePerfectHash name_lookup(known_names);
+    ASSERT(name_lookup.size() == known_names.size());
+    for (uint32_t id = 0; id < known_names.size(); ++id) {
+        ASSERT(name_lookup.Find(known_names[id]) == id);
+    }
+    //Незнакомые имена почти всегда отсекаются по отпечатку без сравнения строк
+    size_t false_candidates = 0;
+    for (size_t i = known_names.size(); i < names.size(); ++i) {
+        false_candidates += name_lookup.Find(names[i]) != BusinessLogic::NamePerfectHash::NPOS;
+    }
+    ASSERT(false_candidates <= 1);
+    ASSERT(BusinessLogic::NamePerfectHash(std::vector<std::string_view>{}).Find("A"sv) == BusinessLogic::NamePerfectHash::NPOS);
+    
+    //Каталог ищет по таблице, таблица сбрасывается при добавлении и переживает сериализацию
+    BusinessLogic::TransportCatalogue transport_catalogue;
+    const Domain::Stop* a = transport_catalogue.InsertStop("A"sv, 55.611087, 37.20829);
+    const Domain::Stop* b = transport_catalogue.InsertStop("B"sv, 55.595884, 37.209755);
+    transport_catalogue.InsertBus(Domain::Bus("1", {a, b, a}, 2, 0, 0));
+    transport_catalogue.BuildNameLookup();
+    ASSERT(transport_catalogue.HasNameLookup());
+    ASSERT(transport_catalogue.FindStop("B"sv).value() == b);
+    ASSERT(transport_catalogue.FindBus("1"sv).value()->name == "1"s);
+    ASSERT(!transport_catalogue.FindStop("C"sv).has_value() && !transport_catalogue.FindBus("2"sv).has_value());
+    
+    std::stringstream base;
+    {
+        renderer::MapRenderer map_renderer(transport_catalogue);
+        IoRequests::ProtoSerialization(transport_catalogue, map_renderer).Serialize(base);
+    }
+    BusinessLogic::TransportCatalogue loaded_catalogue;
+    renderer::MapRenderer loaded_map_renderer(loaded_catalogue);
+    IoRequests::ProtoSerialization(loaded_catalogue, loaded_map_renderer).Deserialize(base);
+    ASSERT(loaded_catalogue.HasNameLookup());
+    ASSERT(loaded_catalogue.FindStop("A"sv).value() == &loaded_catalogue.GetStops().front());
+    ASSERT(loaded_catalogue.FindBus("1"sv).value() == &loaded_catalogue.GetBuses().front());
+    ASSERT(!loaded_catalogue.FindStop("1"sv).has_value());
+    
+    //Таблицы, не согласованные с каталогом, отбрасываются, поиск идет по словарям
+    Serialization::TransportCatalogue parsed_base;
+    ASSERT(parsed_base.ParseFromString(base.str()));
+    auto load_corrupted = [&parsed_base](const std::function<void(Serialization::TransportCatalogue&)>& corrupt) {
+        Serialization::TransportCatalogue corrupted_base = parsed_base;
+        corrupt(corrupted_base);
+        std::stringstream corrupted_input(corrupted_base.SerializeAsString());
+        auto corrupted_catalogue = std::make_unique<BusinessLogic::TransportCatalogue>();
+        renderer::MapRenderer corrupted_map_renderer(*corrupted_catalogue);
+        IoRequests::ProtoSerialization(*corrupted_catalogue, corrupted_map_renderer).Deserialize(corrupted_input);
+        return corrupted_catalogue;
+    };
+    auto stale_id = load_corrupted([](Serialization::TransportCatalogue& base) {
+        base.mutable_stop_name_lookup()->set_ids(0, 1000);
+    });
+    auto extra_slot = load_corrupted([](Serialization::TransportCatalogue& base) {
+        base.mutable_bus_name_lookup()->add_ids(0);
+        base.mutable_bus_name_lookup()->add_fingerprints(0);
+    });
+    auto extra_displacement = load_corrupted([](Serialization::TransportCatalogue& base) {
+        base.mutable_stop_name_lookup()->add_displacements(0);
+    });
+    for (const auto& corrupted_catalogue : {stale_id.get(), extra_slot.get(), extra_displacement.get()}) {
+        ASSERT(!corrupted_catalogue->HasNameLookup());
+        ASSERT(corrupted_catalogue->FindStop("B"sv).value() == &corrupted_catalogue->GetStops().back());
+        ASSERT(corrupted_catalogue->FindBus("1"sv).value() == &corrupted_catalogue->GetBuses().front());
+    }
+    
+    transport_catalogue.InsertStop("C"sv, 55.632761, 37.333324);
+    ASSERT(!transport_catalogue.HasNameLookup());
+    ASSERT(transport_catalogue.FindStop("C"sv).has_value() && transport_catalogue.FindStop("A"sv).value() == a);
+}
+
+void TransportCatalogueTests::SphereDistanceKernel() {
+    std::mt19937 generator(31);
+    std::uniform_real_distribution<double> lat_distribution(43.5, 55.9);
+    std::uniform_real_distribution<double> lng_distribution(37.2, 39.8);
+    std::vector<Domain::geo::Coordinates> points;
+    for (int i = 0; i < 101; ++i) {
+        points.push_back({lat_distribution(generator), lng_distribution(generator)});
+    }
+    //Повтор точки должен давать ровно 0
+    points.push_back(points.back());
+    std::vector<Domain::geo::UnitVector> unit_vectors;
+    for (const auto& point : points) {
+        unit_vectors.push_back(Domain::geo::ToUnitVector(point));
+    }
+    std::vector<double> distances(points.size() - 1);
+    Domain::geo::ComputeSphereDistances(unit_vectors.data(), unit_vectors.data() + 1, distances.data(), distances.size());
+    for (size_t i = 0; i < distances.size(); ++i) {
+        double expected = Domain::geo::ComputeDistance(points[i], points[i + 1]);
+        ASSERT(std::abs(distances[i] - expected) < 1e-3);
+        ASSERT(distances[i] == Domain::geo::ComputeSphereDistance(unit_vectors[i], unit_vectors[i + 1]));
+    }
+    ASSERT(distances.back() == 0.);
+    
+    //Длина маршрута по пакетному расчету совпадает с суммой отрезков
+    TransportCatalogue transport_catalogue{};
+    transport_catalogue.InsertStop("A", points[0].lat, points[0].lng);
+    transport_catalogue.InsertStop("B", points[1].lat, points[1].lng);
+    transport_catalogue.InsertStop("C"sv);
+    auto& stops = transport_catalogue.GetStops();
+    std::vector<const Domain::Stop*> route{&stops[0], &stops[1], &stops[1], &stops[2], &stops[0]};
+    ASSERT(std::abs(transport_catalogue.GetBusCalculateLength(route) - distances[0]) < 1e-9);
+}
+
 void StreamReaderTests::Load() {
     std::istringstream file_input_stream("13\n"
                                          "Stop Tolstopaltsevo: 55.611087, 37.20829, 3900m to Marushkino\n"
@@ -533,9 +1473,9 @@ void StreamReaderTests::Load() {
     input_reader.PreloadDocument();
     input_reader.LoadData();
     
-    const std::deque<Domain::Bus>& buses = transport_catalogue.GetBuses();
+    const std::pmr::deque<Domain::Bus>& buses = transport_catalogue.GetBuses();
     ASSERT(buses.size() == 3);
-    const std::deque<Domain::Stop>& stops = transport_catalogue.GetStops();
+    const std::pmr::deque<Domain::Stop>& stops = transport_catalogue.GetStops();
     ASSERT(stops.size() == 10);
     Domain::Stop stop("Biryulyovo Tovarnaya", 55.592028, 37.653656);
     ASSERT(transport_catalogue.FindStop("Biryulyovo Tovarnaya").has_value() && *transport_catalogue.FindStop(
@@ -767,6 +1707,262 @@ void MapRenderTests::TestCase5() {
     ASSERT(answer == correct_answer);
 }
 
+void MapRenderTests::CachedMap() {
+    std::ifstream file_input_stream(getexepath() + "/test_case/maprender_case_big_data_input.json");
+    std::ifstream file_output_stream(getexepath() + "/test_case/maprender_case_big_data_output.json");
+    std::ostringstream o_string_stream;
+    
+    TransportCatalogue transport_catalogue{};
+    renderer::MapRenderer map_renderer(transport_catalogue);
+    IoRequests::JsonReader json_reader(map_renderer, transport_catalogue, file_input_stream, o_string_stream);
+    IoRequests::IoBase& input_reader = json_reader;
+    
+    input_reader.PreloadDocument();
+    input_reader.LoadData();
+    
+    const std::string correct_answer = GetTextFromStream(file_output_stream);
+    const std::string& svg = map_renderer.GetSvg();
+    ASSERT(svg + "\n" == correct_answer);
+    
+    //Повторная отрисовка без изменений возвращает сохраненный текст
+    ASSERT(&map_renderer.GetSvg() == &svg && map_renderer.GetSvg().data() == svg.data());
+    {
+        std::ostringstream out;
+        map_renderer.CreateDocument();
+        map_renderer.Render(out);
+        ASSERT(out.str() == svg);
+    }
+    
+    std::ostringstream json_svg;
+    json::Print(json::Document(json::Node(svg)), json_svg);
+    ASSERT(map_renderer.GetJsonSvg() + "\n" == json_svg.str());
+    
+    //Запросы Stats, подсчет памяти и сериализация только читают каталог и карту не сбрасывают
+    {
+        std::ifstream case_input_stream(getexepath() + "/test_case/json_route_case_01_input.json");
+        json::Dict input_root = json::Load(case_input_stream).GetRoot().AsMap();
+        json::Array stat_requests;
+        for (int id = 1; id <= 6; ++id) {
+            stat_requests.emplace_back(json::Dict{{"id"s, json::Node(id)}, {"type"s, json::Node(id % 2 ? "Map"s : "Stats"s)}});
+        }
+        input_root.at("stat_requests"s) = json::Node(std::move(stat_requests));
+        std::ostringstream input_text;
+        json::Print(json::Document(json::Node(std::move(input_root))), input_text);
+        
+        std::istringstream input(input_text.str());
+        std::ostringstream output;
+        TransportCatalogue case_catalogue{};
+        renderer::MapRenderer case_renderer(case_catalogue);
+        IoRequests::JsonReader case_reader(case_renderer, case_catalogue, input, output);
+        case_reader.PreloadDocument();
+        case_reader.LoadData();
+        const uint64_t version = case_catalogue.GetVersion();
+        const char* case_svg_data = case_renderer.GetSvg().data();
+        case_reader.SendAnswer();
+        IoRequests::MemoryStats(case_catalogue, case_renderer).Collect();
+        std::ostringstream base;
+        IoRequests::ProtoSerialization(case_catalogue, case_renderer).Serialize(base);
+        ASSERT(case_catalogue.GetVersion() == version);
+        ASSERT(case_renderer.GetSvg().data() == case_svg_data);
+        ASSERT(output.str().find("total_bytes"s) != std::string::npos);
+    }
+    
+    //Изменение настроек или каталога делает карту устаревшей
+    Domain::RenderSettings settings = map_renderer.GetRenderSettings();
+    settings.stop_radius += 1.;
+    map_renderer.SetRenderSettings(settings);
+    const std::string resized_svg = map_renderer.GetSvg();
+    ASSERT(resized_svg != correct_answer.substr(0, correct_answer.size() - 1));
+    
+    const Domain::Bus* bus = transport_catalogue.GetBusNameCatalog().begin()->second;
+    transport_catalogue.RemoveBus(bus->name);
+    ASSERT(map_renderer.GetSvg() != resized_svg);
+    ASSERT(map_renderer.GetJsonSvg().size() > map_renderer.GetSvg().size());
+}
+
+void MapRenderTests::StreamingSvgWriter() {
+    //Потоковая запись совпадает с выводом документа из объектов
+    svg::Document document;
+    document.Add(svg::Polyline().AddPoint({1.5, 2.}).AddPoint({1e-7, 123456789.})
+                         .SetFillColor(svg::NoneColor).SetStrokeColor(svg::Rgba(1, 2, 3, 0.85)).SetStrokeWidth(14.)
+                         .SetStrokeLineCap(svg::StrokeLineCap::ROUND).SetStrokeLineJoin(svg::StrokeLineJoin::MITER_CLIP));
+    document.Add(svg::Text().SetPosition({10.25, -3.}).SetOffset({7., 15.}).SetFontSize(20).SetFontFamily("Verdana")
+                         .SetFontWeight("bold").SetData("<Tom & \"Jerry's\">").SetFillColor(svg::Rgb(255, 160, 0)));
+    document.Add(svg::Circle().SetCenter({0.333333333, 50.}).SetRadius(5.).SetFillColor("white"));
+    std::ostringstream document_output;
+    document.Render(document_output);
+    
+    svg::PathAttrs polyline_attrs;
+    polyline_attrs.fill_color = "none"sv;
+    polyline_attrs.stroke_color = "rgba(1,2,3,0.85)"sv;
+    polyline_attrs.stroke_width = 14.;
+    polyline_attrs.stroke_line_cap = svg::StrokeLineCap::ROUND;
+    polyline_attrs.stroke_line_join = svg::StrokeLineJoin::MITER_CLIP;
+    svg::PathAttrs text_attrs;
+    text_attrs.fill_color = "rgb(255,160,0)"sv;
+    svg::PathAttrs circle_attrs;
+    circle_attrs.fill_color = "white"sv;
+    
+    auto write = [&](svg::Writer& writer) {
+        writer.StartDocument()
+              .StartPolyline().AddPoint({1.5, 2.}).AddPoint({1e-7, 123456789.}).EndPolyline(polyline_attrs)
+              .WriteText({10.25, -3.}, {7., 15.}, 20, "Verdana"sv, "bold"sv, "<Tom & \"Jerry's\">"sv, text_attrs)
+              .WriteCircle({0.333333333, 50.}, 5., circle_attrs)
+              .EndDocument();
+    };
+    std::ostringstream stream_output;
+    {
+        svg::Writer writer(stream_output);
+        write(writer);
+    }
+    ASSERT(stream_output.str() == document_output.str());
+    std::string string_output;
+    {
+        svg::Writer writer(string_output);
+        write(writer);
+    }
+    ASSERT(string_output == document_output.str());
+}
+
+void MapRenderTests::BigDataRenderTargets() {
+    std::ifstream file_input_stream(getexepath() + "/test_case/maprender_case_big_data_input.json");
+    std::ifstream file_output_stream(getexepath() + "/test_case/maprender_case_big_data_output.json");
+    std::ostringstream o_string_stream;
+    
+    TransportCatalogue transport_catalogue{};
+    renderer::MapRenderer map_renderer(transport_catalogue);
+    IoRequests::JsonReader json_reader(map_renderer, transport_catalogue, file_input_stream, o_string_stream);
+    IoRequests::IoBase& input_reader = json_reader;
+    input_reader.PreloadDocument();
+    input_reader.LoadData();
+    const std::string correct_answer = GetTextFromStream(file_output_stream);
+    
+    //Карта выводится одной отправкой буфера без сброса по тегам
+    std::ostringstream out;
+    map_renderer.CreateDocument();
+    map_renderer.Render(out);
+    ASSERT(out.str() + "\n" == correct_answer);
+    
+    //Документ из объектов выводится через тот же буферизованный Writer
+    svg::Document document;
+    for (const Domain::Stop& stop : transport_catalogue.GetStops()) {
+        document.Add(svg::Circle().SetCenter({stop.longitude, stop.latitude}).SetRadius(5.).SetFillColor("white"));
+    }
+    std::ostringstream document_output;
+    document.Render(document_output);
+    const std::string document_text = document_output.str();
+    size_t circle_count = 0;
+    for (size_t pos = document_text.find("<circle"sv); pos != std::string::npos; pos = document_text.find("<circle"sv, pos + 1)) {
+        ++circle_count;
+    }
+    ASSERT(circle_count == transport_catalogue.GetStops().size());
+    ASSERT(document_text.rfind("</svg>"sv) == document_text.size() - "</svg>"sv.size());
+    
+    //Отдельный тег выводится с отступом контекста
+    std::ostringstream tag_output;
+    svg::Circle().SetCenter({1., 2.}).SetRadius(3.).Render(svg::RenderContext(tag_output, 2, 4));
+    ASSERT(tag_output.str() == "    <circle cx=\"1\" cy=\"2\" r=\"3\"/>\n"s);
+}
+
+void MapRenderTests::ViewportMap() {
+    std::ifstream file_input_stream(getexepath() + "/test_case/maprender_case_big_data_input.json");
+    const json::Document input_doc = json::Load(file_input_stream);
+    std::ostringstream input_text;
+    json::Print(input_doc, input_text);
+    
+    std::istringstream input(input_text.str());
+    std::ostringstream output;
+    TransportCatalogue transport_catalogue{};
+    renderer::MapRenderer map_renderer(transport_catalogue);
+    IoRequests::JsonReader json_reader(map_renderer, transport_catalogue, input, output);
+    json_reader.PreloadDocument();
+    json_reader.LoadData();
+    
+    auto count_tags = [](const std::string& svg, std::string_view tag) {
+        size_t count = 0;
+        for (size_t pos = svg.find(tag); pos != std::string::npos; pos = svg.find(tag, pos + tag.size())) {
+            ++count;
+        }
+        return count;
+    };
+    
+    //Окно без bbox с масштабом 1 - вся карта
+    const std::string full_svg = map_renderer.GetSvg();
+    ASSERT(map_renderer.RenderViewport(Domain::MapViewport{}) == full_svg);
+    Domain::MapViewport zoomed;
+    zoomed.zoom = 2.;
+    const std::string zoomed_svg = map_renderer.RenderViewport(zoomed);
+    ASSERT(zoomed_svg != full_svg && count_tags(zoomed_svg, "<circle"sv) == count_tags(full_svg, "<circle"sv));
+    
+    //Окно вокруг одной остановки: на карте только остановки внутри bbox
+    std::set<const Domain::Stop*> map_stops;
+    for (const auto& [name, bus] : transport_catalogue.GetBusNameCatalog()) {
+        map_stops.insert(bus->route.begin(), bus->route.end());
+    }
+    const Domain::Stop* center = *map_stops.begin();
+    const double delta = 0.05;
+    Domain::MapViewport viewport;
+    viewport.bbox = {{center->latitude - delta, center->longitude - delta},
+                     {center->latitude + delta, center->longitude + delta}};
+    size_t expected_stops = 0;
+    for (const Domain::Stop* stop : map_stops) {
+        if (std::abs(stop->latitude - center->latitude) <= delta && std::abs(stop->longitude - center->longitude) <= delta) {
+            ++expected_stops;
+        }
+    }
+    const std::string viewport_svg = map_renderer.RenderViewport(viewport);
+    ASSERT(count_tags(viewport_svg, "<circle"sv) == expected_stops);
+    ASSERT(expected_stops < map_stops.size() && viewport_svg.size() < full_svg.size());
+    ASSERT(viewport_svg.find(">"s + center->name + "</text>"s) != std::string::npos);
+    
+    //Запрос Map с bbox и zoom отвечает той же частью карты, без них - всей картой
+    json::Dict bbox{{"min_lat"s, json::Node(viewport.bbox->first.lat)}, {"min_lng"s, json::Node(viewport.bbox->first.lng)},
+                    {"max_lat"s, json::Node(viewport.bbox->second.lat)}, {"max_lng"s, json::Node(viewport.bbox->second.lng)}};
+    json::Array stat_requests;
+    stat_requests.emplace_back(json::Dict{{"id"s, json::Node(1)}, {"type"s, json::Node("Map"s)}, {"bbox"s, json::Node(bbox)}});
+    stat_requests.emplace_back(json::Dict{{"id"s, json::Node(2)}, {"type"s, json::Node("Map"s)},
+                                          {"zoom"s, json::Node(2.)}});
+    stat_requests.emplace_back(json::Dict{{"id"s, json::Node(3)}, {"type"s, json::Node("Map"s)}});
+    json::Dict input_root = input_doc.GetRoot().AsMap();
+    input_root.at("stat_requests"s) = json::Node(stat_requests);
+    std::ostringstream request_text;
+    json::Print(json::Document(json::Node(std::move(input_root))), request_text);
+    
+    std::istringstream request_input(request_text.str());
+    std::ostringstream answer_output;
+    TransportCatalogue request_catalogue{};
+    renderer::MapRenderer request_renderer(request_catalogue);
+    IoRequests::JsonReader request_reader(request_renderer, request_catalogue, request_input, answer_output);
+    request_reader.PreloadDocument();
+    request_reader.LoadData();
+    request_reader.SendAnswer();
+    std::istringstream answer_input(answer_output.str());
+    const json::Document answer_doc = json::Load(answer_input);
+    const json::Array& answers = answer_doc.GetRoot().AsArray();
+    ASSERT(answers.size() == 3);
+    ASSERT(std::string_view(answers[0].AsMap().at("map"s).AsString()) == viewport_svg);
+    ASSERT(std::string_view(answers[1].AsMap().at("map"s).AsString()) == zoomed_svg);
+    ASSERT(std::string_view(answers[2].AsMap().at("map"s).AsString()) == full_svg);
+    
+    //Неверное окно отклоняется при разборе
+    json::Dict inverted_bbox = bbox;
+    std::swap(inverted_bbox.at("min_lat"s), inverted_bbox.at("max_lat"s));
+    const json::Node bad_requests[] = {
+            json::Node(json::Dict{{"id"s, json::Node(4)}, {"type"s, json::Node("Map"s)}, {"zoom"s, json::Node(0.)}}),
+            json::Node(json::Dict{{"id"s, json::Node(5)}, {"type"s, json::Node("Map"s)}, {"bbox"s, json::Node(inverted_bbox)}}),
+            json::Node(json::Dict{{"id"s, json::Node(6)}, {"type"s, json::Node("Map"s)}, {"bbox"s, json::Node(1)}})};
+    for (const json::Node& request : bad_requests) {
+        bool is_thrown = false;
+        try {
+            IoRequests::DecodeMapRequest(request);
+        }
+        catch (const std::logic_error&) {
+            is_thrown = true;
+        }
+        ASSERT(is_thrown);
+    }
+}
+
 /*
 void MapRenderTests::TestCase6() {
     std::ifstream file_input_stream(getexepath() + "/test_case/maprender_case_final_opentest_3.json");
@@ -988,12 +2184,726 @@ void UserRouteTests::TestCase7Route() {
 */
 
 
+void JsonTests::LoadBuffer() {
+    std::string text = "  {\"string\": \"a\\n\\t\\r\\\"\\\\b\", \"int\": -42, \"zero\": 0,\n"
+                       "\"double\": 1.5e+3, \"fraction\": -0.25, \"big\": 12345678901, \"exp\": 2E-2,\n"
+                       "\"flags\": [true, false, null], \"empty\": [{}, []], \"int\": 7}\r\n"s;
+    json::Dict expected_map{{"string"s, json::Node("a\n\t\r\"\\b"s)}, {"int"s, json::Node(-42)},
+                            {"zero"s, json::Node(0)}, {"double"s, json::Node(1500.0)},
+                            {"fraction"s, json::Node(-0.25)}, {"big"s, json::Node(12345678901.0)},
+                            {"exp"s, json::Node(0.02)},
+                            {"flags"s, json::Node(json::Array{json::Node(true), json::Node(false), json::Node(nullptr)})},
+                            {"empty"s, json::Node(json::Array{json::Node(json::Dict{}), json::Node(json::Array{})})}};
+    json::Document expected(json::Node(std::move(expected_map)));
+    
+    std::istringstream text_stream(text);
+    ASSERT(json::Load(text_stream) == expected);
+    ASSERT(json::Load(std::string_view(text)) == expected);
+    
+    //Ошибки разбора остались прежними
+    for (std::string_view wrong : {"\"abc"sv, "\"a\\q\""sv, "\"a\nb\""sv, "+1"sv, "-"sv, "1."sv, "tru"sv, "nulls"sv,
+                                   "[1 2]"sv, "{\"a\" 1}"sv, "{a: 1}"sv, ""sv}) {
+        bool is_throw = false;
+        try {
+            json::Load(wrong);
+        }
+        catch (const json::ParsingError&) {
+            is_throw = true;
+        }
+        ASSERT_HINT(is_throw, std::string(wrong));
+    }
+    
+    std::ifstream file_input_stream(getexepath() + "/test_case/maprender_case_big_data_input.json");
+    std::string big_text = GetTextFromStream(file_input_stream);
+    std::istringstream big_stream(big_text);
+    json::Document big_doc = json::Load(big_stream);
+    ASSERT(big_doc == json::Load(std::string_view(big_text)));
+    ASSERT(big_doc.GetRoot().AsMap().at("base_requests"s).AsArray().size() > 100);
+}
+
+void JsonTests::ParseEvents() {
+    //Записывает события разбора в строку
+    class EventRecorder final : public json::Handler {
+    public:
+        std::string events;
+        
+        void Null() override { events += "null "s; }
+        void Bool(bool value) override { events += value ? "true "s : "false "s; }
+        void Int(int value) override { events += "i"s + std::to_string(value) + " "s; }
+        void Double(double value) override { events += "d"s + std::to_string(value) + " "s; }
+        void String(std::string_view value) override { events += "s:"s + std::string(value) + " "s; }
+        void StartArray() override { events += "[ "s; }
+        void EndArray() override { events += "] "s; }
+        void StartDict() override { events += "{ "s; }
+        void Key(std::string_view key) override { events += "k:"s + std::string(key) + " "s; }
+        void EndDict() override { events += "} "s; }
+    };
+    
+    EventRecorder recorder;
+    json::Parse("{\"a\": [1, 2.5, \"x\"], \"b\": {\"c\": null, \"d\": true}}"sv, recorder);
+    ASSERT_HINT(recorder.events == "{ k:a [ i1 d2.500000 s:x ] k:b { k:c null k:d true } } "s, recorder.events);
+    
+    //Строки, числа и слова разрезаются границами частей потока в разных местах
+    std::string text = "["s;
+    for (int i = 0; i < 20000; ++i) {
+        text += "{\"name\": \"stop\\n"s + std::to_string(i) + "\", \"value\": "s + std::to_string(i * 1.25) +
+                ", \"flag\": "s + (i % 2 ? "true"s : "null"s) + "},\n"s;
+    }
+    text += "-7]"s;
+    std::istringstream text_stream(text);
+    json::Document stream_doc = json::Load(text_stream);
+    ASSERT(stream_doc == json::Load(std::string_view(text)));
+    ASSERT(stream_doc.GetRoot().AsArray().size() == 20001);
+    ASSERT(stream_doc.GetRoot().AsArray().at(19999).AsMap().at("name"s).AsString() == "stop\n19999"sv);
+    
+    //Оборванный документ
+    bool is_throw = false;
+    try {
+        json::NodeHandler handler;
+        json::Parse(std::string_view(text).substr(0, 70000), handler);
+        handler.ExtractDocument();
+    }
+    catch (const json::ParsingError&) {
+        is_throw = true;
+    }
+    ASSERT(is_throw);
+}
+
+void JsonTests::ArenaDocument() {
+    //Небольшой словарь ищет перебором, большой двоичным поиском, обход всегда в порядке ключей
+    json::Dict small{{"b"sv, json::Node(2)}, {"a"sv, json::Node(1)}, {"b"sv, json::Node(3)}};
+    ASSERT(small.size() == 2);
+    ASSERT(small.at("b"sv).AsInt() == 2);
+    ASSERT(small.begin()->first == "a"sv);
+    ASSERT(small.find("c"sv) == small.end());
+    ASSERT(!small.emplace("a"sv, json::Node(5)).second && small.at("a"sv).AsInt() == 1);
+    std::string text = "{"s;
+    for (int i = 99; i >= 0; --i) {
+        text += "\"key"s + std::to_string(i) + "\": "s + std::to_string(i) + (i ? ", "s : "}"s);
+    }
+    json::Document big = json::Load(std::string_view(text));
+    const json::Dict& big_map = big.GetRoot().AsMap();
+    ASSERT(big_map.size() == 100);
+    for (int i = 0; i < 100; ++i) {
+        ASSERT(big_map.at("key"s + std::to_string(i)).AsInt() == i);
+    }
+    ASSERT(std::is_sorted(big_map.begin(), big_map.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.first < rhs.first;
+    }));
+    ASSERT(big_map.count("key100"sv) == 0);
+    
+    //Копия значения не зависит от документа, присваивание документа освобождает старые значения до смены арены
+    json::Node copy;
+    {
+        json::Document document = json::Load("{\"list\": [\"a long string that does not fit in place\"]}"sv);
+        copy = document.GetRoot().AsMap().at("list"sv);
+        document = json::Load("[1]"sv);
+        ASSERT(document.GetRoot().AsArray().at(0).AsInt() == 1);
+    }
+    ASSERT(copy.AsArray().at(0).AsString() == "a long string that does not fit in place"sv);
+    
+    //Документ из большого файла занимает несколько крупных блоков арены, а не отдельный блок на значение
+    std::ifstream file_input_stream(getexepath() + "/test_case/maprender_case_big_data_input.json");
+    std::string big_text = GetTextFromStream(file_input_stream);
+    memory::CountingResource counting_resource;
+    std::pmr::memory_resource* default_resource = std::pmr::set_default_resource(&counting_resource);
+    size_t node_count = 0;
+    {
+        json::Document document = json::Load(std::string_view(big_text));
+        node_count = document.GetRoot().AsMap().at("base_requests"sv).AsArray().size();
+    }
+    std::pmr::set_default_resource(default_resource);
+    ASSERT_HINT(counting_resource.GetAllocationsCount() * 10 < node_count,
+            std::to_string(counting_resource.GetAllocationsCount()));
+}
+
+void JsonTests::PrintModes() {
+    json::Document document(json::Node(json::Dict{
+            {"array"sv, json::Node(json::Array{json::Node(1), json::Node(-0.5), json::Node(nullptr)})},
+            {"empty_map"sv, json::Node(json::Dict{})}, {"empty_array"sv, json::Node(json::Array{})},
+            {"text"sv, json::Node("a\"b\\c\r\n\t"sv)}, {"flag"sv, json::Node(false)}}));
+    std::ostringstream pretty;
+    json::Print(document, pretty);
+    ASSERT_HINT(pretty.str() == "{\n    \"array\": [\n        1,\n        -0.5,\n        null\n    ],\n"
+                                "    \"empty_array\": [],\n    \"empty_map\": {\n    },\n    \"flag\": false,\n"
+                                "    \"text\": \"a\\\"b\\\\c\\r\\n\t\"\n}\n"s, pretty.str());
+    std::ostringstream compact;
+    json::Print(document, compact, json::PrintMode::COMPACT);
+    ASSERT_HINT(compact.str() == "{\"array\":[1,-0.5,null],\"empty_array\":[],\"empty_map\":{},\"flag\":false,"
+                                 "\"text\":\"a\\\"b\\\\c\\r\\n\t\"}\n"s, compact.str());
+    ASSERT(json::Load(compact.str()) == document);
+    
+    //Дробные числа выводятся так же, как оператором вывода потока
+    for (double value : {0.1 + 0.2, 1234567.0, 1e21, 1e-7, -0.0, 3.0, 2.0 / 3.0, 123456.5}) {
+        std::ostringstream expected;
+        expected << value << std::endl;
+        std::ostringstream out;
+        json::Print(json::Document(json::Node(value)), out);
+        ASSERT_HINT(out.str() == expected.str(), out.str());
+    }
+    
+    //Поэлементный вывод массива совпадает с выводом документа в обоих режимах
+    for (json::PrintMode mode : {json::PrintMode::PRETTY, json::PrintMode::COMPACT}) {
+        std::ostringstream whole;
+        json::Print(json::Document(document.GetRoot().AsMap().at("array"sv)), whole, mode);
+        std::ostringstream by_item;
+        {
+            json::Writer writer(by_item, mode);
+            writer.StartArray();
+            for (const json::Node& item : document.GetRoot().AsMap().at("array"sv).AsArray()) {
+                writer.Value(item);
+                writer.Flush();
+            }
+            writer.EndArray();
+        }
+        by_item << std::endl;
+        ASSERT_HINT(by_item.str() == whole.str(), by_item.str());
+    }
+}
+
+void JsonTests::StreamingWriter() {
+    //Запись через Writer совпадает с выводом документа, собранного Builder, в обоих режимах
+    auto build = [](int id) {
+        return json::Builder{}.StartDict()
+                                  .Key("curvature").Value(1.23456789)
+                                  .Key("items").StartArray()
+                                      .StartDict().Key("name").Value("a\"b"s).Key("type").Value("Stop"s).EndDict()
+                                      .Value(json::Array{})
+                                      .StartDict().EndDict()
+                                  .EndArray()
+                                  .Key("request_id").Value(id)
+                                  .Key("route_length").Value(nullptr)
+                                  .Key("unique").Value(true)
+                              .EndDict()
+                              .Build();
+    };
+    auto write = [](json::Writer& writer, int id) {
+        writer.StartDict()
+                  .Key("curvature"sv).Value(1.23456789)
+                  .Key("items"sv).StartArray()
+                      .StartDict().Key("name"sv).Value("a\"b"sv).Key("type"sv).Value("Stop").EndDict()
+                      .StartArray().EndArray()
+                      .StartDict().EndDict()
+                  .EndArray()
+                  .Key("request_id"sv).Value(id)
+                  .Key("route_length"sv).Value(nullptr)
+                  .Key("unique"sv).Value(true)
+              .EndDict();
+    };
+    for (json::PrintMode mode : {json::PrintMode::PRETTY, json::PrintMode::COMPACT}) {
+        std::ostringstream expected;
+        json::Print(json::Document(json::Node(json::Array{build(1), build(2)})), expected, mode);
+        std::ostringstream out;
+        {
+            json::Writer writer(out, mode);
+            writer.StartArray();
+            write(writer, 1);
+            write(writer, 2);
+            writer.EndArray();
+        }
+        out << std::endl;
+        ASSERT_HINT(out.str() == expected.str(), out.str());
+    }
+    
+    //Нарушение порядка ключей и структуры документа
+    std::ostringstream wrong_out;
+    auto is_throw = [&wrong_out](const std::function<void(json::Writer&)>& action) {
+        json::Writer writer(wrong_out);
+        try {
+            action(writer);
+        }
+        catch (const std::logic_error&) {
+            return true;
+        }
+        return false;
+    };
+    ASSERT(is_throw([](json::Writer& writer) { writer.StartDict().Key("b"sv).Value(1).Key("a"sv); }));
+    ASSERT(is_throw([](json::Writer& writer) { writer.StartDict().Key("a"sv).Value(1).Key("a"sv); }));
+    ASSERT(is_throw([](json::Writer& writer) { writer.StartDict().Value(1); }));
+    ASSERT(is_throw([](json::Writer& writer) { writer.StartDict().Key("a"sv).EndDict(); }));
+    ASSERT(is_throw([](json::Writer& writer) { writer.StartArray().Key("a"sv); }));
+    ASSERT(is_throw([](json::Writer& writer) { writer.StartArray().EndDict(); }));
+    ASSERT(is_throw([](json::Writer& writer) { writer.Value(1).Value(2); }));
+    ASSERT(!is_throw([](json::Writer& writer) { writer.StartDict().Key("a"sv).Value(1).Key("b"sv).Value(2).EndDict(); }));
+}
+
+void JsonTests::IndexedParse() {
+    auto load_indexed = [](std::string_view text) {
+        json::NodeHandler handler;
+        json::ParseIndexed(text, handler);
+        return handler.ExtractDocument();
+    };
+    //Экранирование, кавычки и лексемы попадают на границы 64-байтных блоков при разных сдвигах текста
+    std::string body = "{\"key\": [\"a\\\\\\\\\", \"b\\\\\\\"c\", \"" + std::string(70, 'x') + "\\n\", -12.5e1, true, null,"
+                       " {\"nested\" :[ ]}, 12345678901, false, \"\\\"{[,:]}\\\"\"], \"last\": {}, \"tail\": \"\"}"s;
+    for (size_t shift = 0; shift < 2 * 64; ++shift) {
+        std::string text = std::string(shift, ' ') + body;
+        ASSERT_HINT(load_indexed(text) == json::Load(std::string_view(text)), text);
+    }
+    ASSERT(load_indexed("[1,]"sv) == json::Load("[1,]"sv));
+    ASSERT(load_indexed(" 7 x"sv) == json::Load(" 7 x"sv));
+    
+    //Ошибки разбора те же, что у однопроходного разбора
+    for (std::string_view wrong : {"\"abc"sv, "\"a\\q\""sv, "\"a\nb\""sv, "+1"sv, "-"sv, "1."sv, "tru"sv, "nulls"sv,
+                                   "[1 2]"sv, "{\"a\" 1}"sv, "{a: 1}"sv, ""sv, "[1x]"sv, "[\"a\"b]"sv, "[true{}]"sv,
+                                   "{\"a\": 1,"sv, "[\\]"sv}) {
+        bool is_throw = false;
+        try {
+            load_indexed(wrong);
+        }
+        catch (const json::ParsingError&) {
+            is_throw = true;
+        }
+        ASSERT_HINT(is_throw, std::string(wrong));
+    }
+    
+    //Большой текст выбирает двухэтапный разбор сам
+    std::string text = "["s;
+    while (text.size() < json::STRUCTURAL_INDEX_THRESHOLD) {
+        text += "{\"name\": \"stop\\\\"s + std::to_string(text.size()) + "\", \"values\": [1.5, -2, true]},\n"s;
+    }
+    text += "null]"s;
+    std::istringstream text_stream(text);
+    json::Document stream_doc = json::Load(text_stream);
+    ASSERT(stream_doc == json::Load(std::string_view(text)));
+    ASSERT(stream_doc.GetRoot().AsArray().back().IsNull());
+}
+
+void JsonTests::TypedRequests() {
+    using namespace IoRequests;
+    static_assert(HashKey("name") != HashKey("type"));
+    ASSERT(GetRequestType(json::Node("Stop"sv)) == RequestType::STOP);
+    ASSERT(GetRequestType(json::Node("StopsInRadius"sv)) == RequestType::STOPS_IN_RADIUS);
+    ASSERT(GetRequestType(json::Node("Stops"sv)) == RequestType::UNKNOWN);
+    ASSERT(GetRequestType(json::Node(1)) == RequestType::UNKNOWN);
+    ASSERT(GetRequestType(json::Node()) == RequestType::NONE);
+    
+    json::Document stop_doc = json::Load("{\"type\": \"Stop\", \"name\": \"A\", \"latitude\": 43.5, \"longitude\": 39,"
+                                         " \"road_distances\": {\"B\": 100}, \"extra\": 1}"sv);
+    StopRequest stop = DecodeStopRequest(stop_doc.GetRoot());
+    ASSERT(stop.name == "A"sv && stop.latitude == 43.5 && stop.longitude == 39.);
+    ASSERT(stop.road_distances->at("B"sv).AsInt() == 100);
+    
+    json::Document bus_doc = json::Load("{\"type\": \"Bus\", \"name\": \"7\", \"stops\": [\"A\", \"B\"],"
+                                        " \"is_roundtrip\": false}"sv);
+    BusRequest bus = DecodeBusRequest(bus_doc.GetRoot());
+    ASSERT(bus.name == "7"sv && bus.stops->size() == 2 && !bus.is_roundtrip);
+    
+    json::Document route_doc = json::Load("{\"id\": 5, \"type\": \"Route\", \"from\": \"A\", \"to\": \"B\"}"sv);
+    RouteRequest route = DecodeRouteRequest(route_doc.GetRoot());
+    ASSERT(route.id->AsInt() == 5 && route.from == "A"sv && route.to == "B"sv);
+    ASSERT(DecodeMapRequest(route_doc.GetRoot()).id->AsInt() == 5);
+    
+    //Тексты ошибок совпадают с прежними проверками и выдаются в том же порядке
+    auto get_error = [](const std::function<void()>& decode) {
+        try {
+            decode();
+        }
+        catch (const std::logic_error& error) {
+            return std::string(error.what());
+        }
+        return ""s;
+    };
+    auto decode_stop = [&get_error](std::string_view text) {
+        return get_error([text] { DecodeStopRequest(json::Load(text).GetRoot()); });
+    };
+    ASSERT(decode_stop("[]"sv) == "Json Stop node must be Dictionary(key,Node)."s);
+    ASSERT(decode_stop("{\"name\": \"A\"}"sv) == "Json Stop node must be contains \"type\"."s);
+    ASSERT(decode_stop("{\"type\": \"Bus\"}"sv) == "Key \"type\" must be contains value \"Stop\"."s);
+    ASSERT(decode_stop("{\"type\": \"Stop\", \"latitude\": 1}"sv) == "Json Stop node must be contains \"name\"."s);
+    ASSERT(decode_stop("{\"type\": \"Stop\", \"name\": \"A\", \"latitude\": 1, \"longitude\": 1,"
+                       " \"road_distances\": []}"sv) == "Key \"road_distances\" must be Dictionary(key,Node)."s);
+    auto decode_bus = [&get_error](std::string_view text) {
+        return get_error([text] { DecodeBusRequest(json::Load(text).GetRoot()); });
+    };
+    ASSERT(decode_bus("{\"type\": \"Bus\", \"name\": \"7\", \"stops\": {}}"sv) == "Key \"stops\" must be array."s);
+    ASSERT(decode_bus("{\"type\": \"Bus\", \"name\": \"7\", \"stops\": []}"sv)
+           == "Json Bus node must be contains \"is_roundtrip\"."s);
+    auto decode_route = [&get_error](std::string_view text) {
+        return get_error([text] { DecodeRouteRequest(json::Load(text).GetRoot()); });
+    };
+    ASSERT(decode_route("{\"type\": \"Route\", \"from\": \"A\"}"sv) == "Json request node must be contains \"id\"."s);
+    ASSERT(decode_route("{\"id\": 1, \"type\": \"Route\", \"from\": \"A\"}"sv)
+           == "Json request node must be contains \"to\"."s);
+    
+    //Запросы поиска остановок, отчета о памяти и удаления
+    json::Document nearest_doc = json::Load("{\"id\": 3, \"type\": \"NearestStops\", \"latitude\": 43.5,"
+                                            " \"longitude\": 39.7, \"count\": 2}"sv);
+    NearestStopsRequest nearest = DecodeNearestStopsRequest(nearest_doc.GetRoot());
+    ASSERT(nearest.id->AsInt() == 3 && nearest.point == Domain::geo::Coordinates({43.5, 39.7}) && nearest.count == 2);
+    json::Document radius_doc = json::Load("{\"id\": 4, \"type\": \"StopsInRadius\", \"latitude\": 43.5,"
+                                           " \"longitude\": 39.7, \"radius\": 250}"sv);
+    RadiusRequest radius = DecodeRadiusRequest(radius_doc.GetRoot());
+    ASSERT(radius.id->AsInt() == 4 && radius.radius == 250.);
+    json::Document search_doc = json::Load("{\"id\": 5, \"type\": \"Search\", \"query\": \"Мор\"}"sv);
+    SearchRequest search = DecodeSearchRequest(search_doc.GetRoot());
+    ASSERT(search.query == "Мор"sv && search.limit == SearchRequest::DEFAULT_LIMIT && !search.fuzzy);
+    ASSERT(DecodeStatsRequest(search_doc.GetRoot()).id->AsInt() == 5);
+    json::Document remove_doc = json::Load("{\"type\": \"RemoveBus\", \"name\": \"7\"}"sv);
+    ASSERT(DecodeRemoveRequest(remove_doc.GetRoot()).name == "7"sv);
+    
+    auto decode_error = [&get_error](std::function<void(const json::Node&)> decode, std::string_view text) {
+        return get_error([&decode, text] { decode(json::Load(text).GetRoot()); });
+    };
+    ASSERT(decode_error(DecodeNearestStopsRequest, "{\"id\": 1, \"latitude\": 1, \"longitude\": 1, \"count\": -1}"sv)
+           == "Key \"count\" must be non-negative int."s);
+    ASSERT(decode_error(DecodeRadiusRequest, "{\"id\": 1, \"latitude\": 1, \"longitude\": 1}"sv)
+           == "Json request node must be contains \"radius\"."s);
+    ASSERT(decode_error(DecodeSearchRequest, "{\"id\": 1, \"query\": \"a\", \"fuzzy\": 1}"sv)
+           == "Key \"fuzzy\" must be bool."s);
+    ASSERT(decode_error(DecodeStatsRequest, "{\"type\": \"Stats\"}"sv) == "Json request node must be contains \"id\"."s);
+    ASSERT(decode_error(DecodeRemoveRequest, "{\"name\": 7}"sv) == "Key \"name\" must be String."s);
+    
+    //Запрос без "type" отклоняется проверкой запроса, а не ошибкой поиска ключа
+    std::istringstream input("{\"stat_requests\": [{\"id\": 1, \"name\": \"A\"}]}"s);
+    std::ostringstream output;
+    BusinessLogic::TransportCatalogue transport_catalogue{};
+    renderer::MapRenderer map_renderer(transport_catalogue);
+    JsonReader json_reader(map_renderer, transport_catalogue, input, output);
+    json_reader.PreloadDocument();
+    ASSERT(get_error([&json_reader] { json_reader.SendAnswer(); }) == "Json request node must be contains \"type\"."s);
+}
+
+//region benchmarks
+void Benchmarks::MemoryResourceLoad() {
+    //Время загрузки, число выделений и пик резидентной памяти на ресурсе по умолчанию и на арене
+    const size_t stop_count = 150;
+    const size_t bus_count = 300;
+    auto load = [stop_count, bus_count](std::pmr::memory_resource* resource, std::string_view name) {
+        const bool peak_reset = ResetPeakRss();
+        const size_t rss_before = GetProcessMemoryKb("VmRSS"sv);
+        {
+            BusinessLogic::TransportCatalogue transport_catalogue(resource);
+            LogDuration x(name);
+            LoadRandomCatalogue(transport_catalogue, stop_count, bus_count);
+        }
+        std::cerr << name << ": peak RSS "sv << GetProcessMemoryKb("VmHWM"sv) << " kB, before load "sv << rss_before
+                  << " kB"sv << (peak_reset ? ""sv : " (peak not reset)"sv) << std::endl;
+    };
+    memory::CountingResource default_resource;
+    load(&default_resource, "Default resource load time"sv);
+    //Арена растет блоками, каждый следующий больше предыдущего. Начав с маленького блока, она запрашивает у
+    //системы новые страницы по ходу загрузки, а память перестроенных таблиц и векторов не переиспользует
+    memory::CountingResource arena_upstream;
+    {
+        std::pmr::monotonic_buffer_resource arena(&arena_upstream);
+        load(&arena, "Monotonic arena load time"sv);
+    }
+    //Начальный блок по объему, который арена заняла на том же числе остановок и маршрутов. Он больше пика
+    //ресурса по умолчанию: арена не переиспользует освобожденную при перестроении память
+    memory::CountingResource sized_arena_upstream;
+    {
+        std::pmr::monotonic_buffer_resource arena(arena_upstream.GetPeakBytes(), &sized_arena_upstream);
+        load(&arena, "Presized monotonic arena load time"sv);
+    }
+    std::cerr << "Default resource allocations: "sv << default_resource.GetAllocationsCount()
+              << ", peak bytes: "sv << default_resource.GetPeakBytes()
+              << "; monotonic arena allocations: "sv << arena_upstream.GetAllocationsCount()
+              << ", bytes: "sv << arena_upstream.GetPeakBytes()
+              << "; presized arena allocations: "sv << sized_arena_upstream.GetAllocationsCount()
+              << ", bytes: "sv << sized_arena_upstream.GetPeakBytes() << std::endl;
+    ASSERT(arena_upstream.GetAllocationsCount() * 100 < default_resource.GetAllocationsCount());
+    ASSERT(sized_arena_upstream.GetAllocationsCount() <= arena_upstream.GetAllocationsCount());
+}
+
+void Benchmarks::CachedMapRender() {
+    std::ifstream file_input_stream(getexepath() + "/test_case/maprender_case_big_data_input.json");
+    std::ostringstream o_string_stream;
+    TransportCatalogue transport_catalogue{};
+    renderer::MapRenderer map_renderer(transport_catalogue);
+    IoRequests::JsonReader json_reader(map_renderer, transport_catalogue, file_input_stream, o_string_stream);
+    json_reader.PreloadDocument();
+    json_reader.LoadData();
+    
+    const std::string& svg = map_renderer.GetSvg();
+    const int repeat_count = 100;
+    {
+        LogDuration log_duration("Cached map render time");
+        for (int i = 0; i < repeat_count; ++i) {
+            ASSERT(map_renderer.GetSvg().data() == svg.data());
+        }
+    }
+    {
+        LogDuration log_duration("Uncached map render time");
+        for (int i = 0; i < repeat_count / 10; ++i) {
+            std::ostringstream out;
+            map_renderer.CreateDocument();
+            map_renderer.Render(out);
+            ASSERT(out.str() == svg);
+        }
+    }
+}
+
+void Benchmarks::ViewportMapRender() {
+    std::ifstream file_input_stream(getexepath() + "/test_case/maprender_case_big_data_input.json");
+    std::ostringstream o_string_stream;
+    TransportCatalogue transport_catalogue{};
+    renderer::MapRenderer map_renderer(transport_catalogue);
+    IoRequests::JsonReader json_reader(map_renderer, transport_catalogue, file_input_stream, o_string_stream);
+    json_reader.PreloadDocument();
+    json_reader.LoadData();
+    
+    //Окно вокруг первой остановки каталога
+    const Domain::Stop* center = transport_catalogue.GetBusNameCatalog().begin()->second->route.front();
+    const double delta = 0.05;
+    Domain::MapViewport viewport;
+    viewport.bbox = {{center->latitude - delta, center->longitude - delta},
+                     {center->latitude + delta, center->longitude + delta}};
+    const int repeat_count = 100;
+    {
+        LogDuration log_duration("Viewport map render time");
+        for (int i = 0; i < repeat_count; ++i) {
+            ASSERT(!map_renderer.RenderViewport(viewport).empty());
+        }
+    }
+}
+
+void Benchmarks::BigDataMapRender() {
+    std::ifstream file_input_stream(getexepath() + "/test_case/maprender_case_big_data_input.json");
+    std::ifstream file_output_stream(getexepath() + "/test_case/maprender_case_big_data_output.json");
+    std::ostringstream o_string_stream;
+    TransportCatalogue transport_catalogue{};
+    renderer::MapRenderer map_renderer(transport_catalogue);
+    IoRequests::JsonReader json_reader(map_renderer, transport_catalogue, file_input_stream, o_string_stream);
+    json_reader.PreloadDocument();
+    json_reader.LoadData();
+    const std::string correct_answer = GetTextFromStream(file_output_stream);
+    
+    //Карта и документ из объектов выводятся в файл и в строковый поток
+    const int repeat_count = 10;
+    const std::string file_path = getexepath() + "/big_data_map.svg"s;
+    {
+        LogDuration log_duration("Big data map render to file time");
+        for (int i = 0; i < repeat_count; ++i) {
+            std::ofstream file(file_path, std::ios::binary);
+            map_renderer.CreateDocument();
+            map_renderer.Render(file);
+        }
+    }
+    std::ifstream rendered_file(file_path, std::ios::binary);
+    ASSERT(GetTextFromStream(rendered_file) == correct_answer);
+    rendered_file.close();
+    std::remove(file_path.c_str());
+    {
+        LogDuration log_duration("Big data map render to ostringstream time");
+        for (int i = 0; i < repeat_count; ++i) {
+            std::ostringstream out;
+            map_renderer.CreateDocument();
+            map_renderer.Render(out);
+            ASSERT(out.str() + "\n" == correct_answer);
+        }
+    }
+    
+    svg::Document document;
+    for (const Domain::Stop& stop : transport_catalogue.GetStops()) {
+        document.Add(svg::Circle().SetCenter({stop.longitude, stop.latitude}).SetRadius(5.).SetFillColor("white"));
+        document.Add(svg::Text().SetPosition({stop.longitude, stop.latitude}).SetOffset({7., -3.}).SetFontSize(20)
+                             .SetFontFamily("Verdana").SetData(stop.name).SetFillColor(svg::Rgba(255, 255, 255, 0.85)));
+    }
+    std::ostringstream document_output;
+    document.Render(document_output);
+    {
+        LogDuration log_duration("Big data object document render to ostringstream time");
+        for (int i = 0; i < repeat_count; ++i) {
+            std::ostringstream out;
+            document.Render(out);
+        }
+    }
+    {
+        LogDuration log_duration("Big data object document render to file time");
+        for (int i = 0; i < repeat_count; ++i) {
+            std::ofstream file(file_path, std::ios::binary);
+            document.Render(file);
+        }
+    }
+    std::ifstream document_file(file_path, std::ios::binary);
+    ASSERT(GetTextFromStream(document_file) == document_output.str() + "\n");
+    document_file.close();
+    std::remove(file_path.c_str());
+}
+
+void Benchmarks::FrozenDistanceLookup() {
+    //Расстояния по всем отрезкам маршрутов в обычном и замороженном каталоге
+    auto load = [](TransportCatalogue& transport_catalogue) {
+        std::ifstream file_input_stream(getexepath() + "/test_case/maprender_case_big_data_input.json");
+        std::ostringstream o_string_stream;
+        renderer::MapRenderer map_renderer(transport_catalogue);
+        IoRequests::JsonReader json_reader(map_renderer, transport_catalogue, file_input_stream, o_string_stream);
+        json_reader.PreloadDocument();
+        json_reader.LoadData();
+    };
+    auto collect_sections = [](const TransportCatalogue& transport_catalogue) {
+        std::vector<Domain::TrackSection> sections;
+        for (const Domain::Bus& bus : transport_catalogue.GetBuses()) {
+            for (auto it = bus.route.begin(); std::next(it) != bus.route.end(); ++it) {
+                sections.emplace_back(*it, *std::next(it));
+            }
+        }
+        return sections;
+    };
+    auto sum_distances = [](const TransportCatalogue& transport_catalogue,
+            const std::vector<Domain::TrackSection>& sections, std::string_view name) {
+        const int repeat_count = 100;
+        double sum = 0.;
+        LogDuration log_duration(name);
+        for (int i = 0; i < repeat_count; ++i) {
+            for (const Domain::TrackSection& section : sections) {
+                sum += transport_catalogue.GetDistance(section);
+            }
+        }
+        return sum;
+    };
+    TransportCatalogue transport_catalogue{};
+    load(transport_catalogue);
+    TransportCatalogue frozen_catalogue{};
+    load(frozen_catalogue);
+    frozen_catalogue.Freeze();
+    std::vector<Domain::TrackSection> sections = collect_sections(transport_catalogue);
+    std::vector<Domain::TrackSection> frozen_sections = collect_sections(frozen_catalogue);
+    std::cerr << "Route sections: "sv << sections.size() << std::endl;
+    double sum = sum_distances(transport_catalogue, sections, "Distance lookup time"sv);
+    double frozen_sum = sum_distances(frozen_catalogue, frozen_sections, "Frozen distance lookup time"sv);
+    ASSERT(std::abs(sum - frozen_sum) < 1e-6 * sum);
+}
+
+void Benchmarks::AnswerBatchNoRepeats() {
+    std::ifstream file_input_stream(getexepath() + "/test_case/maprender_case_big_data_input.json");
+    const json::Document input_doc = json::Load(file_input_stream);
+    
+    //Каждый запрос Bus и Stop встречается в пакете один раз, кешу сохранять нечего
+    auto process = [&input_doc](bool is_int_id) {
+        json::Dict input_root = input_doc.GetRoot().AsMap();
+        json::Array stat_requests;
+        int id = 0;
+        for (const json::Node& base_request : input_root.at("base_requests"s).AsArray()) {
+            const json::Node request_id = is_int_id ? json::Node(++id) : json::Node(std::to_string(++id));
+            stat_requests.emplace_back(json::Dict{{"id"s, request_id}, {"name"s, base_request.AsMap().at("name"s)},
+                                                  {"type"s, base_request.AsMap().at("type"s)}});
+        }
+        input_root.at("stat_requests"s) = json::Node(std::move(stat_requests));
+        std::ostringstream input_text;
+        json::Print(json::Document(json::Node(std::move(input_root))), input_text);
+        
+        std::istringstream input(input_text.str());
+        std::ostringstream output;
+        TransportCatalogue transport_catalogue{};
+        renderer::MapRenderer map_renderer(transport_catalogue);
+        IoRequests::JsonReader json_reader(map_renderer, transport_catalogue, input, output);
+        json_reader.PreloadDocument();
+        json_reader.LoadData();
+        {
+            //Ответы на запросы с нечисловым id в кеш не попадают, это время пакета без кеша
+            LogDuration log_duration(is_int_id ? "Answer batch without repeats time"sv : "Answer batch without cache time"sv);
+            for (int i = 0; i < 20; ++i) {
+                json_reader.SendAnswer();
+            }
+        }
+        ASSERT(json_reader.GetAnswerCacheCounters().hits == 0);
+    };
+    process(false);
+    process(true);
+}
+
+void Benchmarks::JsonParse() {
+    std::ifstream file_input_stream(getexepath() + "/test_case/maprender_case_big_data_input.json");
+    const std::string big_text = GetTextFromStream(file_input_stream);
+    const int repeat_count = 20;
+    {
+        LogDuration log_duration("Json parse time");
+        for (int i = 0; i < repeat_count; ++i) {
+            std::istringstream stream(big_text);
+            json::Document document = json::Load(stream);
+            ASSERT(!document.GetRoot().IsNull());
+        }
+    }
+}
+
+void Benchmarks::JsonIndexedParse() {
+    //Базы для update_base и memory_stats читаются целиком и разбираются по структурному индексу
+    std::ifstream file_input_stream(getexepath() + "/test_case/s14_3_opentest_3_make_base.json");
+    const std::string text = GetTextFromStream(file_input_stream);
+    ASSERT(text.size() >= json::STRUCTURAL_INDEX_THRESHOLD);
+    const int repeat_count = 20;
+    for (bool is_indexed : {false, true}) {
+        LogDuration log_duration(is_indexed ? "Json indexed parse time" : "Json sequential parse time");
+        for (int i = 0; i < repeat_count; ++i) {
+            json::NodeHandler handler;
+            if (is_indexed) {
+                json::ParseIndexed(text, handler);
+            }
+            else {
+                std::istringstream stream(text);
+                json::Parse(stream, handler);
+            }
+            ASSERT(handler.ExtractDocument().GetRoot().IsMap());
+        }
+    }
+}
+
+void Benchmarks::JsonPrint() {
+    std::ifstream file_input_stream(getexepath() + "/test_case/maprender_case_big_data_input.json");
+    const json::Document big_doc = json::Load(file_input_stream);
+    const int repeat_count = 20;
+    {
+        LogDuration log_duration("Json print time");
+        for (int i = 0; i < repeat_count; ++i) {
+            std::ostringstream out;
+            json::Print(big_doc, out);
+            ASSERT(!out.str().empty());
+        }
+    }
+}
+
+void Benchmarks::JsonWriterResponses() {
+    const int repeat_count = 10000;
+    {
+        LogDuration log_duration("Writer responses time");
+        std::ostringstream out;
+        json::Writer writer(out);
+        writer.StartArray();
+        for (int i = 0; i < repeat_count; ++i) {
+            writer.StartDict()
+                      .Key("curvature"sv).Value(1.23456789)
+                      .Key("items"sv).StartArray()
+                          .StartDict().Key("name"sv).Value("a\"b"sv).Key("type"sv).Value("Stop").EndDict()
+                          .StartArray().EndArray()
+                          .StartDict().EndDict()
+                      .EndArray()
+                      .Key("request_id"sv).Value(i)
+                      .Key("route_length"sv).Value(nullptr)
+                      .Key("unique"sv).Value(true)
+                  .EndDict();
+        }
+        writer.EndArray();
+    }
+}
+
+void Benchmarks::TypedRequestsDecode() {
+    json::Document stop_doc = json::Load("{\"type\": \"Stop\", \"name\": \"A\", \"latitude\": 43.5, \"longitude\": 39,"
+                                         " \"road_distances\": {\"B\": 100}, \"extra\": 1}"sv);
+    const int repeat_count = 100000;
+    {
+        LogDuration log_duration("Typed stop requests decode time");
+        double sum = 0;
+        for (int i = 0; i < repeat_count; ++i) {
+            sum += IoRequests::DecodeStopRequest(stop_doc.GetRoot()).latitude;
+        }
+        ASSERT(sum > 0);
+    }
+}
+//endregion
+
 void AllTests() {
     IntegrationTests integration_tests;
     RUN_TEST(integration_tests.TestCase_5_PlusRealRoutersAndCurveInBusInformation)
     RUN_TEST(integration_tests.TestCase_6_JsonReader)
     RUN_TEST(integration_tests.TestCase_7_MapRender)
     RUN_TEST(integration_tests.TestCase_8_Serialization_Deserialization)
+    RUN_TEST(integration_tests.TestCase_9_NearestStopsRequests)
+    RUN_TEST(integration_tests.TestCase_10_MemoryStats)
+    RUN_TEST(integration_tests.TestCase_11_StreamingBaseRequests)
+    RUN_TEST(integration_tests.TestCase_12_StreamingStatRequests)
+    RUN_TEST(integration_tests.TestCase_13_AnswerCache)
     TransportCatalogueTests transport_catalogue_tests;
     RUN_TEST(transport_catalogue_tests.TrackSectionHasher)
     RUN_TEST(transport_catalogue_tests.AddBus)
@@ -1003,6 +2913,17 @@ void AllTests() {
     RUN_TEST(transport_catalogue_tests.GetBusInfo)
     RUN_TEST(transport_catalogue_tests.GetBusInfoPlusCurvatureAdded)
     RUN_TEST(transport_catalogue_tests.GetStopInfo)
+    RUN_TEST(transport_catalogue_tests.InsertStopByName)
+    RUN_TEST(transport_catalogue_tests.BulkLoadBuilder)
+    RUN_TEST(transport_catalogue_tests.BulkLoadBuilderParallel)
+    RUN_TEST(transport_catalogue_tests.FreezeSnapshot)
+    RUN_TEST(transport_catalogue_tests.SpatialIndex)
+    RUN_TEST(transport_catalogue_tests.NameSearch)
+    RUN_TEST(transport_catalogue_tests.SphereDistanceKernel)
+    RUN_TEST(transport_catalogue_tests.SharedRoutePool)
+    RUN_TEST(transport_catalogue_tests.RemoveBusAndStop)
+    RUN_TEST(transport_catalogue_tests.MemoryResourceLoad)
+    RUN_TEST(transport_catalogue_tests.NameLookupPerfectHash)
     StreamReaderTests stream_reader_tests;
     RUN_TEST(stream_reader_tests.Load)
     RUN_TEST(stream_reader_tests.SendAnswer)
@@ -1014,6 +2935,10 @@ void AllTests() {
     RUN_TEST(map_render_tests.TestCaseBigData);
     RUN_TEST(map_render_tests.TestCase4);
     RUN_TEST(map_render_tests.TestCase5);
+    RUN_TEST(map_render_tests.CachedMap);
+    RUN_TEST(map_render_tests.StreamingSvgWriter);
+    RUN_TEST(map_render_tests.BigDataRenderTargets);
+    RUN_TEST(map_render_tests.ViewportMap);
     //RUN_TEST(map_render_tests.TestCase6); //Отключен ограничения в 8мб на платформе
     UserRouteTests user_route_tests;
     RUN_TEST(user_route_tests.TestCase1Route);
@@ -1023,6 +2948,29 @@ void AllTests() {
     RUN_TEST(user_route_tests.TestCase5Route);
     RUN_TEST(user_route_tests.TestCase6Route);
     //RUN_TEST(user_route_tests.TestCase7Route);//Отключен ограничения в 8мб на платформе
+    JsonTests json_tests;
+    RUN_TEST(json_tests.LoadBuffer);
+    RUN_TEST(json_tests.ParseEvents);
+    RUN_TEST(json_tests.ArenaDocument);
+    RUN_TEST(json_tests.PrintModes);
+    RUN_TEST(json_tests.StreamingWriter);
+    RUN_TEST(json_tests.IndexedParse);
+    RUN_TEST(json_tests.TypedRequests);
 }
 
-}
\ No newline at end of file
+void AllBenchmarks() {
+    Benchmarks benchmarks;
+    RUN_TEST(benchmarks.MemoryResourceLoad);
+    RUN_TEST(benchmarks.CachedMapRender);
+    RUN_TEST(benchmarks.ViewportMapRender);
+    RUN_TEST(benchmarks.BigDataMapRender);
+    RUN_TEST(benchmarks.FrozenDistanceLookup);
+    RUN_TEST(benchmarks.AnswerBatchNoRepeats);
+    RUN_TEST(benchmarks.JsonParse);
+    RUN_TEST(benchmarks.JsonIndexedParse);
+    RUN_TEST(benchmarks.JsonPrint);
+    RUN_TEST(benchmarks.JsonWriterResponses);
+    RUN_TEST(benchmarks.TypedRequestsDecode);
+}
+
+}
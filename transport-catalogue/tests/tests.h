@@ -149,6 +149,11 @@ public:
     void TestCase_6_JsonReader();
     void TestCase_7_MapRender();
     void TestCase_8_Serialization_Deserialization();
+    void TestCase_9_NearestStopsRequests();
+    void TestCase_10_MemoryStats();
+    void TestCase_11_StreamingBaseRequests();
+    void TestCase_12_StreamingStatRequests();
+    void TestCase_13_AnswerCache();
 };
 
 
@@ -162,6 +167,17 @@ public:
     void GetBusInfo();
     void GetBusInfoPlusCurvatureAdded();
     void GetStopInfo();
+    void InsertStopByName();
+    void BulkLoadBuilder();
+    void BulkLoadBuilderParallel();
+    void FreezeSnapshot();
+    void SpatialIndex();
+    void NameSearch();
+    void SphereDistanceKernel();
+    void SharedRoutePool();
+    void RemoveBusAndStop();
+    void MemoryResourceLoad();
+    void NameLookupPerfectHash();
 };
 
 
@@ -180,6 +196,10 @@ public:
     void TestCaseBigData();
     void TestCase4();
     void TestCase5();
+    void CachedMap();
+    void StreamingSvgWriter();
+    void BigDataRenderTargets();
+    void ViewportMap();
 //    void TestCase6();
 };
 
@@ -194,6 +214,33 @@ public:
 //    void TestCase7Route();
 
 };
+
+class JsonTests {
+public:
+    void LoadBuffer();
+    void ParseEvents();
+    void ArenaDocument();
+    void PrintModes();
+    void StreamingWriter();
+    void IndexedParse();
+    void TypedRequests();
+};
+/**Замеры времени на больших данных, в AllTests не входят, запускаются режимом benchmarks*/
+class Benchmarks {
+public:
+    void MemoryResourceLoad();
+    void CachedMapRender();
+    void ViewportMapRender();
+    void BigDataMapRender();
+    void FrozenDistanceLookup();
+    void AnswerBatchNoRepeats();
+    void JsonParse();
+    void JsonIndexedParse();
+    void JsonPrint();
+    void JsonWriterResponses();
+    void TypedRequestsDecode();
+};
 void AllTests();
+void AllBenchmarks();
 
 }
\ No newline at end of file